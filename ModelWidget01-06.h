@@ -9,6 +9,7 @@
 #include <functional>
 #include "mousezoom.h"
 #include "chartsetting1.h"
+#include "cancellationtoken.h"
 
 namespace Ui {
 class ModelWidget01_06;
@@ -40,7 +41,9 @@ public:
     void setHighPrecision(bool high);
 
     // 计算理论曲线 (供 FittingWidget 调用)
-    ModelCurveData calculateTheoreticalCurve(const QMap<QString, double>& params, const QVector<double>& providedTime = QVector<double>());
+    // token 非空且在计算中被取消时，返回空曲线
+    ModelCurveData calculateTheoreticalCurve(const QMap<QString, double>& params, const QVector<double>& providedTime = QVector<double>(),
+                                             const CancellationToken* token = nullptr);
 
     // 获取当前模型名称
     QString getModelName() const;
@@ -59,12 +62,15 @@ public slots:
     void onChartSettings();
     void onDependentParamsChanged();
     void onShowPointsToggled(bool checked);
+    void onUncertaintyClicked();
 
 private:
     void initUi();
     void initChart();
     void setupConnections();
     void runCalculation();
+    // 读取界面全部参数输入（逗号分隔的多值用于敏感性分析）
+    QMap<QString, QVector<double>> collectRawParams();
 
     // 辅助函数
     QVector<double> parseInput(const QString& text);
@@ -74,13 +80,15 @@ private:
     // 数学计算核心 (Stehfest 反演循环)
     void calculatePDandDeriv(const QVector<double>& tD, const QMap<QString, double>& params,
                              std::function<double(double, const QMap<QString, double>&)> laplaceFunc,
-                             QVector<double>& outPD, QVector<double>& outDeriv);
+                             QVector<double>& outPD, QVector<double>& outDeriv,
+                             const CancellationToken* token = nullptr);
 
     // 拉普拉斯空间解 (复合模型通用入口)
-    double flaplace_composite(double z, const QMap<QString, double>& p);
+    double flaplace_composite(double z, const QMap<QString, double>& p, const CancellationToken* token = nullptr);
 
     // PWD 核心计算 (包含边界条件处理 Logic from MATLAB PWD_inf)
-    double PWD_composite(double z, double fs1, double fs2, double M12, double LfD, double rmD, double reD, int nf, const QVector<double>& xwD, ModelType type);
+    double PWD_composite(double z, double fs1, double fs2, double M12, double LfD, double rmD, double reD, int nf, const QVector<double>& xwD, ModelType type,
+                         const CancellationToken* token = nullptr);
 
     // 数学工具函数 (对应 MATLAB 内置函数或逻辑)
     double scaled_besseli(int v, double x); // 缩放 Bessel I
@@ -28,17 +28,39 @@ win32: LIBS += -lm
 # Input
 HEADERS += dataeditorwidget.h \
            chartsetting1.h \
+           cancellationtoken.h \
            chartsetting2.h \
            datacalculate.h \
            datacolumndialog.h \
            dataimportdialog.h \
+           deconvolutionengine.h \
+           derivativeengine.h \
+           derivedcolumntracker.h \
+           fittingengine.h \
+           fittingjobdashboard.h \
+           fittingjobscheduler.h \
+           fittinglandscape.h \
+           fittinglandscapedialog.h \
+           fittingmcmc.h \
+           fittingmcmcdialog.h \
+           fittingmodeldiscrimination.h \
+           fittingseparable.h \
+           fittingsolutioncache.h \
            fittingobserveddata.h \
            fittingpage.h \
            fittingparameterchart.h \
+           fittingparametertransform.h \
+           fittingresidualkernel.h \
+           flowperioddialog.h \
+           flowperiodsegmenter.h \
+           lspacingselectdialog.h \
            modelmanager.h \
            modelparameter.h \
+           modeldiscriminationdialog.h \
            modelselect.h \
            modelwidget01-06.h \
+           modeluncertainty.h \
+           modeluncertaintydialog.h \
            mousezoom.h \
            newprojectdialog.h \
            paramselectdialog.h \
@@ -54,7 +76,10 @@ HEADERS += dataeditorwidget.h \
            plottingstackwidget.h \
            pressurederivativecalculator.h \
            pressurederivativecalculator1.h \
+           ratesuperposition.h \
            settingswidget.h \
+           smoothingengine.h \
+           timetransform.h \
            qcustomplot.h \
            wt_fittingwidget.h \
            wt_plottingwidget.h \
@@ -65,9 +90,16 @@ FORMS += dataeditorwidget.ui \
          chartsetting2.ui \
          datacolumndialog.ui \
          dataimportdialog.ui \
+         fittingjobdashboard.ui \
+         fittinglandscapedialog.ui \
+         fittingmcmcdialog.ui \
          fittingpage.ui \
+         flowperioddialog.ui \
+         lspacingselectdialog.ui \
+         modeldiscriminationdialog.ui \
          modelselect.ui \
          modelwidget01-06.ui \
+         modeluncertaintydialog.ui \
          newprojectdialog.ui \
          paramselectdialog.ui \
          mainwindow.ui \
@@ -92,13 +124,34 @@ SOURCES += \
            datacolumndialog.cpp \
            dataeditorwidget.cpp \
            dataimportdialog.cpp \
+           deconvolutionengine.cpp \
+           derivativeengine.cpp \
+           derivedcolumntracker.cpp \
+           fittingengine.cpp \
+           fittingjobdashboard.cpp \
+           fittingjobscheduler.cpp \
+           fittinglandscape.cpp \
+           fittinglandscapedialog.cpp \
+           fittingmcmc.cpp \
+           fittingmcmcdialog.cpp \
+           fittingmodeldiscrimination.cpp \
+           fittingseparable.cpp \
+           fittingsolutioncache.cpp \
            fittingobserveddata.cpp \
            fittingpage.cpp \
            fittingparameterchart.cpp \
+           fittingparametertransform.cpp \
+           fittingresidualkernel.cpp \
+           flowperioddialog.cpp \
+           flowperiodsegmenter.cpp \
+           lspacingselectdialog.cpp \
            modelmanager.cpp \
            modelparameter.cpp \
+           modeldiscriminationdialog.cpp \
            modelselect.cpp \
            modelwidget01-06.cpp \
+           modeluncertainty.cpp \
+           modeluncertaintydialog.cpp \
            mousezoom.cpp \
            newprojectdialog.cpp \
            paramselectdialog.cpp \
@@ -115,7 +168,10 @@ SOURCES += \
            plottingstackwidget.cpp \
            pressurederivativecalculator.cpp \
            pressurederivativecalculator1.cpp \
+           ratesuperposition.cpp \
            settingswidget.cpp \
+           smoothingengine.cpp \
+           timetransform.cpp \
            qcustomplot.cpp \
            wt_fittingwidget.cpp \
            wt_plottingwidget.cpp \
@@ -0,0 +1,39 @@
+/*
+ * 文件名: cancellationtoken.h
+ * 文件作用: 计算取消令牌（仅头文件）
+ * 功能描述:
+ * 1. 基于 std::atomic_bool 的线程安全取消标志，界面线程置位，计算线程轮询。
+ * 2. 由拟合引擎持有，并逐层传入模型计算（Stehfest 反演、PWD 积分循环），
+ *    使停止请求能在单个时间点的粒度上立即生效。
+ */
+
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <atomic>
+
+class CancellationToken
+{
+public:
+    CancellationToken() : m_cancelled(false) {}
+
+    // 请求取消（可在任意线程调用）
+    void cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+
+    // 复位为未取消状态（开始新的计算前调用）
+    void reset() { m_cancelled.store(false, std::memory_order_relaxed); }
+
+    // 查询是否已请求取消
+    bool isCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+    // 辅助函数：令牌可为空指针，表示不可取消
+    static bool isCancelled(const CancellationToken* token) { return token && token->isCancelled(); }
+
+private:
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    std::atomic_bool m_cancelled;
+};
+
+#endif // CANCELLATIONTOKEN_H
@@ -6,6 +6,8 @@
  * 2. 集成了 DataImportDialog，支持配置化导入 CSV/TXT 文件。
  * 3. 集成了 QAxObject，支持直接读取 Excel (.xls/.xlsx) 文件内容到表格。
  * 4. 实现了数据与项目文件的同步保存与恢复。
+ * 5. 反褶积：读取时间、压力与产量列，后台运行 DeconvolutionEngine，可随时取消。
+ * 6. 流动段划分：FlowPeriodSegmenter 检测产量/压力变点，结果在 FlowPeriodDialog 中预览与选择。
  */
 
 #include "dataeditorwidget.h"
@@ -14,6 +16,8 @@
 #include "datacalculate.h"
 #include "modelparameter.h"
 #include "dataimportdialog.h"
+#include "derivedcolumntracker.h"
+#include "flowperioddialog.h"
 
 #include <QFileDialog>
 #include <QMessageBox>
@@ -27,6 +31,11 @@
 #include <QEvent>
 #include <QAxObject> // 用于 Excel 操作
 #include <QDir>      // 用于路径转换
+#include <QInputDialog>
+#include <QProgressDialog>
+#include <QtConcurrent>
+#include <cmath>
+#include <limits>
 
 // ============================================================================
 // 内部类：NoContextMenuDelegate 实现
@@ -62,7 +71,12 @@ DataEditorWidget::DataEditorWidget(QWidget *parent) :
     ui(new Ui::DataEditorWidget),
     m_dataModel(new QStandardItemModel(this)),
     m_proxyModel(new QSortFilterProxyModel(this)),
-    m_undoStack(new QUndoStack(this))
+    m_undoStack(new QUndoStack(this)),
+    m_derivedColumns(new DerivedColumnTracker(m_dataModel, this)),
+    m_deconvProgress(nullptr),
+    m_flowProgress(nullptr),
+    m_flowByRate(false),
+    m_flowDroppedRows(0)
 {
     ui->setupUi(this);
     initUI();
@@ -80,6 +94,10 @@ DataEditorWidget::DataEditorWidget(QWidget *parent) :
 
 DataEditorWidget::~DataEditorWidget()
 {
+    m_deconvToken.cancel();
+    m_flowToken.cancel();
+    m_deconvWatcher.waitForFinished();
+    m_flowWatcher.waitForFinished();
     delete ui;
 }
 
@@ -106,9 +124,16 @@ void DataEditorWidget::setupConnections()
     connect(ui->btnDefineColumns, &QPushButton::clicked, this, &DataEditorWidget::onDefineColumns);
     connect(ui->btnTimeConvert, &QPushButton::clicked, this, &DataEditorWidget::onTimeConvert);
     connect(ui->btnPressureDropCalc, &QPushButton::clicked, this, &DataEditorWidget::onPressureDropCalc);
+    connect(ui->btnDerivativeCalc, &QPushButton::clicked, this, &DataEditorWidget::onDerivativeCalc);
+    connect(ui->btnDeconvolution, &QPushButton::clicked, this, &DataEditorWidget::onDeconvolution);
+    connect(ui->btnFlowPeriods, &QPushButton::clicked, this, &DataEditorWidget::onFlowPeriods);
+    connect(&m_deconvWatcher, &QFutureWatcher<DeconvolutionResult>::finished, this, &DataEditorWidget::onDeconvolutionFinished);
+    connect(&m_flowWatcher, &QFutureWatcher<QVector<FlowPeriodData>>::finished, this, &DataEditorWidget::onFlowPeriodsFinished);
     connect(ui->searchLineEdit, &QLineEdit::textChanged, this, &DataEditorWidget::onSearchTextChanged);
     connect(ui->dataTableView, &QTableView::customContextMenuRequested, this, &DataEditorWidget::onCustomContextMenu);
     connect(m_dataModel, &QStandardItemModel::itemChanged, this, &DataEditorWidget::onModelDataChanged);
+    connect(m_dataModel, &QStandardItemModel::rowsInserted, this, &DataEditorWidget::onModelDataChanged);
+    connect(m_dataModel, &QStandardItemModel::rowsRemoved, this, &DataEditorWidget::onModelDataChanged);
 }
 
 void DataEditorWidget::updateButtonsState()
@@ -118,6 +143,9 @@ void DataEditorWidget::updateButtonsState()
     ui->btnDefineColumns->setEnabled(hasData);
     ui->btnTimeConvert->setEnabled(hasData);
     ui->btnPressureDropCalc->setEnabled(hasData);
+    ui->btnDerivativeCalc->setEnabled(hasData);
+    ui->btnDeconvolution->setEnabled(hasData && !m_deconvWatcher.isRunning());
+    ui->btnFlowPeriods->setEnabled(hasData && !m_flowWatcher.isRunning());
 }
 
 // ============================================================================
@@ -523,6 +551,181 @@ void DataEditorWidget::onPressureDropCalc()
     else QMessageBox::warning(this, "失败", res.errorMessage);
 }
 
+void DataEditorWidget::onDerivativeCalc()
+{
+    PressureDerivativeCalculator calculator;
+    PressureDerivativeConfig config = calculator.autoDetectColumns(m_dataModel);
+    if (config.timeColumnIndex < 0 || config.pressureColumnIndex < 0) {
+        QMessageBox::warning(this, "失败", "未能识别时间列或压力列，请先定义列属性。");
+        return;
+    }
+
+    bool ok = false;
+    double lSpacing = QInputDialog::getDouble(this, "导数计算", "L-Spacing (对数周期):", config.lSpacing, 0.01, 2.0, 2, &ok);
+    if (!ok) return;
+    config.lSpacing = lSpacing;
+
+    // 导数列插入在压力列右侧，后续编辑时间/压力单元格会自动局部重算
+    PressureDerivativeResult res = m_derivedColumns->addDerivativeColumn(config);
+    if (!res.success) {
+        QMessageBox::warning(this, "失败", res.errorMessage);
+        return;
+    }
+
+    ColumnDefinition def;
+    def.name = res.columnName;
+    if (res.addedColumnIndex < m_columnDefinitions.size()) m_columnDefinitions.insert(res.addedColumnIndex, def);
+    else m_columnDefinitions.append(def);
+
+    ui->statusLabel->setText(QString("已添加导数列: %1").arg(res.columnName));
+    emit dataChanged();
+}
+
+void DataEditorWidget::onDeconvolution()
+{
+    if (m_deconvWatcher.isRunning()) return;
+
+    PressureDerivativeCalculator calculator;
+    PressureDerivativeConfig columns = calculator.autoDetectColumns(m_dataModel);
+    int rateColumn = -1;
+    for (int c = 0; c < m_columnDefinitions.size() && c < m_dataModel->columnCount(); ++c) {
+        if (m_columnDefinitions[c].type == WellTestColumnType::FlowRate) { rateColumn = c; break; }
+    }
+    if (columns.timeColumnIndex < 0 || columns.pressureColumnIndex < 0 || rateColumn < 0) {
+        QMessageBox::warning(this, "失败", "未能识别时间列、压力列或产量列，请先定义列属性。");
+        return;
+    }
+
+    // 每行的产量一直持续到下一行，产量为空的行只参与压力拟合
+    QVector<double> t, p, rateTime, rate;
+    for (int r = 0; r < m_dataModel->rowCount(); ++r) {
+        bool okT = false, okP = false, okQ = false;
+        double tv = PressureDerivativeCalculator::parseNumericValue(m_dataModel->index(r, columns.timeColumnIndex).data().toString(), &okT);
+        double pv = PressureDerivativeCalculator::parseNumericValue(m_dataModel->index(r, columns.pressureColumnIndex).data().toString(), &okP);
+        double qv = PressureDerivativeCalculator::parseNumericValue(m_dataModel->index(r, rateColumn).data().toString(), &okQ);
+        if (!okT) continue;
+        if (okP) { t.append(tv); p.append(pv); }
+        if (okQ) { rateTime.append(tv); rate.append(std::abs(qv)); }
+    }
+    RateHistory history = RateHistory::fromSamples(rateTime, rate);
+
+    m_deconvToken.reset();
+    m_deconvWatcher.setFuture(QtConcurrent::run([this, t, p, history]() {
+        return DeconvolutionEngine().run(t, p, history, &m_deconvToken);
+    }));
+    ui->btnDeconvolution->setEnabled(false);
+
+    m_deconvProgress = new QProgressDialog("正在反褶积计算...", "取消", 0, 0, this);
+    m_deconvProgress->setWindowTitle("反褶积");
+    m_deconvProgress->setWindowModality(Qt::WindowModal);
+    m_deconvProgress->setMinimumDuration(0);
+    connect(m_deconvProgress, &QProgressDialog::canceled, this, [this]() { m_deconvToken.cancel(); });
+    m_deconvProgress->show();
+}
+
+void DataEditorWidget::onDeconvolutionFinished()
+{
+    if (m_deconvProgress) {
+        m_deconvProgress->disconnect(this);
+        m_deconvProgress->deleteLater();
+        m_deconvProgress = nullptr;
+    }
+    updateButtonsState();
+
+    DeconvolutionResult res = m_deconvWatcher.result();
+    if (!res.success) {
+        if (!m_deconvToken.isCancelled()) QMessageBox::warning(this, "失败", res.errorMessage);
+        return;
+    }
+    ui->statusLabel->setText(QString("反褶积完成：迭代 %1 次，压力拟合误差 %2，初始压力 %3")
+                             .arg(res.iterations).arg(res.rmsError, 0, 'g', 4).arg(res.initialPressure, 0, 'f', 3));
+    QMessageBox::information(this, "反褶积",
+                             QString("已得到单位响应曲线（%1 点），拟合页面将使用该曲线。\n"
+                                     "曲线按参考产量 %2 换算，拟合时产量参数应取该值。")
+                             .arg(res.time.size()).arg(res.referenceRate, 0, 'g', 6));
+    emit deconvolutionReady(res.time, res.pressure, res.derivative, res.referenceRate);
+}
+
+void DataEditorWidget::onFlowPeriods()
+{
+    if (m_flowWatcher.isRunning()) return;
+
+    PressureDerivativeCalculator calculator;
+    PressureDerivativeConfig columns = calculator.autoDetectColumns(m_dataModel);
+    if (columns.timeColumnIndex < 0 || columns.pressureColumnIndex < 0) {
+        QMessageBox::warning(this, "失败", "未能识别时间列或压力列，请先定义列属性。");
+        return;
+    }
+    int rateColumn = -1;
+    for (int c = 0; c < m_columnDefinitions.size() && c < m_dataModel->columnCount(); ++c) {
+        if (m_columnDefinitions[c].type == WellTestColumnType::FlowRate) { rateColumn = c; break; }
+    }
+
+    // 时间或压力无效的行不参与划分；产量缺失的行记为 NaN（按前一个有效产量处理）
+    QVector<double> t, p, q;
+    int validRates = 0;
+    m_flowDroppedRows = 0;
+    for (int r = 0; r < m_dataModel->rowCount(); ++r) {
+        bool okT = false, okP = false, okQ = false;
+        double tv = PressureDerivativeCalculator::parseNumericValue(m_dataModel->index(r, columns.timeColumnIndex).data().toString(), &okT);
+        double pv = PressureDerivativeCalculator::parseNumericValue(m_dataModel->index(r, columns.pressureColumnIndex).data().toString(), &okP);
+        double qv = rateColumn >= 0 ? PressureDerivativeCalculator::parseNumericValue(m_dataModel->index(r, rateColumn).data().toString(), &okQ) : 0.0;
+        if (!okT || !okP) continue;
+        if (!t.isEmpty() && tv < t.last()) { ++m_flowDroppedRows; continue; }
+        t.append(tv);
+        p.append(pv);
+        q.append(okQ ? qv : std::numeric_limits<double>::quiet_NaN());
+        if (okQ) ++validRates;
+    }
+
+    m_flowByRate = validRates > 0;
+    const bool byRate = m_flowByRate;
+    m_flowToken.reset();
+    m_flowWatcher.setFuture(QtConcurrent::run([this, t, p, q, byRate]() {
+        FlowPeriodSegmenter segmenter;
+        QVector<FlowPeriod> periods = byRate ? segmenter.segmentByRate(t, q) : segmenter.segmentByPressure(t, p);
+        if (m_flowToken.isCancelled()) return QVector<FlowPeriodData>();
+        return FlowPeriodSegmenter::buildDatasets(t, p, periods, &m_flowToken);
+    }));
+    ui->btnFlowPeriods->setEnabled(false);
+
+    m_flowProgress = new QProgressDialog("正在划分流动段...", "取消", 0, 0, this);
+    m_flowProgress->setWindowTitle("流动段划分");
+    m_flowProgress->setWindowModality(Qt::WindowModal);
+    m_flowProgress->setMinimumDuration(0);
+    connect(m_flowProgress, &QProgressDialog::canceled, this, [this]() { m_flowToken.cancel(); });
+    m_flowProgress->show();
+}
+
+void DataEditorWidget::onFlowPeriodsFinished()
+{
+    if (m_flowProgress) {
+        m_flowProgress->disconnect(this);
+        m_flowProgress->deleteLater();
+        m_flowProgress = nullptr;
+    }
+    updateButtonsState();
+    if (m_flowToken.isCancelled()) return;
+
+    QVector<FlowPeriodData> datasets = m_flowWatcher.result();
+    if (datasets.isEmpty()) {
+        QMessageBox::warning(this, "失败", "有效数据点不足，无法划分流动段。");
+        return;
+    }
+    QString status = QString("已划分 %1 个流动段").arg(datasets.size());
+    if (m_flowDroppedRows > 0) {
+        status += QString("，%1 行因时间早于前一行被跳过").arg(m_flowDroppedRows);
+        QMessageBox::warning(this, "提示", QString("有 %1 行的时间早于前一行，已跳过这些行。\n请检查数据是否按时间排序。")
+                             .arg(m_flowDroppedRows));
+    }
+    ui->statusLabel->setText(status);
+
+    FlowPeriodDialog dlg(datasets, m_flowByRate, this);
+    if (dlg.exec() == QDialog::Accepted && dlg.selectedIndex() >= 0) {
+        emit flowPeriodSelected(datasets[dlg.selectedIndex()], dlg.selectedIndex());
+    }
+}
+
 // ============================================================================
 // 右键菜单与编辑
 // ============================================================================
@@ -664,4 +867,5 @@ void DataEditorWidget::onDeleteCol()
 
 void DataEditorWidget::onModelDataChanged()
 {
+    emit dataEdited();
 }
@@ -6,6 +6,9 @@
  * 2. 声明表格数据模型、代理模型和撤销栈，用于管理数据的显示和编辑。
  * 3. 声明文件加载、保存、列定义、数据计算等核心功能的槽函数。
  * 4. 声明与 Excel 读取及数据导入配置相关的辅助函数。
+ * 5. 压力导数列由 DerivedColumnTracker 跟踪，编辑源数据时只重算受影响的行。
+ * 6. 由压力列与产量列在后台反褶积，得到可供拟合的单位响应曲线。
+ * 7. 自动划分流动段（有产量列按产量，否则按压力变化方向），选中的段可送至拟合。
  */
 
 #ifndef DATAEDITORWIDGET_H
@@ -19,7 +22,14 @@
 #include <QJsonArray>
 #include <QStyledItemDelegate>
 #include <QTimer>
+#include <QFutureWatcher>
 #include "dataimportdialog.h" // 引用导入配置对话框头文件
+#include "deconvolutionengine.h"
+#include "flowperiodsegmenter.h"
+#include "cancellationtoken.h"
+
+class DerivedColumnTracker;
+class QProgressDialog;
 
 // 定义列的枚举类型，表示每一列数据的物理含义
 enum class WellTestColumnType {
@@ -93,6 +103,12 @@ signals:
     void dataChanged();
     // 文件成功加载后发送的信号
     void fileChanged(const QString& filePath, const QString& fileType);
+    // 反褶积完成：参考产量下的压降与导数（时间为 Δt）
+    void deconvolutionReady(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d, double referenceRate);
+    // 选中流动段送至拟合（index 从 0 开始）
+    void flowPeriodSelected(const FlowPeriodData& data, int index);
+    // 表格内容被编辑（单元格修改、行增删），由表格派生的拟合曲线随之失效
+    void dataEdited();
 
 private slots:
     // 打开文件按钮点击槽函数
@@ -105,6 +121,14 @@ private slots:
     void onTimeConvert();
     // 压降计算按钮点击槽函数
     void onPressureDropCalc();
+    // 导数计算按钮点击槽函数（插入受跟踪的导数列）
+    void onDerivativeCalc();
+    // 反褶积按钮点击槽函数（后台计算）
+    void onDeconvolution();
+    void onDeconvolutionFinished();
+    // 流动段划分按钮点击槽函数（后台计算）
+    void onFlowPeriods();
+    void onFlowPeriodsFinished();
 
     // 搜索框文本变化时的槽函数（带防抖）
     void onSearchTextChanged();
@@ -121,7 +145,7 @@ private slots:
     // 删除选中列
     void onDeleteCol();
 
-    // 模型数据变化时的通用处理槽
+    // 模型数据变化时的通用处理槽（单元格修改、行增删）
     void onModelDataChanged();
 
 private:
@@ -135,6 +159,17 @@ private:
     QString m_currentFilePath;             // 当前文件路径
     QMenu* m_contextMenu;                  // 右键菜单
     QTimer* m_searchTimer;                 // 搜索防抖定时器
+    DerivedColumnTracker* m_derivedColumns; // 导数列依赖跟踪
+
+    QFutureWatcher<DeconvolutionResult> m_deconvWatcher; // 后台反褶积
+    CancellationToken m_deconvToken;
+    QProgressDialog* m_deconvProgress;
+
+    QFutureWatcher<QVector<FlowPeriodData>> m_flowWatcher; // 后台流动段划分
+    CancellationToken m_flowToken;
+    QProgressDialog* m_flowProgress;
+    bool m_flowByRate;          // 按产量列划分（否则按压力）
+    int m_flowDroppedRows;      // 因时间倒退被跳过的行数
 
     // 初始化界面控件
     void initUI();
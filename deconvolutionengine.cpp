@@ -0,0 +1,326 @@
+/*
+ * deconvolutionengine.cpp
+ * 文件作用：压力-产量反褶积计算实现文件
+ * 功能描述：
+ * 1. 段 m 上 z 线性：z = a + c·s (s ∈ [0, h])，段内积分 F(u) = e^a · u · (e^{cu} - 1)/(cu)，
+ *    对两端节点的偏导由 ∫ s·e^{a+cs} ds 的闭式给出，cu 很小时改用级数避免相消
+ * 2. 每次迭代先计算各段完整积分、节点累计值与“整段在下方”时的常数偏导 A_k，
+ *    之后每个 (样本, 台阶) 只需一次查段与两次指数运算
+ * 3. 法方程由各样本块的 JᵀJ、Jᵀr 累加得到，未知数为 z 节点与 p0，规模很小，直接 LDLT 求解
+ */
+
+#include "deconvolutionengine.h"
+
+#include <QtConcurrent>
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// (e^y - 1) / y
+double expm1Ratio(double y)
+{
+    return std::abs(y) < 1e-8 ? 1.0 + 0.5 * y : std::expm1(y) / y;
+}
+
+// ((y - 1)e^y + 1) / y²，即 ∫0^1 s·e^{ys} ds
+double momentRatio(double y)
+{
+    if (std::abs(y) < 1e-3) return 0.5 + y / 3.0 + y * y / 8.0;
+    return ((y - 1.0) * std::exp(y) + 1.0) / (y * y);
+}
+
+// 当前 z 下的响应参数化，见文件头说明
+struct ResponseModel
+{
+    int n;
+    double sigma0, h;
+    QVector<double> z;
+    QVector<double> expZ;
+    QVector<double> cum;        // 节点 k 处的 pu
+    QVector<double> dIa, dIb;   // 整段积分对左/右节点的偏导
+    QVector<double> fullDeriv;  // A_k：σ 超过节点 k+1 后 pu 对 z_k 的偏导
+
+    ResponseModel(double s0, double step, const QVector<double>& zNodes)
+        : n(zNodes.size()), sigma0(s0), h(step), z(zNodes)
+    {
+        expZ.resize(n);
+        for (int k = 0; k < n; ++k) expZ[k] = std::exp(z[k]);
+        cum.resize(n);
+        dIa = QVector<double>(n, 0.0);
+        dIb = QVector<double>(n, 0.0);
+        cum[0] = expZ[0];
+        for (int m = 0; m < n - 1; ++m) {
+            const double y = z[m + 1] - z[m];
+            const double I = expZ[m] * h * expm1Ratio(y);
+            dIb[m] = expZ[m] * h * momentRatio(y);
+            dIa[m] = I - dIb[m];
+            cum[m + 1] = cum[m] + I;
+        }
+        fullDeriv.resize(n);
+        for (int k = 0; k < n; ++k) {
+            fullDeriv[k] = (k == 0 ? expZ[0] : dIb[k - 1]) + (k < n - 1 ? dIa[k] : 0.0);
+        }
+    }
+
+    // pu(e^x)；grad 非空时把 weight · ∂pu/∂z 中“部分段”的贡献加到 grad，
+    // 并返回 pu 所在段号（-1 表示首节点之前，n-1 表示末节点之后），整段部分由调用方按段号累计
+    double value(double x, double weight, double* grad, int* segment) const
+    {
+        if (x < sigma0) {
+            const double v = expZ[0] * std::exp(x - sigma0);
+            if (grad) grad[0] += weight * v;
+            if (segment) *segment = -1;
+            return v;
+        }
+        int m = int((x - sigma0) / h);
+        if (m >= n - 1) {
+            const double u = x - (sigma0 + (n - 1) * h);
+            if (grad) grad[n - 1] += weight * (dIb[n - 2] + expZ[n - 1] * u);
+            if (segment) *segment = n - 1;
+            return cum[n - 1] + expZ[n - 1] * u;
+        }
+        const double u = x - (sigma0 + m * h);
+        const double cu = (z[m + 1] - z[m]) * u / h;
+        const double F = expZ[m] * u * expm1Ratio(cu);
+        if (grad) {
+            const double dFb = expZ[m] * u * u / h * momentRatio(cu);
+            grad[m] += weight * ((m == 0 ? expZ[0] : dIb[m - 1]) + F - dFb);
+            grad[m + 1] += weight * dFb;
+        }
+        if (segment) *segment = m;
+        return cum[m] + F;
+    }
+
+    double logDerivative(double x) const
+    {
+        if (x <= sigma0) return expZ[0] * std::exp(qMin(0.0, x - sigma0));
+        double s = (x - sigma0) / h;
+        int m = qMin(int(s), n - 2);
+        double frac = qMin(1.0, s - m);
+        return std::exp(z[m] + (z[m + 1] - z[m]) * frac);
+    }
+};
+
+}
+
+DeconvolutionEngine::DeconvolutionEngine(const DeconvolutionConfig& config)
+    : m_config(config)
+{
+}
+
+DeconvolutionResult DeconvolutionEngine::run(const QVector<double>& tIn, const QVector<double>& pIn, const RateHistory& rates,
+                                             const CancellationToken* token) const
+{
+    DeconvolutionResult result;
+    if (rates.isEmpty()) {
+        result.errorMessage = "产量历史为空";
+        return result;
+    }
+
+    // 1. 有效样本与产量台阶
+    QVector<double> t, p;
+    for (int i = 0; i < tIn.size() && i < pIn.size(); ++i) {
+        if (std::isfinite(tIn[i]) && std::isfinite(pIn[i])) { t.append(tIn[i]); p.append(pIn[i]); }
+    }
+    const int nSamples = t.size();
+    QVector<double> stepTime, stepChange;
+    double qMaxAbs = 0.0;
+    for (int j = 0; j < rates.stepCount(); ++j) {
+        double dq = rates.rates[j] - (j > 0 ? rates.rates[j - 1] : 0.0);
+        qMaxAbs = qMax(qMaxAbs, std::abs(rates.rates[j]));
+        if (dq != 0.0) { stepTime.append(rates.startTimes[j]); stepChange.append(dq); }
+    }
+    if (nSamples < 10 || stepTime.isEmpty() || qMaxAbs <= 0) {
+        result.errorMessage = "有效压力点或产量变化不足";
+        return result;
+    }
+
+    // 2. 对数时间节点：覆盖所有样本到其前方台阶的 Δt
+    double minDt = -1.0, maxDt = -1.0;
+    for (double ti : t) {
+        int j = int(std::lower_bound(stepTime.constBegin(), stepTime.constEnd(), ti) - stepTime.constBegin());
+        if (j == 0) continue;
+        double nearest = ti - stepTime[j - 1];
+        if (minDt < 0 || nearest < minDt) minDt = nearest;
+        maxDt = qMax(maxDt, ti - stepTime[0]);
+    }
+    if (minDt <= 0 || maxDt <= minDt) {
+        result.errorMessage = "产量变化之后没有压力数据";
+        return result;
+    }
+    const double sigma0 = std::log(minDt);
+    const double sigmaEnd = std::log(maxDt);
+    const int nodes = qBound(4, int(std::ceil((sigmaEnd - sigma0) / std::log(10.0) * m_config.nodesPerCycle)) + 1, 200);
+    const double h = (sigmaEnd - sigma0) / (nodes - 1);
+    const int nParams = nodes + 1;      // z 节点 + p0
+    const int p0Index = nodes;
+
+    // 3. 初值：p0 取生产前压力或最大压力，z 为常数，使末点压降量级与实测一致
+    double pMax = *std::max_element(p.constBegin(), p.constEnd());
+    double pMin = *std::min_element(p.constBegin(), p.constEnd());
+    double p0 = m_config.fitInitialPressure ? pMax : m_config.initialPressure;
+    for (int i = 0; i < nSamples && m_config.fitInitialPressure; ++i) {
+        if (t[i] <= stepTime[0]) { p0 = p[i]; break; }
+    }
+    const double pressureScale = qMax(pMax - pMin, 1e-12);
+    QVector<double> z(nodes, std::log(pressureScale / (qMaxAbs * (sigmaEnd - sigma0 + 1.0))));
+
+    // 正则化权重与二阶差分算子 DᵀD
+    const double regWeight = m_config.regularization * nSamples * pressureScale * pressureScale;
+    Eigen::MatrixXd regMatrix = Eigen::MatrixXd::Zero(nParams, nParams);
+    for (int k = 1; k < nodes - 1; ++k) {
+        const int idx[3] = {k - 1, k, k + 1};
+        const double coef[3] = {1.0, -2.0, 1.0};
+        for (int a = 0; a < 3; ++a)
+            for (int b = 0; b < 3; ++b) regMatrix(idx[a], idx[b]) += regWeight * coef[a] * coef[b];
+    }
+
+    QVector<int> blocks;
+    for (int b = 0; b < nSamples; b += kBlockSize) blocks.append(b);
+
+    // 残差平方和（withJacobian 时同时累加 JᵀJ、Jᵀr）
+    auto evaluate = [&](const QVector<double>& zNodes, double pInit, bool withJacobian,
+                        Eigen::MatrixXd* jtj, Eigen::VectorXd* jtr) -> double {
+        ResponseModel model(sigma0, h, zNodes);
+        const int nb = blocks.size();
+        QVector<double> blockSse(nb, 0.0);
+        QVector<Eigen::MatrixXd> blockJtJ(withJacobian ? nb : 0);
+        QVector<Eigen::VectorXd> blockJtr(withJacobian ? nb : 0);
+        QVector<int> blockIndex(nb);
+        for (int b = 0; b < nb; ++b) blockIndex[b] = b;
+        double* sseOut = blockSse.data();
+        Eigen::MatrixXd* jtjOut = blockJtJ.data();
+        Eigen::VectorXd* jtrOut = blockJtr.data();
+
+        QtConcurrent::blockingMap(blockIndex, [&](int b) {
+            if (CancellationToken::isCancelled(token)) return;
+            const int begin = blocks[b];
+            const int end = qMin(nSamples, begin + kBlockSize);
+            Eigen::MatrixXd J;
+            Eigen::VectorXd r(end - begin);
+            if (withJacobian) J = Eigen::MatrixXd::Zero(end - begin, nParams);
+            QVector<double> segmentSum(nodes + 1);
+            Eigen::VectorXd row(withJacobian ? nParams : 0);
+            double sse = 0.0;
+            for (int i = begin; i < end; ++i) {
+                const int steps = int(std::lower_bound(stepTime.constBegin(), stepTime.constEnd(), t[i]) - stepTime.constBegin());
+                double* grad = nullptr;
+                if (withJacobian) { row.setZero(); grad = row.data(); segmentSum.fill(0.0); }
+                double conv = 0.0;
+                for (int j = 0; j < steps; ++j) {
+                    int segment = 0;
+                    conv += stepChange[j] * model.value(std::log(t[i] - stepTime[j]), stepChange[j], grad, &segment);
+                    if (withJacobian && segment > 0) segmentSum[segment] += stepChange[j];
+                }
+                if (withJacobian) {
+                    // 段号大于 k 的台阶对 z_k 的偏导均为 A_k
+                    double suffix = 0.0;
+                    for (int k = nodes - 1; k >= 0; --k) {
+                        suffix += segmentSum[k + 1];
+                        grad[k] += model.fullDeriv[k] * suffix;
+                    }
+                    grad[p0Index] = -1.0;
+                    J.row(i - begin) = row.transpose();
+                }
+                const double res = p[i] - pInit + conv;
+                r[i - begin] = res;
+                sse += res * res;
+            }
+            sseOut[b] = sse;
+            if (withJacobian) {
+                jtjOut[b] = J.transpose() * J;
+                jtrOut[b] = J.transpose() * r;
+            }
+        });
+
+        double sse = 0.0;
+        for (double v : blockSse) sse += v;
+        if (withJacobian) {
+            jtj->setZero(nParams, nParams);
+            jtr->setZero(nParams);
+            for (int b = 0; b < nb; ++b) { *jtj += blockJtJ[b]; *jtr += blockJtr[b]; }
+        }
+        return sse;
+    };
+
+    auto regularizationCost = [&](const QVector<double>& zNodes) {
+        double cost = 0.0;
+        for (int k = 1; k < nodes - 1; ++k) {
+            double d2 = zNodes[k - 1] - 2.0 * zNodes[k] + zNodes[k + 1];
+            cost += regWeight * d2 * d2;
+        }
+        return cost;
+    };
+
+    // 4. Levenberg-Marquardt
+    Eigen::MatrixXd jtj;
+    Eigen::VectorXd jtr;
+    double sse = evaluate(z, p0, true, &jtj, &jtr);
+    double cost = sse + regularizationCost(z);
+    double lambda = 1e-3;
+    int iter = 0;
+    for (; iter < m_config.maxIterations; ++iter) {
+        if (CancellationToken::isCancelled(token)) break;
+        Eigen::VectorXd zVec(nParams);
+        for (int k = 0; k < nodes; ++k) zVec[k] = z[k];
+        zVec[p0Index] = p0;
+        Eigen::VectorXd gradient = jtr + regMatrix * zVec;   // ½∇cost
+        Eigen::MatrixXd hessian = jtj + regMatrix;
+        if (!m_config.fitInitialPressure) {
+            hessian.row(p0Index).setZero();
+            hessian.col(p0Index).setZero();
+            hessian(p0Index, p0Index) = 1.0;
+            gradient[p0Index] = 0.0;
+        }
+
+        bool accepted = false;
+        double trialCost = cost, trialSse = sse;
+        QVector<double> zTrial = z;
+        double p0Trial = p0;
+        while (lambda < 1e12) {
+            Eigen::MatrixXd damped = hessian;
+            for (int a = 0; a < nParams; ++a) damped(a, a) += lambda * qMax(hessian(a, a), 1e-12);
+            Eigen::VectorXd delta = damped.ldlt().solve(-gradient);
+            for (int k = 0; k < nodes; ++k) zTrial[k] = z[k] + qBound(-2.0, delta[k], 2.0);
+            p0Trial = p0 + delta[p0Index];
+            trialSse = evaluate(zTrial, p0Trial, false, nullptr, nullptr);
+            if (CancellationToken::isCancelled(token)) break;
+            trialCost = trialSse + regularizationCost(zTrial);
+            if (trialCost < cost) { accepted = true; lambda = qMax(lambda / 10.0, 1e-12); break; }
+            lambda *= 10.0;
+        }
+        if (!accepted) break;
+
+        const double improvement = (cost - trialCost) / cost;
+        z = zTrial; p0 = p0Trial; cost = trialCost; sse = trialSse;
+        if (improvement < 1e-7) { ++iter; break; }
+        sse = evaluate(z, p0, true, &jtj, &jtr);
+    }
+    if (CancellationToken::isCancelled(token)) {
+        result.errorMessage = "计算已取消";
+        return result;
+    }
+
+    // 5. 输出：节点间加密 4 倍，乘以参考产量
+    ResponseModel model(sigma0, h, z);
+    const double qRef = m_config.referenceRate > 0 ? m_config.referenceRate : qMaxAbs;
+    const int outCount = (nodes - 1) * 4 + 1;
+    result.time.reserve(outCount);
+    result.pressure.reserve(outCount);
+    result.derivative.reserve(outCount);
+    for (int m = 0; m < outCount; ++m) {
+        const double x = sigma0 + m * h / 4.0;
+        result.time.append(std::exp(x));
+        result.pressure.append(qRef * model.value(x, 0.0, nullptr, nullptr));
+        result.derivative.append(qRef * model.logDerivative(x));
+    }
+    result.success = true;
+    result.referenceRate = qRef;
+    result.initialPressure = p0;
+    result.rmsError = std::sqrt(sse / nSamples);
+    result.iterations = iter;
+    return result;
+}
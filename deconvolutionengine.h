@@ -0,0 +1,72 @@
+/*
+ * deconvolutionengine.h
+ * 文件作用：压力-产量反褶积计算头文件
+ * 功能描述：
+ * 1. 由变产量历史与实测压力反求常产量单位响应 pu(Δt)（von Schroeter / Levitan 方法）
+ *    p(t) = p0 - Σ Δq_j · pu(t - t_j)
+ * 2. 响应以对数时间参数化：z(σ) = ln(dpu / d ln Δt)，σ = ln Δt，在等距节点上分段线性；
+ *    pu = ∫ exp(z) dσ 保证单位响应单调递增，首节点之前按单位斜率（井筒储集）外延
+ * 3. 目标函数：压力残差平方和 + ν · n · ΔP² · Σ (z 的二阶差分)²，以 Levenberg-Marquardt 求解
+ * 4. 雅可比矩阵按结构计算：每个 (样本, 台阶) 只影响所在段的两个节点，其余节点的导数为常数，
+ *    按段累计 Δq 后做后缀和得到；样本分块并行计算残差与法方程
+ * 5. 输出乘以参考产量的单位响应及其对数导数，可直接作为拟合的实测曲线
+ */
+
+#ifndef DECONVOLUTIONENGINE_H
+#define DECONVOLUTIONENGINE_H
+
+#include <QVector>
+#include <QString>
+#include "ratesuperposition.h"
+#include "cancellationtoken.h"
+
+struct DeconvolutionConfig
+{
+    int nodesPerCycle;          // 每个对数周期的节点数
+    double regularization;      // 曲率正则化权重 ν
+    int maxIterations;
+    bool fitInitialPressure;    // false 时使用 initialPressure
+    double initialPressure;
+    double referenceRate;       // 输出曲线乘以该产量；<= 0 时取产量史中最大 |q|
+
+    DeconvolutionConfig()
+        : nodesPerCycle(8), regularization(1e-5), maxIterations(60),
+          fitInitialPressure(true), initialPressure(0.0), referenceRate(0.0) {}
+};
+
+struct DeconvolutionResult
+{
+    bool success;
+    QString errorMessage;
+    QVector<double> time;           // Δt
+    QVector<double> pressure;       // 参考产量下的压降 q_ref · pu
+    QVector<double> derivative;     // q_ref · dpu / d ln Δt
+    double referenceRate;
+    double initialPressure;
+    double rmsError;                // 压力拟合均方根误差
+    int iterations;
+
+    DeconvolutionResult() : success(false), referenceRate(0.0), initialPressure(0.0), rmsError(0.0), iterations(0) {}
+};
+
+class DeconvolutionEngine
+{
+public:
+    static const int kBlockSize = 2048;     // 并行计算的样本块大小
+
+    explicit DeconvolutionEngine(const DeconvolutionConfig& config = DeconvolutionConfig());
+
+    /**
+     * @brief 反褶积计算
+     * @param t 压力采样时间（与产量史同一时间轴）
+     * @param p 实测压力
+     * @param token 非空且被取消时返回失败结果
+     */
+    DeconvolutionResult run(const QVector<double>& t, const QVector<double>& p, const RateHistory& rates,
+                            const CancellationToken* token = nullptr) const;
+
+private:
+    DeconvolutionConfig m_config;
+};
+
+#endif // DECONVOLUTIONENGINE_H
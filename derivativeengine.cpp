@@ -0,0 +1,545 @@
+/*
+ * derivativeengine.cpp
+ * 文件作用：压力导数统一计算引擎实现文件
+ * 功能描述：
+ * 1. Bourdet：左点 j 为满足 ln(ti) - ln(tj) >= L 的最近点，右点 k 为满足 ln(tk) - ln(ti) >= L 的最近点，
+ *    P' = (mL·ΔXR + mR·ΔXL) / (ΔXL + ΔXR)；只有一侧时取该侧斜率，两侧都没有时取相邻点差分
+ * 2. 区间计算时窗口端点的初始位置由二分查找确定，随后与批量计算一样以双指针推进
+ * 3. 样条：重复时间点取压力均值合并为一个节点，非单调时间先排序
+ * 4. 受影响行：点 i 的左端点取满足 ln(tj) <= ln(ti) - L 的最大 j，右端点同理，
+ *    第 row 点在相邻两点之间移动时，只有 ln(ti) ∓ L 落在 [ln(t[row-1]), ln(t[row+1])] 内的点
+ *    窗口端点或端点数值可能改变，再加上 row 及其相邻点（相邻点差分保底）
+ * 5. 流式：时间单调时第 i 点的右端点是第一个满足 ln(tk) - ln(ti) >= L 的样本，
+ *    因此新样本到达时只需检查最早未完成的点；左端点沿用批量计算的双指针
+ * 6. L 自动选择：Bourdet 导数近似 ln t 上宽 2L 的中心差分，偏差约为 L²/6 · P'''，方差随 L 增大而减小；
+ *    ln(t) 只算一次，各候选 L 在线程池中并行计算
+ */
+
+#include "derivativeengine.h"
+
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace {
+
+// 按块执行 fn(begin, end)，点数较多时各块并行
+void forEachBlock(int n, const std::function<void(int, int)>& fn)
+{
+    if (n < DerivativeEngine::kParallelThreshold) {
+        fn(0, n);
+        return;
+    }
+    const int blockSize = 65536;
+    QVector<int> starts;
+    for (int b = 0; b < n; b += blockSize) starts.append(b);
+    QtConcurrent::blockingMap(starts, [&fn, n, blockSize](int b) { fn(b, qMin(n, b + blockSize)); });
+}
+
+}
+
+QStringList DerivativeEngine::algorithmNames()
+{
+    return QStringList() << "Bourdet (L-Spacing)" << "三点加权" << "对数时间样条";
+}
+
+QVector<double> DerivativeEngine::compute(const QVector<double>& t, const QVector<double>& p,
+                                          Algorithm algorithm, double lSpacing)
+{
+    switch (algorithm) {
+    case ThreePoint: return threePoint(t, p);
+    case LogSpline: return logSpline(t, p);
+    case Bourdet:
+    default: return bourdet(t, p, lSpacing);
+    }
+}
+
+QVector<double> DerivativeEngine::bourdet(const QVector<double>& t, const QVector<double>& p, double lSpacing)
+{
+    const int n = t.size();
+    QVector<double> derivative(n, 0.0);
+    if (n == 0 || p.size() < n) return derivative;
+
+    bool monotone = true;
+    QVector<double> lnT = logTime(t, &monotone);
+    double* out = derivative.data();
+    forEachBlock(n, [&](int begin, int end) {
+        bourdetRange(lnT, p, lSpacing, monotone, begin, end, out + begin);
+    });
+    return derivative;
+}
+
+QVector<double> DerivativeEngine::threePoint(const QVector<double>& t, const QVector<double>& p)
+{
+    // L = 0 时左右窗口端点即相邻点，加权公式退化为三点加权导数
+    return bourdet(t, p, 0.0);
+}
+
+QVector<double> DerivativeEngine::logSpline(const QVector<double>& t, const QVector<double>& p)
+{
+    const int n = t.size();
+    QVector<double> derivative(n, 0.0);
+    if (n == 0 || p.size() < n) return derivative;
+
+    // 1. 有效点按时间排序（已单调时不排序）
+    bool monotone = true;
+    QVector<double> lnT = logTime(t, &monotone);
+    QVector<int> order;
+    order.reserve(n);
+    for (int i = 0; i < n; ++i) if (!std::isnan(lnT[i])) order.append(i);
+    if (!monotone) {
+        std::stable_sort(order.begin(), order.end(), [&lnT](int a, int b) { return lnT[a] < lnT[b]; });
+    }
+
+    // 2. 合并重复时间点为样条节点
+    QVector<double> x, y;
+    QVector<int> knotOf(n, -1);
+    x.reserve(order.size());
+    y.reserve(order.size());
+    int count = 0;
+    for (int idx : order) {
+        if (!x.isEmpty() && lnT[idx] - x.last() < 1e-12) {
+            ++count;
+            y.last() += (p[idx] - y.last()) / count;
+        } else {
+            x.append(lnT[idx]);
+            y.append(p[idx]);
+            count = 1;
+        }
+        knotOf[idx] = x.size() - 1;
+    }
+    const int m = x.size();
+    if (m < 2) return derivative;
+
+    // 3. 自然三次样条：三对角方程组求节点二阶导数 M (M0 = Mm-1 = 0)，追赶法求解
+    QVector<double> h(m - 1), M(m, 0.0);
+    for (int i = 0; i < m - 1; ++i) h[i] = x[i + 1] - x[i];
+    if (m > 2) {
+        QVector<double> c(m, 0.0), d(m, 0.0);
+        for (int i = 1; i < m - 1; ++i) {
+            double a = h[i - 1];
+            double b = 2.0 * (h[i - 1] + h[i]);
+            double rhs = 6.0 * ((y[i + 1] - y[i]) / h[i] - (y[i] - y[i - 1]) / h[i - 1]);
+            double denom = b - a * c[i - 1];
+            c[i] = h[i] / denom;
+            d[i] = (rhs - a * d[i - 1]) / denom;
+        }
+        for (int i = m - 2; i >= 1; --i) M[i] = d[i] - c[i] * M[i + 1];
+    }
+
+    // 4. 节点处一阶导数
+    QVector<double> knotSlope(m);
+    for (int i = 0; i < m - 1; ++i) {
+        knotSlope[i] = (y[i + 1] - y[i]) / h[i] - h[i] * (2.0 * M[i] + M[i + 1]) / 6.0;
+    }
+    knotSlope[m - 1] = (y[m - 1] - y[m - 2]) / h[m - 2] + h[m - 2] * (M[m - 2] + 2.0 * M[m - 1]) / 6.0;
+
+    for (int i = 0; i < n; ++i) {
+        if (knotOf[i] >= 0) derivative[i] = knotSlope[knotOf[i]];
+    }
+    return derivative;
+}
+
+DerivativeEngine::LSpacingSelection DerivativeEngine::selectLSpacing(const QVector<double>& t, const QVector<double>& p,
+                                                                   double lMin, double lMax, int count)
+{
+    LSpacingSelection selection;
+    selection.bestIndex = -1;
+    selection.lSpacing = kDefaultLSpacing;
+    const int n = t.size();
+    if (n < 5 || p.size() < n || count < 1 || !(lMin > 0) || lMax < lMin) return selection;
+
+    // 1. 有效点按时间排序，噪声沿时间顺序的相邻点计算
+    bool monotone = true;
+    QVector<double> lnT = logTime(t, &monotone);
+    QVector<int> order;
+    order.reserve(n);
+    for (int i = 0; i < n; ++i) if (!std::isnan(lnT[i])) order.append(i);
+    if (!monotone) {
+        std::stable_sort(order.begin(), order.end(), [&lnT](int a, int b) { return lnT[a] < lnT[b]; });
+    }
+    const int m = order.size();
+    if (m < 5) return selection;
+
+    // 2. 曲率：对较光滑的导数再求两次导数
+    const double pilotL = qBound(lMin, 0.3, lMax);
+    QVector<double> curvature = bourdet(t, bourdet(t, bourdet(t, p, pilotL), pilotL), pilotL);
+    double curvature2 = 0.0;
+    for (int i : order) curvature2 += curvature[i] * curvature[i];
+    curvature2 /= m;
+
+    // 3. 各候选 L 并行计算导数与评分
+    QVector<LSpacingCandidate> candidates(count);
+    LSpacingCandidate* out = candidates.data();
+    QVector<int> indices(count);
+    for (int k = 0; k < count; ++k) indices[k] = k;
+    QtConcurrent::blockingMap(indices, [&](int k) {
+        const double L = (count == 1) ? lMin : lMin * std::pow(lMax / lMin, double(k) / (count - 1));
+        QVector<double> d(n);
+        bourdetRange(lnT, p, L, monotone, 0, n, d.data());
+
+        double rough = 0.0;
+        for (int j = 1; j < m - 1; ++j) {
+            double e = d[order[j + 1]] - 2.0 * d[order[j]] + d[order[j - 1]];
+            rough += e * e;
+        }
+        LSpacingCandidate& c = out[k];
+        c.lSpacing = L;
+        c.noise = rough / (m - 2) / 6.0;
+        c.bias = L * L * L * L / 36.0 * curvature2;
+        c.score = c.noise + c.bias;
+    });
+
+    selection.candidates = candidates;
+    for (int k = 0; k < count; ++k) {
+        if (selection.bestIndex < 0 || candidates[k].score < candidates[selection.bestIndex].score) selection.bestIndex = k;
+    }
+    selection.lSpacing = candidates[selection.bestIndex].lSpacing;
+    return selection;
+}
+
+QVector<double> DerivativeEngine::logTime(const QVector<double>& t, bool* monotone)
+{
+    const int n = t.size();
+    QVector<double> lnTime(n);
+    double* lnT = lnTime.data();
+    const double* src = t.constData();
+    forEachBlock(n, [lnT, src](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            lnT[i] = (src[i] > 0) ? std::log(src[i]) : std::numeric_limits<double>::quiet_NaN();
+        }
+    });
+
+    if (monotone) {
+        *monotone = true;
+        for (int i = 1; i < n; ++i) {
+            if (!(src[i] >= src[i - 1])) { *monotone = false; break; }
+        }
+    }
+    return lnTime;
+}
+
+void DerivativeEngine::bourdetRange(const QVector<double>& lnTime, const QVector<double>& pressure, double lSpacing,
+                                    bool monotone, int begin, int end, double* out)
+{
+    const int n = lnTime.size();
+    begin = qMax(0, begin);
+    end = qMin(n, end);
+    if (begin >= end) return;
+
+    const double* lnT = lnTime.constData();
+    const double* p = pressure.constData();
+    const int count = end - begin;
+
+    // 1. 确定每个点的左右窗口端点 j、k
+    QVector<int> leftIndex(count), rightIndex(count);
+    int* left = leftIndex.data();
+    int* right = rightIndex.data();
+    if (monotone) {
+        windowsMonotone(lnT, n, lSpacing, begin, end, left, right);
+    } else {
+        for (int i = begin; i < end; ++i) {
+            left[i - begin] = findLeftPoint(lnT, i, lSpacing);
+            right[i - begin] = findRightPoint(lnT, n, i, lSpacing);
+        }
+    }
+
+    // 两侧都不满足 L-Spacing 时（数据极少或 L 设置过大）使用相邻点差分作为保底；
+    // 缺失的一侧以当前点自身代替，下方按单侧斜率处理
+    for (int i = begin; i < end; ++i) {
+        int& j = left[i - begin];
+        int& k = right[i - begin];
+        if (j < 0 && k < 0) {
+            if (i > 0) j = i - 1;
+            else if (i < n - 1) k = i + 1;
+        }
+        if (j < 0) j = i;
+        if (k < 0) k = i;
+    }
+
+    // 2. 加权斜率：P' = (mL * ΔXR + mR * ΔXL) / (ΔXL + ΔXR)，只有一侧时取该侧斜率
+    for (int i = begin; i < end; ++i) {
+        const int j = left[i - begin];
+        const int k = right[i - begin];
+        const double deltaXL = lnT[i] - lnT[j];
+        const double deltaXR = lnT[k] - lnT[i];
+        const double mL = slope(lnT[i], lnT[j], p[i], p[j]);
+        const double mR = slope(lnT[k], lnT[i], p[k], p[i]);
+        const double sum = deltaXL + deltaXR;
+        const double weighted = (sum > 1e-12) ? (mL * deltaXR + mR * deltaXL) / sum : 0.0;
+        out[i - begin] = (j == i) ? mR : ((k == i) ? mL : weighted);
+    }
+}
+
+QVector<QPair<int, int>> DerivativeEngine::affectedRanges(const QVector<double>& lnTime, double lSpacing, int row)
+{
+    QVector<QPair<int, int>> ranges;
+    const int n = lnTime.size();
+    if (row < 0 || row >= n) return ranges;
+
+    const double* lnT = lnTime.constData();
+    const double inf = std::numeric_limits<double>::infinity();
+    const double lo = (row > 0) ? lnT[row - 1] : -inf;
+    const double hi = (row < n - 1) ? lnT[row + 1] : inf;
+    if (std::isnan(lnT[row]) || std::isnan(lo) || std::isnan(hi)) {
+        ranges.append(qMakePair(0, n));
+        return ranges;
+    }
+
+    // 按 ln t 值查找下标区间（跳过开头 t <= 0 的点），两端放宽以免舍入误差漏掉边界点
+    const int firstValid = int(std::partition_point(lnT, lnT + n, [](double v) { return std::isnan(v); }) - lnT);
+    const double eps = 1e-9;
+    auto indexRange = [&](double a, double b) {
+        int first = int(std::lower_bound(lnT + firstValid, lnT + n, a - eps) - lnT);
+        int last = int(std::upper_bound(lnT + firstValid, lnT + n, b + eps) - lnT);
+        return qMakePair(first, last);
+    };
+
+    QVector<QPair<int, int>> candidates;
+    candidates.append(qMakePair(qMax(0, row - 1), qMin(n, row + 2)));
+    candidates.append(indexRange(lo + lSpacing, hi + lSpacing));   // 左端点可能改变的点
+    candidates.append(indexRange(lo - lSpacing, hi - lSpacing));   // 右端点可能改变的点
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const QPair<int, int>& c : candidates) {
+        if (c.first >= c.second) continue;
+        if (!ranges.isEmpty() && c.first <= ranges.last().second) ranges.last().second = qMax(ranges.last().second, c.second);
+        else ranges.append(c);
+    }
+    return ranges;
+}
+
+void DerivativeEngine::windowsMonotone(const double* lnT, int n, double lSpacing, int begin, int end, int* left, int* right)
+{
+    // 时间单调不减时 t <= 0 的点 (NaN) 只出现在开头
+    const int firstValid = int(std::partition_point(lnT, lnT + n, [](double v) { return std::isnan(v); }) - lnT);
+    int i = begin;
+    for (; i < end && i < firstValid; ++i) {
+        left[i - begin] = -1;
+        right[i - begin] = -1;
+    }
+    if (i >= end) return;
+
+    // 满足 ln(ti) - ln(tj) >= L 的 j 构成 [firstValid, l) 前缀，满足 ln(tk) - ln(ti) >= L 的 k 构成 [r, n) 后缀，
+    // 起点由二分查找确定，之后随 i 增大 l、r 均只前移不回退
+    const double lnT0 = lnT[i];
+    int l = int(std::partition_point(lnT + firstValid, lnT + i,
+                                     [lnT0, lSpacing](double v) { return lnT0 - v >= lSpacing; }) - lnT);
+    int r = int(std::partition_point(lnT + i + 1, lnT + n,
+                                     [lnT0, lSpacing](double v) { return v - lnT0 < lSpacing; }) - lnT);
+    for (; i < end; ++i) {
+        while (l < i && lnT[i] - lnT[l] >= lSpacing) ++l;
+        left[i - begin] = (l > firstValid) ? l - 1 : -1;
+
+        if (r <= i) r = i + 1;
+        while (r < n && lnT[r] - lnT[i] < lSpacing) ++r;
+        right[i - begin] = (r < n) ? r : -1;
+    }
+}
+
+int DerivativeEngine::findLeftPoint(const double* lnT, int currentIndex, double lSpacing)
+{
+    if (currentIndex <= 0 || std::isnan(lnT[currentIndex])) return -1;
+
+    // 从当前点向左搜索，找到第一个满足距离 >= L 的点
+    for (int j = currentIndex - 1; j >= 0; --j) {
+        if (std::isnan(lnT[j])) continue;
+        if ((lnT[currentIndex] - lnT[j]) >= lSpacing) {
+            return j;
+        }
+    }
+    return -1;
+}
+
+int DerivativeEngine::findRightPoint(const double* lnT, int n, int currentIndex, double lSpacing)
+{
+    if (currentIndex >= n - 1 || std::isnan(lnT[currentIndex])) return -1;
+
+    // 从当前点向右搜索，找到第一个满足距离 >= L 的点
+    for (int k = currentIndex + 1; k < n; ++k) {
+        if (std::isnan(lnT[k])) continue;
+        if ((lnT[k] - lnT[currentIndex]) >= lSpacing) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+double DerivativeEngine::slope(double lnT1, double lnT2, double p1, double p2)
+{
+    double deltaLnT = lnT1 - lnT2;
+    if (!(std::abs(deltaLnT) >= 1e-10)) {
+        return 0.0;
+    }
+    return (p1 - p2) / deltaLnT;
+}
+
+// ============================================================================
+// IncrementalDerivative
+// ============================================================================
+
+void IncrementalDerivative::reset(const QVector<double>& t, const QVector<double>& p, double lSpacing)
+{
+    m_t = t;
+    m_p = p;
+    m_lSpacing = lSpacing;
+    m_lnT = DerivativeEngine::logTime(m_t, &m_monotone);
+    m_derivative = QVector<double>(m_t.size(), 0.0);
+    if (m_p.size() < m_t.size()) return;
+
+    double* out = m_derivative.data();
+    forEachBlock(m_t.size(), [this, out](int begin, int end) {
+        DerivativeEngine::bourdetRange(m_lnT, m_p, m_lSpacing, m_monotone, begin, end, out + begin);
+    });
+}
+
+QVector<QPair<int, int>> IncrementalDerivative::update(int index, double t, double p)
+{
+    QVector<QPair<int, int>> ranges;
+    const int n = m_t.size();
+    if (index < 0 || index >= n || m_p.size() < n) return ranges;
+
+    // 只有单调数据上保持顺序的正时间修改可以局部重算
+    bool local = m_monotone && t > 0 && m_t[index] > 0
+                 && (index == 0 || m_t[index - 1] <= t)
+                 && (index == n - 1 || t <= m_t[index + 1]);
+    m_t[index] = t;
+    m_p[index] = p;
+    if (!local) {
+        QVector<double> tCopy = m_t, pCopy = m_p;
+        reset(tCopy, pCopy, m_lSpacing);
+        ranges.append(qMakePair(0, n));
+        return ranges;
+    }
+
+    m_lnT[index] = std::log(t);
+    ranges = DerivativeEngine::affectedRanges(m_lnT, m_lSpacing, index);
+    double* out = m_derivative.data();
+    for (const QPair<int, int>& r : ranges) {
+        DerivativeEngine::bourdetRange(m_lnT, m_p, m_lSpacing, true, r.first, r.second, out + r.first);
+    }
+    return ranges;
+}
+
+// ============================================================================
+// DerivativeStream
+// ============================================================================
+
+DerivativeStream::DerivativeStream(double lSpacing)
+{
+    reset(lSpacing);
+}
+
+void DerivativeStream::reset(double lSpacing)
+{
+    m_lSpacing = lSpacing;
+    m_base = 0;
+    m_count = 0;
+    m_nextFinal = 0;
+    m_firstValid = -1;
+    m_left = 0;
+    m_t.clear();
+    m_lnT.clear();
+    m_p.clear();
+    m_finalized.clear();
+}
+
+bool DerivativeStream::append(double t, double p)
+{
+    if (std::isnan(t) || (!m_t.isEmpty() && t < m_t.last())) return false;
+
+    m_t.append(t);
+    m_lnT.append(t > 0 ? std::log(t) : std::numeric_limits<double>::quiet_NaN());
+    m_p.append(p);
+    const qint64 newest = m_count++;
+    if (t > 0 && m_firstValid < 0) {
+        m_firstValid = newest;
+        m_left = newest;
+    }
+
+    // 最早未完成的点不满足时，之后的点（ln t 更大）也不满足
+    while (m_nextFinal < m_count) {
+        const qint64 i = m_nextFinal;
+        const double lnTi = m_lnT[local(i)];
+        double value = 0.0;
+        if (!std::isnan(lnTi)) {
+            if (newest <= i || !(m_lnT[local(newest)] - lnTi >= m_lSpacing)) break;
+            while (m_left < i && lnTi - m_lnT[local(m_left)] >= m_lSpacing) ++m_left;
+            value = valueAt(i, m_left > m_firstValid ? m_left - 1 : -1, newest);
+        }
+        m_finalized.append({m_t[local(i)], m_p[local(i)], value});
+        ++m_nextFinal;
+    }
+
+    trim();
+    return true;
+}
+
+QVector<DerivativeStream::Sample> DerivativeStream::takeFinalized()
+{
+    QVector<Sample> result;
+    result.swap(m_finalized);
+    return result;
+}
+
+QVector<DerivativeStream::Sample> DerivativeStream::provisional() const
+{
+    QVector<Sample> result;
+    result.reserve(int(m_count - m_nextFinal));
+    qint64 left = m_left;
+    for (qint64 i = m_nextFinal; i < m_count; ++i) {
+        const double lnTi = m_lnT[local(i)];
+        double value = 0.0;
+        if (!std::isnan(lnTi)) {
+            while (left < i && lnTi - m_lnT[local(left)] >= m_lSpacing) ++left;
+            value = valueAt(i, left > m_firstValid ? left - 1 : -1, -1);
+        }
+        result.append({m_t[local(i)], m_p[local(i)], value});
+    }
+    return result;
+}
+
+QVector<DerivativeStream::Sample> DerivativeStream::finish()
+{
+    QVector<Sample> result = takeFinalized();
+    result += provisional();
+    m_nextFinal = m_count;
+    return result;
+}
+
+double DerivativeStream::valueAt(qint64 i, qint64 j, qint64 k) const
+{
+    if (j < 0 && k < 0) {
+        if (i > 0) j = i - 1;
+        else if (i < m_count - 1) k = i + 1;
+    }
+    if (j < 0) j = i;
+    if (k < 0) k = i;
+
+    const double lnTi = m_lnT[local(i)], lnTj = m_lnT[local(j)], lnTk = m_lnT[local(k)];
+    const double pi = m_p[local(i)], pj = m_p[local(j)], pk = m_p[local(k)];
+    const double deltaXL = lnTi - lnTj;
+    const double deltaXR = lnTk - lnTi;
+    const double mL = DerivativeEngine::slope(lnTi, lnTj, pi, pj);
+    const double mR = DerivativeEngine::slope(lnTk, lnTi, pk, pi);
+    const double sum = deltaXL + deltaXR;
+    const double weighted = (sum > 1e-12) ? (mL * deltaXR + mR * deltaXL) / sum : 0.0;
+    return (j == i) ? mR : ((k == i) ? mL : weighted);
+}
+
+void DerivativeStream::trim()
+{
+    // 之后的点只可能用到 m_left - 1（左端点）与 m_nextFinal - 1（相邻点保底）之后的样本
+    qint64 keep = m_nextFinal - 1;
+    if (m_firstValid >= 0 && m_nextFinal > m_firstValid) keep = qMin(keep, m_left - 1);
+    keep = qMax(keep, m_base);
+    const int drop = local(keep);
+    // 攒够一批再整体前移，摊还代价 O(1)
+    if (drop < 1024 || drop < m_t.size() / 2) return;
+    m_t.remove(0, drop);
+    m_lnT.remove(0, drop);
+    m_p.remove(0, drop);
+    m_base = keep;
+}
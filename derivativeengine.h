@@ -0,0 +1,189 @@
+/*
+ * derivativeengine.h
+ * 文件作用：压力导数统一计算引擎头文件
+ * 功能描述：
+ * 1. 数据导入、绘图、拟合与理论模型共用同一套导数核心算法，相同数据得到相同的导数曲线
+ * 2. 可选算法：Bourdet L-Spacing 加权导数、三点加权导数（L = 0 的 Bourdet）、
+ *    对数时间三次样条导数 (ln t 上的自然三次样条在节点处的斜率)
+ * 3. 批量接口一次返回整条曲线；区间接口只计算指定行，供局部重算与分块并行使用
+ * 4. ln(t) 只计算一次，时间单调时窗口端点以双指针推进，代价 O(n)；大数组按块并行
+ * 5. 增量接口：修改单个点后只重算 Bourdet 窗口涉及该点的行 (IncrementalDerivative)
+ * 6. 流式接口：实时采集逐点追加，右侧 L 窗口满足后输出最终导数，只保留窗口内的样本 (DerivativeStream)
+ * 7. L-Spacing 自动选择：并行计算一组 L 的导数，按噪声与曲率偏差估计的总误差推荐 L
+ */
+
+#ifndef DERIVATIVEENGINE_H
+#define DERIVATIVEENGINE_H
+
+#include <QVector>
+#include <QPair>
+#include <QStringList>
+
+class DerivativeEngine
+{
+public:
+    enum Algorithm {
+        Bourdet = 0,    // Bourdet L-Spacing 加权导数
+        ThreePoint,     // 相邻三点加权导数
+        LogSpline       // 对数时间三次样条导数
+    };
+
+    static QStringList algorithmNames();
+
+    static constexpr double kDefaultLSpacing = 0.15;   // 默认 L-Spacing (对数周期)
+    static const int kParallelThreshold = 200000;       // 超过该点数时分块并行计算
+
+    // =========================================================================
+    // 批量接口：返回与 t 等长的 dP/d(ln t)，t <= 0 的点导数为 0
+    // =========================================================================
+
+    static QVector<double> compute(const QVector<double>& t, const QVector<double>& p,
+                                   Algorithm algorithm, double lSpacing = kDefaultLSpacing);
+
+    static QVector<double> bourdet(const QVector<double>& t, const QVector<double>& p, double lSpacing);
+    static QVector<double> threePoint(const QVector<double>& t, const QVector<double>& p);
+    static QVector<double> logSpline(const QVector<double>& t, const QVector<double>& p);
+
+    // =========================================================================
+    // L-Spacing 自动选择
+    // =========================================================================
+
+    struct LSpacingCandidate {
+        double lSpacing;
+        double noise;   // 导数噪声方差估计：相邻点二阶差分均方 / 6（白噪声的二阶差分方差为 6σ²）
+        double bias;    // 曲率偏差平方估计：(L² / 6 · d²P'/d(ln t)²)² 的均值
+        double score;   // noise + bias，导数均方误差的估计
+    };
+
+    struct LSpacingSelection {
+        QVector<LSpacingCandidate> candidates;  // 按 L 升序
+        int bestIndex;                          // score 最小的候选，数据不足时为 -1
+        double lSpacing;                        // 推荐值，数据不足时为 kDefaultLSpacing
+    };
+
+    /**
+     * @brief 在 [lMin, lMax] 内按对数等分取 count 个 L，并行计算导数并评分
+     *        曲率由 L = qBound(lMin, 0.3, lMax) 的导数再求两次 Bourdet 导数估计
+     */
+    static LSpacingSelection selectLSpacing(const QVector<double>& t, const QVector<double>& p,
+                                            double lMin = 0.05, double lMax = 0.5, int count = 20);
+
+    // =========================================================================
+    // 区间接口
+    // =========================================================================
+
+    /**
+     * @brief 计算 ln(t)，t <= 0 的点记为 NaN
+     * @param monotone 输出时间是否单调不减
+     */
+    static QVector<double> logTime(const QVector<double>& t, bool* monotone = nullptr);
+
+    /**
+     * @brief 只计算 [begin, end) 行的 Bourdet 导数，写入 out[0 .. end-begin)
+     *        结果与批量接口在这些行上的值完全一致
+     * @param lnT 由 logTime 计算的整条 ln(t)
+     */
+    static void bourdetRange(const QVector<double>& lnT, const QVector<double>& p, double lSpacing,
+                             bool monotone, int begin, int end, double* out);
+
+    /**
+     * @brief 第 row 行的时间或压力改变后（时间保持单调不减），Bourdet 导数可能改变的行区间
+     *        返回升序、互不重叠的 [first, last) 区间；lnT 为修改后的值
+     */
+    static QVector<QPair<int, int>> affectedRanges(const QVector<double>& lnT, double lSpacing, int row);
+
+private:
+    static void windowsMonotone(const double* lnT, int n, double lSpacing, int begin, int end, int* left, int* right);
+    static int findLeftPoint(const double* lnT, int currentIndex, double lSpacing);
+    static int findRightPoint(const double* lnT, int n, int currentIndex, double lSpacing);
+    // 单边导数 (p1 - p2) / (lnT1 - lnT2)；时间无效或两点重合时返回 0
+    static double slope(double lnT1, double lnT2, double p1, double p2);
+
+    friend class DerivativeStream;
+};
+
+// ============================================================================
+// 增量 Bourdet 导数：缓存 t、p、ln(t) 与导数，单点修改后只重算受影响的行
+// ============================================================================
+class IncrementalDerivative
+{
+public:
+    IncrementalDerivative() : m_lSpacing(DerivativeEngine::kDefaultLSpacing), m_monotone(true) {}
+
+    void reset(const QVector<double>& t, const QVector<double>& p, double lSpacing);
+
+    /**
+     * @brief 修改第 index 点的时间与数值并重算导数
+     *        时间顺序被打乱、t <= 0 或原数据非单调时整体重算
+     * @return 导数被重算的 [first, last) 区间
+     */
+    QVector<QPair<int, int>> update(int index, double t, double p);
+
+    int size() const { return m_t.size(); }
+    double lSpacing() const { return m_lSpacing; }
+    const QVector<double>& time() const { return m_t; }
+    const QVector<double>& values() const { return m_p; }
+    const QVector<double>& derivative() const { return m_derivative; }
+
+private:
+    QVector<double> m_t, m_p, m_lnT, m_derivative;
+    double m_lSpacing;
+    bool m_monotone;
+};
+
+// ============================================================================
+// 流式 Bourdet 导数：样本按时间顺序逐点追加
+// 第 i 点出现满足 ln(tk) - ln(ti) >= L 的样本后其导数不再改变（最终值），与批量接口结果一致；
+// 尚未满足的尾部点可取临时值（按当前数据结束时批量接口的结果）
+// 只保留最早未完成点的左窗口端点之后的样本，内存与每点代价与测试时长无关
+// ============================================================================
+class DerivativeStream
+{
+public:
+    struct Sample {
+        double t;
+        double p;
+        double derivative;
+    };
+
+    explicit DerivativeStream(double lSpacing = DerivativeEngine::kDefaultLSpacing);
+
+    void reset(double lSpacing);
+
+    /**
+     * @brief 追加一个样本
+     * @return 时间早于上一个样本时拒绝并返回 false
+     */
+    bool append(double t, double p);
+
+    // 取出自上次调用以来得到最终值的点（按时间顺序）
+    QVector<Sample> takeFinalized();
+
+    // 尚未得到最终值的尾部点及其临时导数
+    QVector<Sample> provisional() const;
+
+    // 数据结束：尾部点按临时值定稿，返回所有未取出的点；之后需 reset 才能继续追加
+    QVector<Sample> finish();
+
+    double lSpacing() const { return m_lSpacing; }
+    qint64 sampleCount() const { return m_count; }
+    qint64 finalizedCount() const { return m_nextFinal; }
+    int bufferedCount() const { return m_t.size(); }
+
+private:
+    // 全局下标 i 的导数，j、k 为左右窗口端点（-1 表示不存在），缺失时的处理与 bourdetRange 相同
+    double valueAt(qint64 i, qint64 j, qint64 k) const;
+    int local(qint64 i) const { return int(i - m_base); }
+    void trim();
+
+    double m_lSpacing;
+    qint64 m_base;          // 缓冲区首个样本的全局下标
+    qint64 m_count;         // 已追加的样本数
+    qint64 m_nextFinal;     // 最早未完成点的全局下标
+    qint64 m_firstValid;    // 首个 t > 0 样本的全局下标，-1 表示尚未出现
+    qint64 m_left;          // 左窗口双指针：[m_firstValid, m_left) 满足 ln(ti) - ln(tj) >= L
+    QVector<double> m_t, m_lnT, m_p;
+    QVector<Sample> m_finalized;
+};
+
+#endif // DERIVATIVEENGINE_H
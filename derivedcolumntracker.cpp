@@ -0,0 +1,213 @@
+/*
+ * derivedcolumntracker.cpp
+ * 文件作用：数据表派生列（压力导数列）依赖跟踪实现文件
+ * 功能描述：
+ * 1. 时间偏移、压降定义与 PressureDerivativeCalculator::calculatePressureDerivative 一致：
+ *    存在 t <= 0 时自动加最小正时间的 1/10，压降 = 首行压力 - 当前压力
+ * 2. 单元格编辑由 IncrementalDerivative 确定需要重算的行区间，只写回这些行
+ */
+
+#include "derivedcolumntracker.h"
+#include <QStandardItem>
+#include <QBrush>
+#include <QColor>
+#include <cmath>
+
+namespace {
+double itemValue(const QStandardItem* item)
+{
+    return item ? PressureDerivativeCalculator::parseNumericValue(item->text()) : 0.0;
+}
+}
+
+DerivedColumnTracker::DerivedColumnTracker(QStandardItemModel* model, QObject* parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_updating(false)
+{
+    connect(m_model, &QStandardItemModel::itemChanged, this, &DerivedColumnTracker::onItemChanged);
+    connect(m_model, &QStandardItemModel::rowsInserted, this, &DerivedColumnTracker::onRowsChanged);
+    connect(m_model, &QStandardItemModel::rowsRemoved, this, &DerivedColumnTracker::onRowsChanged);
+    connect(m_model, &QStandardItemModel::columnsInserted, this, &DerivedColumnTracker::onColumnsInserted);
+    connect(m_model, &QStandardItemModel::columnsRemoved, this, &DerivedColumnTracker::onColumnsRemoved);
+    connect(m_model, &QStandardItemModel::modelReset, this, &DerivedColumnTracker::clear);
+}
+
+PressureDerivativeResult DerivedColumnTracker::addDerivativeColumn(const PressureDerivativeConfig& config)
+{
+    PressureDerivativeResult result;
+    if (m_model->rowCount() < 3) {
+        result.errorMessage = "数据行数不足（至少需要3行）";
+        return result;
+    }
+    if (config.pressureColumnIndex < 0 || config.pressureColumnIndex >= m_model->columnCount()) {
+        result.errorMessage = "压力列索引无效";
+        return result;
+    }
+    if (config.timeColumnIndex < 0 || config.timeColumnIndex >= m_model->columnCount()) {
+        result.errorMessage = "时间列索引无效";
+        return result;
+    }
+    if (config.lSpacing <= 0) {
+        result.errorMessage = "L-Spacing参数必须大于0";
+        return result;
+    }
+
+    // 在压力列后面插入新列（列号调整由 onColumnsInserted 处理已跟踪的列）
+    const int target = config.pressureColumnIndex + 1;
+    m_model->insertColumn(target);
+    QString columnName = QString("压力导数\\%1").arg(config.pressureUnit);
+    m_model->setHorizontalHeaderItem(target, new QStandardItem(columnName));
+
+    DerivedColumn column;
+    column.timeColumn = config.timeColumnIndex < target ? config.timeColumnIndex : config.timeColumnIndex + 1;
+    column.pressureColumn = config.pressureColumnIndex;
+    column.targetColumn = target;
+    column.config = config;
+    column.timeOffset = 0.0;
+    m_columns.append(column);
+    recompute(m_columns.last());
+
+    result.success = true;
+    result.addedColumnIndex = target;
+    result.columnName = columnName;
+    result.processedRows = m_model->rowCount();
+    return result;
+}
+
+bool DerivedColumnTracker::isDerivedColumn(int column) const
+{
+    for (const DerivedColumn& c : m_columns) if (c.targetColumn == column) return true;
+    return false;
+}
+
+void DerivedColumnTracker::clear()
+{
+    m_columns.clear();
+}
+
+void DerivedColumnTracker::recompute(DerivedColumn& column)
+{
+    const int rows = m_model->rowCount();
+    column.rawTime.resize(rows);
+    column.rawPressure.resize(rows);
+    double minPositive = -1.0;
+    bool hasNonPositive = false;
+    for (int r = 0; r < rows; ++r) {
+        double t = itemValue(m_model->item(r, column.timeColumn));
+        column.rawTime[r] = t;
+        column.rawPressure[r] = itemValue(m_model->item(r, column.pressureColumn));
+        if (t <= 0) hasNonPositive = true;
+        else if (minPositive < 0 || t < minPositive) minPositive = t;
+    }
+
+    if (column.config.autoTimeOffset) {
+        column.timeOffset = !hasNonPositive ? 0.0 : (minPositive > 0 ? minPositive * 0.1 : column.config.timeOffset);
+    } else {
+        column.timeOffset = column.config.timeOffset;
+    }
+
+    QVector<double> t(rows), dp(rows);
+    const double p0 = rows > 0 ? column.rawPressure[0] : 0.0;
+    for (int r = 0; r < rows; ++r) {
+        t[r] = column.rawTime[r] + column.timeOffset;
+        dp[r] = p0 - column.rawPressure[r];
+    }
+    column.derivative.reset(t, dp, column.config.lSpacing);
+    writeRows(column, 0, rows);
+}
+
+void DerivedColumnTracker::writeRows(const DerivedColumn& column, int first, int last)
+{
+    const QVector<double>& d = column.derivative.derivative();
+    last = qMin(last, qMin(d.size(), m_model->rowCount()));
+    if (first >= last) return;
+
+    // 逐格写入会为每个单元格发出 dataChanged，视图逐格刷新；改为整段写完后只通知一次
+    // （绘图页监听 dataChanged，按该行段局部更新已打开的曲线）
+    m_updating = true;
+    const bool blocked = m_model->blockSignals(true);
+    for (int r = first; r < last; ++r) {
+        double v = d[r];
+        QString text = (std::isnan(v) || std::isinf(v)) ? QString("0") : QString::number(v, 'g', 6);
+        QStandardItem* item = m_model->item(r, column.targetColumn);
+        if (item) {
+            item->setText(text);
+        } else {
+            item = new QStandardItem(text);
+            item->setForeground(QBrush(QColor("#1565C0")));
+            m_model->setItem(r, column.targetColumn, item);
+        }
+    }
+    m_model->blockSignals(blocked);
+    emit m_model->dataChanged(m_model->index(first, column.targetColumn), m_model->index(last - 1, column.targetColumn));
+    m_updating = false;
+}
+
+void DerivedColumnTracker::onItemChanged(QStandardItem* item)
+{
+    if (m_updating || !item) return;
+    const int row = item->row();
+    const int col = item->column();
+
+    for (DerivedColumn& c : m_columns) {
+        if (col != c.timeColumn && col != c.pressureColumn) continue;
+        if (row < 0 || row >= c.rawTime.size()) { recompute(c); continue; }
+
+        double value = itemValue(item);
+        if (col == c.timeColumn) {
+            // 时间偏移依赖全列最小正时间，存在偏移或出现 t <= 0 时整列重算
+            if (c.timeOffset != 0.0 || value <= 0) {
+                recompute(c);
+                continue;
+            }
+            c.rawTime[row] = value;
+        } else {
+            // 首行压力是压降基准
+            if (row == 0) {
+                recompute(c);
+                continue;
+            }
+            c.rawPressure[row] = value;
+        }
+
+        const double dp = c.rawPressure[0] - c.rawPressure[row];
+        for (const QPair<int, int>& range : c.derivative.update(row, c.rawTime[row] + c.timeOffset, dp)) {
+            writeRows(c, range.first, range.second);
+        }
+    }
+}
+
+void DerivedColumnTracker::onRowsChanged()
+{
+    if (m_updating) return;
+    for (DerivedColumn& c : m_columns) recompute(c);
+}
+
+void DerivedColumnTracker::onColumnsInserted(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid()) return;
+    const int count = last - first + 1;
+    for (DerivedColumn& c : m_columns) {
+        if (c.timeColumn >= first) c.timeColumn += count;
+        if (c.pressureColumn >= first) c.pressureColumn += count;
+        if (c.targetColumn >= first) c.targetColumn += count;
+    }
+}
+
+void DerivedColumnTracker::onColumnsRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid()) return;
+    const int count = last - first + 1;
+    auto removed = [first, last](int col) { return col >= first && col <= last; };
+    for (int i = m_columns.size() - 1; i >= 0; --i) {
+        DerivedColumn& c = m_columns[i];
+        if (removed(c.timeColumn) || removed(c.pressureColumn) || removed(c.targetColumn)) {
+            m_columns.removeAt(i);
+            continue;
+        }
+        if (c.timeColumn > last) c.timeColumn -= count;
+        if (c.pressureColumn > last) c.pressureColumn -= count;
+        if (c.targetColumn > last) c.targetColumn -= count;
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * derivedcolumntracker.h
+ * 文件作用：数据表派生列（压力导数列）依赖跟踪头文件
+ * 功能描述：
+ * 1. 记录每个导数列依赖的时间列、压力列与 L-Spacing，并缓存数值与导数
+ * 2. 编辑源列单元格时只重算 Bourdet 窗口涉及该行的导数并写回，不再整列重算
+ * 3. 插入/删除行、修改首行压力（压降基准）或时间偏移改变时整列重算；
+ *    插入/删除列时同步调整列号，源列或导数列被删除时取消跟踪
+ */
+
+#ifndef DERIVEDCOLUMNTRACKER_H
+#define DERIVEDCOLUMNTRACKER_H
+
+#include <QObject>
+#include <QList>
+#include <QStandardItemModel>
+#include "derivativeengine.h"
+#include "pressurederivativecalculator.h"
+
+class DerivedColumnTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DerivedColumnTracker(QStandardItemModel* model, QObject* parent = nullptr);
+
+    /**
+     * @brief 在压力列右侧插入导数列并开始跟踪
+     * @return 计算结果（列号、列名、行数）
+     */
+    PressureDerivativeResult addDerivativeColumn(const PressureDerivativeConfig& config);
+
+    bool isDerivedColumn(int column) const;
+    void clear();
+
+private slots:
+    void onItemChanged(QStandardItem* item);
+    void onRowsChanged();
+    void onColumnsInserted(const QModelIndex& parent, int first, int last);
+    void onColumnsRemoved(const QModelIndex& parent, int first, int last);
+
+private:
+    struct DerivedColumn {
+        int timeColumn;
+        int pressureColumn;
+        int targetColumn;
+        PressureDerivativeConfig config;
+        double timeOffset;                  // 实际使用的时间偏移
+        QVector<double> rawTime;            // 未加偏移的时间
+        QVector<double> rawPressure;
+        IncrementalDerivative derivative;   // 偏移后的时间、压降与导数
+    };
+
+    // 从表格读取源列并整列重算、写回
+    void recompute(DerivedColumn& column);
+    // 写回 [first, last) 行：写入期间屏蔽模型信号，结束后对整段发出一次 dataChanged
+    void writeRows(const DerivedColumn& column, int first, int last);
+
+    QStandardItemModel* m_model;
+    QList<DerivedColumn> m_columns;
+    bool m_updating;    // 写回导数期间忽略 itemChanged
+};
+
+#endif // DERIVEDCOLUMNTRACKER_H
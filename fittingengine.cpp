@@ -0,0 +1,712 @@
+/*
+ * fittingengine.cpp
+ * 文件作用：试井自动拟合计算引擎实现文件
+ * 功能描述：
+ * 1. 实现 LM 非线性回归算法（自 FittingWidget 迁移而来，算法保持不变）
+ * 2. 实现差分进化 (DE/rand/1/bin) 全局优化算法：
+ *    - 在对数/线性参数空间内搜索，越界个体采用 bounce-back 方式拉回边界内
+ *    - 种群按批次通过 QtConcurrent 并行评估，批次之间响应停止请求
+ *    - 全局搜索结束后，将最优个体作为初值交给 LM 精修
+ * 3. 拟合结束后在完整观测数据上计算验证误差
+ * 4. 多精度渐进拟合：反演阶数通过参数 "N" 随每次计算传入模型，
+ *    不再切换模型的全局高精度开关，DE 并行评估与界面计算互不干扰
+ * 5. 可分离最小二乘：每次残差计算中解析/一维求解尺度参数（变量投影）
+ * 6. 检查点：LM 状态定期通过信号发出，恢复时从记录的阶段与迭代处继续
+ * 7. 观测对数与权重每阶段预处理一次，残差写入复用缓冲区（LM 交换缓冲区、差分复用、DE 线程局部缓冲区）
+ */
+
+#include "fittingengine.h"
+#include "fittingobserveddata.h"
+#include "fittingseparable.h"
+
+#include <QtConcurrent>
+#include <QThread>
+#include <QRandomGenerator>
+#include <QDateTime>
+#include <QDebug>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <Eigen/Dense>
+
+namespace {
+
+// 差分进化个体
+struct DECandidate {
+    QVector<double> x;              // 搜索空间坐标（对数参数为 log10 值）
+    QMap<QString, double> params;   // 对应的完整模型参数
+    double cost;                    // 目标函数值 (MSE)
+    ModelCurveData curve;           // 评估时得到的理论曲线（最优个体直接用于发布快照）
+
+    DECandidate() : cost(std::numeric_limits<double>::max()) {}
+};
+
+} // namespace
+
+QJsonObject FittingCheckpoint::toJson() const
+{
+    QJsonObject paramObj;
+    for(auto it = params.cbegin(); it != params.cend(); ++it) paramObj[it.key()] = it.value();
+
+    QJsonObject obj;
+    obj["modelType"] = modelType;
+    obj["params"] = paramObj;
+    obj["lambda"] = lambda;
+    obj["stage"] = stage;
+    obj["iteration"] = iteration;
+    obj["totalIterations"] = totalIterations;
+    obj["bestCost"] = bestCost;
+    obj["savedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    return obj;
+}
+
+FittingCheckpoint FittingCheckpoint::fromJson(const QJsonObject& obj)
+{
+    FittingCheckpoint ckpt;
+    if(obj.isEmpty()) return ckpt;
+    ckpt.modelType = obj.value("modelType").toInt(-1);
+    QJsonObject paramObj = obj.value("params").toObject();
+    for(auto it = paramObj.constBegin(); it != paramObj.constEnd(); ++it) ckpt.params.insert(it.key(), it.value().toDouble());
+    ckpt.lambda = obj.value("lambda").toDouble(0.01);
+    ckpt.stage = obj.value("stage").toInt();
+    ckpt.iteration = obj.value("iteration").toInt();
+    ckpt.totalIterations = obj.value("totalIterations").toInt();
+    ckpt.bestCost = obj.value("bestCost").toDouble();
+    return ckpt;
+}
+
+FittingEngine::FittingEngine(ModelManager* modelManager, QObject* parent)
+    : QObject(parent)
+    , m_modelManager(modelManager)
+    , m_validationError(0.0)
+    , m_weight(0.5)
+    , m_finalPressureCount(0)
+    , m_algorithm(FittingAlgorithm::LevenbergMarquardt)
+    , m_schedule(defaultContinuationSchedule())
+    , m_stehfestN(8)
+    , m_eliminateScale(false)
+    , m_eliminateTimeShift(false)
+    , m_boundHandling(BoundHandling::Projected)
+    , m_lastError(0.0)
+    , m_checkpointInterval(60)
+    , m_runModelType(-1)
+    , m_totalIterations(0)
+{
+}
+
+void FittingEngine::setModelManager(ModelManager* m)
+{
+    m_modelManager = m;
+}
+
+void FittingEngine::setObservedData(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d)
+{
+    m_fitTime = t;
+    m_fitPressure = p;
+    m_fitDerivative = d;
+    m_obsTime = t;
+    m_obsPressure = p;
+    m_obsDerivative = d;
+}
+
+void FittingEngine::setValidationData(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d)
+{
+    m_valTime = t;
+    m_valPressure = p;
+    m_valDerivative = d;
+}
+
+double FittingEngine::getValidationError() const { return m_validationError; }
+QVector<double> FittingEngine::getFinalResiduals() const { return m_finalResiduals; }
+QVector<char> FittingEngine::getFinalResidualStates() const { return m_finalStates; }
+int FittingEngine::getFinalPressureCount() const { return m_finalPressureCount; }
+
+void FittingEngine::storeFinalResiduals(const FittingResidualKernel& kernel, const QVector<double>& residuals, const ModelCurveData& curve)
+{
+    m_finalResiduals = residuals;
+    kernel.pointStates(std::get<1>(curve), std::get<2>(curve), m_finalStates);
+    m_finalPressureCount = qMin(kernel.pressureCount(), std::get<1>(curve).size());
+}
+
+void FittingEngine::setAlgorithm(FittingAlgorithm algorithm) { m_algorithm = algorithm; }
+FittingAlgorithm FittingEngine::getAlgorithm() const { return m_algorithm; }
+void FittingEngine::setDifferentialEvolutionConfig(const DifferentialEvolutionConfig& config) { m_deConfig = config; }
+DifferentialEvolutionConfig FittingEngine::getDifferentialEvolutionConfig() const { return m_deConfig; }
+
+void FittingEngine::setContinuationSchedule(const QVector<FittingFidelityStage>& stages)
+{
+    m_schedule = stages.isEmpty() ? singleStageSchedule() : stages;
+}
+
+QVector<FittingFidelityStage> FittingEngine::getContinuationSchedule() const { return m_schedule; }
+
+void FittingEngine::setBoundHandling(BoundHandling mode) { m_boundHandling = mode; }
+void FittingEngine::setCheckpointInterval(int seconds) { m_checkpointInterval = seconds; }
+void FittingEngine::setResumeCheckpoint(const FittingCheckpoint& checkpoint) { m_resume = checkpoint; }
+FittingCheckpoint FittingEngine::takeStopCheckpoint()
+{
+    FittingCheckpoint ckpt = m_stopCheckpoint;
+    m_stopCheckpoint = FittingCheckpoint();
+    return ckpt;
+}
+
+void FittingEngine::setSeparableOptions(bool eliminateScale, bool eliminateTimeShift)
+{
+    m_eliminateScale = eliminateScale;
+    m_eliminateTimeShift = eliminateTimeShift;
+}
+
+QVector<FittingFidelityStage> FittingEngine::defaultContinuationSchedule()
+{
+    QVector<FittingFidelityStage> s;
+    s.append(FittingFidelityStage(8, 4, 20, 1e-2));
+    s.append(FittingFidelityStage(20, 6, 15, 5e-3));
+    s.append(FittingFidelityStage(0, 8, 10, 1e-4));
+    return s;
+}
+
+QVector<FittingFidelityStage> FittingEngine::singleStageSchedule()
+{
+    return QVector<FittingFidelityStage>{ FittingFidelityStage(0, 8, 50, 0.0) };
+}
+
+void FittingEngine::activateStage(const FittingFidelityStage& stage)
+{
+    if(stage.pointsPerDecade > 0) {
+        FittingObservedData::decimateLogTime(m_fitTime, m_fitPressure, m_fitDerivative, stage.pointsPerDecade,
+                                             DecimationMethod::Median, m_obsTime, m_obsPressure, m_obsDerivative);
+    } else {
+        m_obsTime = m_fitTime;
+        m_obsPressure = m_fitPressure;
+        m_obsDerivative = m_fitDerivative;
+    }
+    m_stehfestN = qMax(2, stage.stehfestN - stage.stehfestN % 2);
+    m_obsKernel.prepare(m_obsPressure, m_obsDerivative, m_weight);
+}
+
+ModelCurveData FittingEngine::evaluateCurve(ModelManager::ModelType modelType, const QMap<QString, double>& params, const QVector<double>& t)
+{
+    QMap<QString, double> p = params;
+    p["N"] = m_stehfestN;
+    return m_modelManager->calculateTheoreticalCurve(modelType, p, t, &m_cancelToken);
+}
+
+void FittingEngine::requestStop() { m_cancelToken.cancel(); }
+bool FittingEngine::isStopRequested() const { return m_cancelToken.isCancelled(); }
+void FittingEngine::resetStop() { m_cancelToken.reset(); }
+
+void FittingEngine::updateDependentParams(QMap<QString, double>& params)
+{
+    if(params.contains("L") && params.contains("Lf") && params["L"] > 1e-9)
+        params["LfD"] = params["Lf"] / params["L"];
+}
+
+QMap<QString, double> FittingEngine::run(ModelManager::ModelType modelType, const QList<FitParameter>& params, double weight)
+{
+    m_lastError = 0.0;
+    m_finalResiduals.clear();
+    m_finalStates.clear();
+    m_finalPressureCount = 0;
+    m_weight = weight;
+    m_valKernel.prepare(m_valPressure, m_valDerivative, weight);
+
+    QMap<QString, double> currentParamMap;
+    for(const auto& p : params) currentParamMap.insert(p.name, p.value);
+
+    // 从检查点继续：恢复参数，跳过全局搜索和已完成的阶段
+    const FittingCheckpoint resume = m_resume;
+    m_resume = FittingCheckpoint();
+    m_stopCheckpoint = FittingCheckpoint();
+    const bool resuming = resume.isValid() && resume.modelType == static_cast<int>(modelType);
+    if(resuming) {
+        for(auto it = resume.params.cbegin(); it != resume.params.cend(); ++it)
+            if(currentParamMap.contains(it.key())) currentParamMap[it.key()] = it.value();
+    }
+    updateDependentParams(currentParamMap);
+    m_runModelType = static_cast<int>(modelType);
+    m_totalIterations = resuming ? resume.totalIterations : 0;
+    m_checkpointTimer.start();
+
+    // 变产量历史生效时理论曲线按产量史叠加（单位响应取 q = 1），q 不影响曲线，不参与拟合与消去
+    const bool multiRate = m_modelManager && m_modelManager->getRateHistory().isMultiRate();
+    QVector<int> fitIndices;
+    for(int i=0; i<params.size(); ++i) if(params[i].isFit && !(multiRate && params[i].name == "q")) fitIndices.append(i);
+    if(fitIndices.isEmpty() || !m_modelManager) return currentParamMap;
+
+    // 可分离最小二乘：尺度参数从非线性参数集合中移除，在每次残差计算中求最优值
+    m_scaleParam = SeparableParameter();
+    m_timeParam = SeparableParameter();
+    QVector<int> nonlinearIndices;
+    for(int idx : fitIndices) {
+        const FitParameter& fp = params[idx];
+        if(m_eliminateScale && !m_scaleParam.isActive() && (fp.name == "h" || fp.name == "q" || fp.name == "B")) {
+            m_scaleParam.name = fp.name; m_scaleParam.min = fp.min; m_scaleParam.max = fp.max;
+            m_scaleParam.exponent = (fp.name == "h") ? -1.0 : 1.0; // factor 与 q、B 成正比，与 h 成反比
+            continue;
+        }
+        // 产量史叠加时阶跃时刻与分析起点不随 phi、Ct 缩放，曲线不再是整体水平平移，不能消去
+        if(m_eliminateTimeShift && !multiRate && !m_timeParam.isActive() && (fp.name == "phi" || fp.name == "Ct")) {
+            m_timeParam.name = fp.name; m_timeParam.min = fp.min; m_timeParam.max = fp.max;
+            m_timeParam.exponent = -1.0; // tD 与 phi、Ct 成反比
+            continue;
+        }
+        nonlinearIndices.append(idx);
+    }
+    fitIndices = nonlinearIndices;
+
+    const QVector<FittingFidelityStage> schedule = m_schedule.isEmpty() ? singleStageSchedule() : m_schedule;
+
+    // 全局搜索在最粗的精度阶段进行
+    int lmBase = 0, lmSpan = 100;
+    if(m_algorithm == FittingAlgorithm::DifferentialEvolution && !resuming) {
+        activateStage(schedule.first());
+        currentParamMap = runDifferentialEvolution(modelType, params, fitIndices, currentParamMap, 0, 50);
+        lmBase = 50; lmSpan = 50;
+    }
+
+    // 逐级提升精度：每个阶段以上一阶段的结果为初值
+    double finalMSE = 0.0;
+    const int firstStage = resuming ? qBound(0, resume.stage, schedule.size() - 1) : 0;
+    for(int s=firstStage; s<schedule.size(); ++s) {
+        if(isStopRequested()) break;
+        const FittingFidelityStage& stage = schedule[s];
+        activateStage(stage);
+        int base = lmBase + lmSpan * s / schedule.size();
+        int span = lmSpan / schedule.size();
+        const bool resumeStage = resuming && s == firstStage;
+        currentParamMap = runLevenbergMarquardt(modelType, params, fitIndices, currentParamMap, base, span, finalMSE,
+                                                stage.maxIterations, stage.plateauTolerance, s == schedule.size() - 1,
+                                                s, resumeStage ? resume.lambda : 0.01, resumeStage ? resume.iteration : 0);
+    }
+
+    updateDependentParams(currentParamMap);
+
+    // 已停止：直接返回目前最优参数，按当前阶段精度快速绘制曲线（不传取消令牌，停止标志保持置位）
+    if(isStopRequested()) {
+        m_validationError = m_lastError;
+        QMap<QString, double> p = currentParamMap;
+        p["N"] = m_stehfestN;
+        publishSnapshot(m_lastError, currentParamMap, m_modelManager->calculateTheoreticalCurve(modelType, p));
+        return currentParamMap;
+    }
+
+    // 最终结果与显示曲线均在完整精度下计算
+    activateStage(schedule.last());
+    m_validationError = m_valTime.isEmpty() ? finalMSE : calculateValidationError(modelType, currentParamMap);
+    emitIteration(m_validationError, modelType, currentParamMap);
+    return currentParamMap;
+}
+
+QMap<QString, double> FittingEngine::runDifferentialEvolution(ModelManager::ModelType modelType, const QList<FitParameter>& params,
+                                                              const QVector<int>& fitIndices, const QMap<QString, double>& startParams,
+                                                              int progressBase, int progressSpan)
+{
+    const int dim = fitIndices.size();
+    const DifferentialEvolutionConfig cfg = m_deConfig;
+    if(dim == 0) return startParams;
+
+    // 1. 建立搜索空间：使用投影模式的参数变换（对数或线性内部坐标，可行域为有限区间）
+    QVector<FittingParameterTransform> transforms(dim);
+    QVector<double> lower(dim), upper(dim), startX(dim);
+    for(int d=0; d<dim; ++d) {
+        const FitParameter& fp = params[fitIndices[d]];
+        double v = startParams.value(fp.name, fp.value);
+        transforms[d] = FittingParameterTransform::forParameter(fp, BoundHandling::Projected);
+        startX[d] = transforms[d].toInternal(v);
+        lower[d] = transforms[d].internalLower();
+        upper[d] = transforms[d].internalUpper();
+        // 无上下限的参数：在初值附近给出有限搜索范围
+        if(!std::isfinite(lower[d])) lower[d] = startX[d] - (transforms[d].type() == FittingParameterTransform::Log ? 3.0 : std::abs(startX[d]) + 1.0);
+        if(!std::isfinite(upper[d])) upper[d] = startX[d] + (transforms[d].type() == FittingParameterTransform::Log ? 3.0 : std::abs(startX[d]) + 1.0);
+        startX[d] = qBound(lower[d], startX[d], upper[d]);
+    }
+
+    auto toParams = [&](const QVector<double>& x) {
+        QMap<QString, double> map = startParams;
+        for(int d=0; d<dim; ++d) {
+            const QString& name = params[fitIndices[d]].name;
+            map[name] = transforms[d].toExternal(x[d]);
+        }
+        updateDependentParams(map);
+        return map;
+    };
+
+    auto objective = [this, modelType](QMap<QString, double>& p, ModelCurveData* curve) {
+        // 每个并行线程复用自己的残差缓冲区
+        static thread_local QVector<double> r;
+        calculateResiduals(p, modelType, r, curve, &p);
+        if(r.isEmpty()) return std::numeric_limits<double>::max();
+        double mse = calculateSumSquaredError(r) / r.size();
+        return std::isfinite(mse) ? mse : std::numeric_limits<double>::max();
+    };
+
+    // 分批并行评估：批次之间检查停止请求
+    int batchSize = cfg.batchSize > 0 ? cfg.batchSize : qMax(1, QThread::idealThreadCount());
+    auto evaluate = [&](QVector<DECandidate>& pop) -> bool {
+        for(int begin=0; begin<pop.size(); begin+=batchSize) {
+            if(isStopRequested()) return false;
+            QVector<DECandidate*> batch;
+            for(int i=begin; i<qMin(begin + batchSize, (int)pop.size()); ++i) batch.append(&pop[i]);
+            QtConcurrent::blockingMap(batch, [&objective](DECandidate* c) { c->cost = objective(c->params, &c->curve); });
+        }
+        // 最后一批计算中途停止时，部分目标值来自被取消的曲线，不能参与选择
+        return !isStopRequested();
+    };
+
+    // 2. 初始化种群：第 0 个个体为当前参数，其余在边界内均匀随机分布
+    int popSize = cfg.populationSize > 0 ? cfg.populationSize : qBound(15, 10 * dim, 80);
+    popSize = qMax(popSize, 5);
+    QRandomGenerator rng(cfg.seed);
+
+    QVector<DECandidate> population(popSize);
+    for(int i=0; i<popSize; ++i) {
+        DECandidate& c = population[i];
+        c.x.resize(dim);
+        for(int d=0; d<dim; ++d)
+            c.x[d] = (i == 0) ? startX[d] : lower[d] + rng.generateDouble() * (upper[d] - lower[d]);
+        c.params = toParams(c.x);
+    }
+
+    if(!evaluate(population)) return startParams;
+
+    int bestIdx = 0;
+    for(int i=1; i<popSize; ++i) if(population[i].cost < population[bestIdx].cost) bestIdx = i;
+    publishSnapshot(population[bestIdx].cost, population[bestIdx].params, population[bestIdx].curve);
+
+    // 3. 进化主循环 (DE/rand/1/bin)
+    for(int gen=0; gen<cfg.maxGenerations; ++gen) {
+        if(isStopRequested()) break;
+        emit progressChanged(progressBase + gen * progressSpan / cfg.maxGenerations);
+
+        QVector<DECandidate> trials(popSize);
+        for(int i=0; i<popSize; ++i) {
+            int r1, r2, r3;
+            do { r1 = rng.bounded(popSize); } while(r1 == i);
+            do { r2 = rng.bounded(popSize); } while(r2 == i || r2 == r1);
+            do { r3 = rng.bounded(popSize); } while(r3 == i || r3 == r1 || r3 == r2);
+
+            const QVector<double>& xi = population[i].x;
+            DECandidate& t = trials[i];
+            t.x = xi;
+            int jRand = rng.bounded(dim);
+            for(int d=0; d<dim; ++d) {
+                if(d != jRand && rng.generateDouble() >= cfg.crossoverRate) continue;
+                double v = population[r1].x[d] + cfg.mutationFactor * (population[r2].x[d] - population[r3].x[d]);
+                // bounce-back：越界时在父代与边界之间随机取值，保持种群多样性
+                if(v < lower[d]) v = lower[d] + rng.generateDouble() * (xi[d] - lower[d]);
+                if(v > upper[d]) v = upper[d] - rng.generateDouble() * (upper[d] - xi[d]);
+                t.x[d] = v;
+            }
+            t.params = toParams(t.x);
+        }
+
+        if(!evaluate(trials)) break;
+
+        // 贪婪选择
+        bool improved = false;
+        for(int i=0; i<popSize; ++i) {
+            if(trials[i].cost <= population[i].cost) {
+                population[i] = trials[i];
+                if(population[i].cost < population[bestIdx].cost) { bestIdx = i; improved = true; }
+            }
+        }
+        if(improved) publishSnapshot(population[bestIdx].cost, population[bestIdx].params, population[bestIdx].curve);
+
+        // 收敛判断：种群目标函数的相对离散度足够小
+        double worst = population[0].cost;
+        for(const auto& c : population) worst = qMax(worst, c.cost);
+        double best = population[bestIdx].cost;
+        if(worst < std::numeric_limits<double>::max() && (worst - best) <= cfg.tolerance * qMax(std::abs(best), 1e-12)) break;
+    }
+
+    return population[bestIdx].params;
+}
+
+QMap<QString, double> FittingEngine::runLevenbergMarquardt(ModelManager::ModelType modelType, const QList<FitParameter>& params,
+                                                           const QVector<int>& fitIndices, const QMap<QString, double>& startParams,
+                                                           int progressBase, int progressSpan, double& finalMSE,
+                                                           int maxIter, double plateauTolerance, bool isFinalStage,
+                                                           int stageIndex, double initialLambda, int startIter)
+{
+    int nParams = fitIndices.size();
+    double lambda = initialLambda; double currentSSE = 1e15;
+    int plateauCount = 0;
+    QMap<QString, double> currentParamMap = startParams;
+
+    ModelCurveData curve;
+    // 残差缓冲区在整个 LM 过程中复用：接受试探步时交换，不重新分配
+    QVector<double> residuals, newRes;
+    calculateResiduals(currentParamMap, modelType, residuals, &curve, &currentParamMap);
+    ModelCurveData acceptedCurve = curve;   // 当前参数对应的理论曲线（隐式共享，不复制数据）
+    if(residuals.isEmpty()) { finalMSE = 0.0; return currentParamMap; }
+    currentSSE = calculateSumSquaredError(residuals);
+    publishSnapshot(currentSSE/residuals.size(), currentParamMap, curve);
+    // 所有拟合参数均已被解析消去
+    if(nParams == 0) {
+        finalMSE = currentSSE / residuals.size();
+        if(isFinalStage) storeFinalResiduals(m_obsKernel, residuals, curve);
+        return currentParamMap;
+    }
+
+    // 参数变换：内部坐标 u，投影模式下 u 受上下限约束，logit 模式下无约束
+    QVector<FittingParameterTransform> transforms(nParams);
+    for(int i=0; i<nParams; ++i) transforms[i] = FittingParameterTransform::forParameter(params[fitIndices[i]], m_boundHandling);
+
+    int iter = startIter;
+    for(; iter < maxIter; ++iter) {
+        if(isStopRequested()) break;
+        if (!residuals.isEmpty() && (currentSSE / residuals.size()) < 3e-3) break;
+        // 非最终阶段：连续两步误差下降不明显即提升精度
+        if (!isFinalStage && plateauCount >= 2) break;
+
+        emit progressChanged(progressBase + iter * progressSpan / maxIter);
+        QVector<QVector<double>> J = computeJacobian(currentParamMap, residuals, fitIndices, modelType, params, transforms);
+        if(isStopRequested()) break;
+        int nRes = residuals.size();
+
+        QVector<QVector<double>> H(nParams, QVector<double>(nParams, 0.0));
+        QVector<double> g(nParams, 0.0);
+        for(int k=0; k<nRes; ++k) {
+            for(int i=0; i<nParams; ++i) {
+                g[i] += J[k][i] * residuals[k];
+                for(int j=0; j<=i; ++j) H[i][j] += J[k][i] * J[k][j];
+            }
+        }
+        for(int i=0; i<nParams; ++i) for(int j=i+1; j<nParams; ++j) H[i][j] = H[j][i];
+
+        // 有效集：位于边界且下降方向 (-g) 指向可行域外的参数本步固定，只在自由参数子空间内求步长
+        QVector<double> u(nParams);
+        QVector<int> freeIdx;
+        for(int i=0; i<nParams; ++i) {
+            u[i] = transforms[i].toInternal(currentParamMap[params[fitIndices[i]].name]);
+            double tol = 1e-10 * (1.0 + std::abs(u[i]));
+            bool atLower = u[i] <= transforms[i].internalLower() + tol && g[i] > 0;
+            bool atUpper = u[i] >= transforms[i].internalUpper() - tol && g[i] < 0;
+            if(!atLower && !atUpper) freeIdx.append(i);
+        }
+        // 所有参数均被边界锁定：已满足约束最优条件 (KKT)
+        if(freeIdx.isEmpty()) break;
+        int nFree = freeIdx.size();
+
+        bool stepAccepted = false;
+        for(int tryIter=0; tryIter<5; ++tryIter) {
+            QVector<QVector<double>> H_lm(nFree, QVector<double>(nFree));
+            QVector<double> negG(nFree);
+            for(int a=0; a<nFree; ++a) {
+                for(int b=0; b<nFree; ++b) H_lm[a][b] = H[freeIdx[a]][freeIdx[b]];
+                H_lm[a][a] += lambda * (1.0 + std::abs(H[freeIdx[a]][freeIdx[a]]));
+                negG[a] = -g[freeIdx[a]];
+            }
+            QVector<double> delta = solveLinearSystem(H_lm, negG);
+
+            // 投影步：试探点投影回可行域，越界分量停在边界上，下一次迭代自动进入有效集
+            QMap<QString, double> trialMap = currentParamMap;
+            for(int a=0; a<nFree; ++a) {
+                int i = freeIdx[a];
+                double uNew = transforms[i].project(u[i] + delta[a]);
+                trialMap[params[fitIndices[i]].name] = transforms[i].toExternal(uNew);
+            }
+            updateDependentParams(trialMap);
+
+            calculateResiduals(trialMap, modelType, newRes, &curve, &trialMap);
+            if(isStopRequested()) break;
+            double newSSE = calculateSumSquaredError(newRes);
+            if(!newRes.isEmpty() && newSSE < currentSSE) {
+                if((currentSSE - newSSE) < plateauTolerance * currentSSE) ++plateauCount; else plateauCount = 0;
+                currentSSE = newSSE; currentParamMap = trialMap; residuals.swap(newRes); lambda /= 10.0; stepAccepted = true;
+                acceptedCurve = curve;
+                publishSnapshot(currentSSE/nRes, currentParamMap, curve);
+                break;
+            } else { lambda *= 10.0; }
+        }
+        // 试探中途停止：本次迭代未完成，不计数也不发布检查点，继续时从该迭代重新开始
+        if(!stepAccepted && isStopRequested()) break;
+        if(!stepAccepted && lambda > 1e10) break;
+
+        ++m_totalIterations;
+        if(m_checkpointInterval > 0 && m_checkpointTimer.elapsed() >= m_checkpointInterval * 1000LL)
+            emitCheckpoint(stageIndex, iter + 1, lambda, currentSSE / nRes, currentParamMap);
+    }
+
+    finalMSE = currentSSE / residuals.size();
+    if(isFinalStage) storeFinalResiduals(m_obsKernel, residuals, acceptedCurve);
+    // 停止时记录中断位置；阶段正常结束时记录下一阶段的起点
+    if(isStopRequested()) emitCheckpoint(stageIndex, iter, lambda, finalMSE, currentParamMap);
+    else if(!isFinalStage) emitCheckpoint(stageIndex + 1, 0, 0.01, finalMSE, currentParamMap);
+    return currentParamMap;
+}
+
+void FittingEngine::emitCheckpoint(int stage, int iteration, double lambda, double cost, const QMap<QString, double>& params)
+{
+    FittingCheckpoint ckpt;
+    ckpt.modelType = m_runModelType;
+    ckpt.params = params;
+    ckpt.lambda = lambda;
+    ckpt.stage = stage;
+    ckpt.iteration = iteration;
+    ckpt.totalIterations = m_totalIterations;
+    ckpt.bestCost = cost;
+    m_checkpointTimer.restart();
+    if(isStopRequested()) m_stopCheckpoint = ckpt;
+    emit checkpointReached(ckpt);
+}
+
+void FittingEngine::emitIteration(double error, ModelManager::ModelType modelType, const QMap<QString, double>& params)
+{
+    publishSnapshot(error, params, evaluateCurve(modelType, params));
+}
+
+void FittingEngine::publishSnapshot(double error, const QMap<QString, double>& params, const ModelCurveData& curve)
+{
+    m_lastError = error;
+    if(std::get<1>(curve).isEmpty()) return; // 计算已取消
+
+    // QVector/QMap 为隐式共享，此处仅增加引用计数
+    QSharedPointer<FittingIterationSnapshot> snapshot(new FittingIterationSnapshot);
+    snapshot->error = error;
+    snapshot->params = params;
+    snapshot->t = std::get<0>(curve);
+    snapshot->p = std::get<1>(curve);
+    snapshot->d = std::get<2>(curve);
+    emit iterationUpdated(snapshot);
+}
+
+void FittingEngine::calculateResiduals(const QMap<QString, double>& params, ModelManager::ModelType modelType,
+                                       QVector<double>& out, ModelCurveData* curveOut, QMap<QString, double>* paramsOut) {
+    if(!m_modelManager || m_obsTime.isEmpty()) { out.clear(); return; }
+    QMap<QString, double> projected = params;
+    ModelCurveData res;
+    if(m_timeParam.isActive()) {
+        res = evaluateWithTimeShift(modelType, projected);
+    } else {
+        res = evaluateCurve(modelType, params, m_obsTime);
+        if(m_scaleParam.isActive() && !std::get<1>(res).isEmpty())
+            applyScaleProjection(std::get<1>(res), std::get<2>(res), projected);
+    }
+    if(curveOut) *curveOut = res;
+    if(paramsOut) *paramsOut = projected;
+    m_obsKernel.evaluate(std::get<1>(res), std::get<2>(res), out);
+}
+
+void FittingEngine::applyScaleProjection(QVector<double>& pCal, QVector<double>& dCal, QMap<QString, double>& params) const
+{
+    double v0 = params.value(m_scaleParam.name);
+    if(v0 <= 0) return;
+    double s = m_obsKernel.optimalLogShift(pCal, dCal);
+
+    // 压力倍数 exp(s) = (v/v0)^exponent，换算为参数值后受上下限约束
+    double v = v0 * exp(s * m_scaleParam.exponent);
+    if(m_scaleParam.max > m_scaleParam.min) v = qBound(qMax(m_scaleParam.min, 1e-12), v, m_scaleParam.max);
+    double factor = pow(v / v0, m_scaleParam.exponent);
+
+    for(double& x : pCal) x *= factor;
+    for(double& x : dCal) x *= factor;
+    params[m_scaleParam.name] = v;
+}
+
+ModelCurveData FittingEngine::evaluateWithTimeShift(ModelManager::ModelType modelType, QMap<QString, double>& params)
+{
+    // 参数 v 变为 v' 时：curve(t; v') = curve(t * a; v)，a = (v'/v)^exponent = v/v'
+    double v0 = params.value(m_timeParam.name);
+    if(v0 <= 0) return ModelCurveData();
+    double vLo = qMax(m_timeParam.min, v0 * 1e-3);
+    double vHi = (m_timeParam.max > vLo) ? qMin(m_timeParam.max, v0 * 1e3) : v0 * 1e3;
+    double logA1 = log(pow(vLo / v0, m_timeParam.exponent));
+    double logA2 = log(pow(vHi / v0, m_timeParam.exponent));
+    double logAMin = qMin(logA1, logA2), logAMax = qMax(logA1, logA2);
+
+    // 1. 覆盖全部可能平移范围的致密曲线（每对数周期 20 点），每组形状参数只计算一次
+    double tMin = std::numeric_limits<double>::max(), tMax = 0.0;
+    for(double t : m_obsTime) { if(t > 0) { tMin = qMin(tMin, t); tMax = qMax(tMax, t); } }
+    if(tMax <= 0) return ModelCurveData();
+    double lMin = log10(tMin) + logAMin / log(10.0);
+    double lMax = log10(tMax) + logAMax / log(10.0);
+    int nGrid = qMax(2, int((lMax - lMin) * 20) + 2);
+    QVector<double> grid = ModelManager::generateLogTimeSteps(nGrid, lMin, qMax(lMax, lMin + 1e-6));
+    ModelCurveData dense = evaluateCurve(modelType, params, grid);
+    if(std::get<1>(dense).isEmpty()) return ModelCurveData();
+
+    // 2. 在缓存曲线上插值，竖直平移仍解析求解
+    auto project = [&](double logA, QVector<double>& pOut, QVector<double>& dOut, QMap<QString, double>& pOutParams) {
+        pOut = FittingSeparable::interpolateLogLog(std::get<0>(dense), std::get<1>(dense), m_obsTime, exp(logA));
+        dOut = FittingSeparable::interpolateLogLog(std::get<0>(dense), std::get<2>(dense), m_obsTime, exp(logA));
+        if(m_scaleParam.isActive()) applyScaleProjection(pOut, dOut, pOutParams);
+        return m_obsKernel.sumSquares(pOut, dOut);
+    };
+    auto cost = [&](double logA) {
+        QVector<double> pTmp, dTmp; QMap<QString, double> paramsTmp = params;
+        return project(logA, pTmp, dTmp, paramsTmp);
+    };
+    double bestLogA = FittingSeparable::goldenSectionSearch(cost, logAMin, logAMax);
+
+    QVector<double> pBest, dBest;
+    project(bestLogA, pBest, dBest, params);
+    params[m_timeParam.name] = v0 * pow(exp(bestLogA), 1.0 / m_timeParam.exponent);
+    return std::make_tuple(m_obsTime, pBest, dBest);
+}
+
+double FittingEngine::calculateValidationError(ModelManager::ModelType modelType, const QMap<QString, double>& params) {
+    // 1. 在覆盖完整观测时间范围的对数网格上计算理论曲线（每对数周期 20 点）
+    double tMin = std::numeric_limits<double>::max(), tMax = 0.0;
+    for(double t : m_valTime) { if(t > 0) { tMin = qMin(tMin, t); tMax = qMax(tMax, t); } }
+    if(tMax <= 0) return 0.0;
+    double lMin = log10(tMin), lMax = log10(tMax);
+    int nGrid = qMax(2, int((lMax - lMin) * 20) + 2);
+    QVector<double> grid = ModelManager::generateLogTimeSteps(nGrid, lMin, qMax(lMax, lMin + 1e-6));
+    ModelCurveData curve = evaluateCurve(modelType, params, grid);
+    const QVector<double>& gt = std::get<0>(curve);
+    if(gt.size() < 2 || std::get<1>(curve).size() != gt.size() || std::get<2>(curve).size() != gt.size()) return 0.0;
+
+    // 2. 双对数线性插值到每个观测时间点
+    QVector<double> pCal = FittingSeparable::interpolateLogLog(gt, std::get<1>(curve), m_valTime);
+    QVector<double> dCal = FittingSeparable::interpolateLogLog(gt, std::get<2>(curve), m_valTime);
+
+    QVector<double> residuals;
+    m_valKernel.evaluate(pCal, dCal, residuals);
+    storeFinalResiduals(m_valKernel, residuals, std::make_tuple(m_valTime, pCal, dCal));
+    return m_finalResiduals.isEmpty() ? 0.0 : calculateSumSquaredError(m_finalResiduals) / m_finalResiduals.size();
+}
+
+QVector<QVector<double>> FittingEngine::computeJacobian(const QMap<QString, double>& params, const QVector<double>& baseResiduals, const QVector<int>& fitIndices, ModelManager::ModelType modelType, const QList<FitParameter>& currentFitParams,
+                                                        const QVector<FittingParameterTransform>& transforms) {
+    int nRes = baseResiduals.size(); int nParams = fitIndices.size();
+    QVector<QVector<double>> J(nRes, QVector<double>(nParams));
+    QVector<double> rPlusBuf, rMinusBuf;   // 差分残差缓冲区，各参数复用
+    for(int j = 0; j < nParams; ++j) {
+        int idx = fitIndices[j]; QString pName = currentFitParams[idx].name;
+        const FittingParameterTransform& tf = transforms[j];
+        double u = tf.toInternal(params.value(pName));
+        double h = tf.finiteDifferenceStep();
+
+        // 在内部坐标中差分；靠近边界时改用单侧差分，保证差分点可行
+        bool canPlus = u + h <= tf.internalUpper();
+        bool canMinus = u - h >= tf.internalLower();
+        QMap<QString, double> pPlus = params; QMap<QString, double> pMinus = params;
+        if(canPlus) pPlus[pName] = tf.toExternal(u + h);
+        if(canMinus) pMinus[pName] = tf.toExternal(u - h);
+        if(pName == "L" || pName == "Lf") { updateDependentParams(pPlus); updateDependentParams(pMinus); }
+
+        if(canPlus) calculateResiduals(pPlus, modelType, rPlusBuf);
+        if(canMinus) calculateResiduals(pMinus, modelType, rMinusBuf);
+        const QVector<double>& rPlus = canPlus ? rPlusBuf : baseResiduals;
+        const QVector<double>& rMinus = canMinus ? rMinusBuf : baseResiduals;
+        double span = (canPlus ? h : 0.0) + (canMinus ? h : 0.0);
+        if(span > 0 && rPlus.size() == nRes && rMinus.size() == nRes) {
+            for(int i=0; i<nRes; ++i) J[i][j] = (rPlus[i] - rMinus[i]) / span;
+        }
+    }
+    return J;
+}
+
+QVector<double> FittingEngine::solveLinearSystem(const QVector<QVector<double>>& A, const QVector<double>& b) {
+    int n = b.size(); if (n == 0) return QVector<double>();
+    Eigen::MatrixXd matA(n, n); Eigen::VectorXd vecB(n);
+    for (int i = 0; i < n; ++i) { vecB(i) = b[i]; for (int j = 0; j < n; ++j) matA(i, j) = A[i][j]; }
+    Eigen::VectorXd x = matA.ldlt().solve(vecB);
+    QVector<double> res(n); for (int i = 0; i < n; ++i) res[i] = x(i);
+    return res;
+}
+
+double FittingEngine::calculateSumSquaredError(const QVector<double>& residuals) {
+    double sse = 0.0; for(double v : residuals) sse += v*v; return sse;
+}
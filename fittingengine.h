@@ -0,0 +1,286 @@
+/*
+ * fittingengine.h
+ * 文件作用：试井自动拟合计算引擎头文件
+ * 功能描述：
+ * 1. 将拟合计算逻辑从 FittingWidget 界面类中剥离，便于复用
+ * 2. 提供 Levenberg-Marquardt 局部优化算法
+ * 3. 提供差分进化 (Differential Evolution) 全局优化算法：
+ *    种群分批并行评估，遵守参数上下限及对数参数化，最优个体交给 LM 精修
+ * 4. 支持“抽稀数据拟合 + 完整数据验证”：迭代使用抽稀后的观测数据，
+ *    拟合结束后在完整观测序列上计算最终误差
+ * 5. 多精度渐进 (continuation) 拟合：先在粗时间网格、低 Stehfest 阶数下迭代，
+ *    误差趋于平稳后逐级提升网格密度与反演阶数，最后在完整精度下收敛
+ * 6. 通过 CancellationToken 将停止请求传入模型计算内部，停止后立即返回当前最优参数
+ * 7. 迭代结果以只读共享快照 (FittingIterationSnapshot) 发布，复用残差计算时已得到的理论曲线
+ * 8. 可分离最小二乘 (Variable Projection)：压力尺度参数 (h/q/B) 解析求解，
+ *    时间尺度参数 (phi/Ct) 在缓存曲线上一维搜索，二者均不再作为 LM/DE 的非线性变量
+ * 9. 有界 LM：按参数上下限进行对数/logit 变换，投影模式下采用有效集 + 投影步长
+ * 10. 检查点：按时间间隔、阶段结束及停止时发布 LM 状态（参数、阻尼因子、阶段、迭代次数、最优误差），
+ *     可从检查点继续拟合
+ * 11. 残差计算使用每阶段预处理一次的观测缓存 (FittingResidualKernel)，写入复用的缓冲区
+ */
+
+#ifndef FITTINGENGINE_H
+#define FITTINGENGINE_H
+
+#include <QObject>
+#include <QMap>
+#include <QList>
+#include <QVector>
+#include <QSharedPointer>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include "modelmanager.h"
+#include "fittingparameterchart.h"
+#include "cancellationtoken.h"
+#include "fittingparametertransform.h"
+#include "fittingresidualkernel.h"
+
+// 拟合算法类型
+enum class FittingAlgorithm {
+    LevenbergMarquardt = 0,     // 局部优化 (LM)
+    DifferentialEvolution = 1   // 全局优化 (差分进化) + LM 精修
+};
+
+// 迭代快照：一次迭代的误差、参数与理论曲线，发布后只读，跨线程共享无需拷贝
+struct FittingIterationSnapshot {
+    double error;
+    QMap<QString, double> params;
+    QVector<double> t;
+    QVector<double> p;
+    QVector<double> d;
+};
+using FittingSnapshotPtr = QSharedPointer<const FittingIterationSnapshot>;
+Q_DECLARE_METATYPE(FittingSnapshotPtr)
+
+// 拟合检查点：恢复 LM 迭代所需的全部状态
+struct FittingCheckpoint {
+    int modelType;                  // 模型类型 (ModelManager::ModelType)
+    QMap<QString, double> params;   // 当前最优参数（含被消去参数的当前值）
+    double lambda;                  // LM 阻尼因子
+    int stage;                      // 渐进拟合阶段序号
+    int iteration;                  // 阶段内已完成的迭代次数
+    int totalIterations;            // 累计迭代次数
+    double bestCost;                // 当前最优误差 (MSE)
+
+    FittingCheckpoint() : modelType(-1), lambda(0.01), stage(0), iteration(0), totalIterations(0), bestCost(0.0) {}
+    bool isValid() const { return modelType >= 0 && !params.isEmpty(); }
+
+    QJsonObject toJson() const;
+    static FittingCheckpoint fromJson(const QJsonObject& obj);
+};
+Q_DECLARE_METATYPE(FittingCheckpoint)
+
+// 被可分离最小二乘消去的参数
+struct SeparableParameter {
+    QString name;       // 参数名（为空表示未启用）
+    double min;
+    double max;
+    double exponent;    // 理论曲线平移量与参数的关系：压力倍数 = (新值/原值)^exponent
+
+    SeparableParameter() : min(0.0), max(0.0), exponent(1.0) {}
+    bool isActive() const { return !name.isEmpty(); }
+};
+
+// 多精度渐进拟合的单个阶段
+struct FittingFidelityStage {
+    int pointsPerDecade;        // 本阶段拟合数据每对数周期点数 (<=0 表示使用全部拟合数据)
+    int stehfestN;              // 本阶段 Stehfest 反演阶数 (偶数)
+    int maxIterations;          // 本阶段 LM 最大迭代次数
+    double plateauTolerance;    // 平稳判据：单步相对误差下降量小于该值视为趋于平稳
+
+    FittingFidelityStage(int ppd = 0, int n = 8, int iter = 50, double tol = 1e-4) :
+        pointsPerDecade(ppd), stehfestN(n), maxIterations(iter), plateauTolerance(tol) {}
+};
+
+// 差分进化算法配置
+struct DifferentialEvolutionConfig {
+    int populationSize;     // 种群规模 (<=0 时按 10 * 拟合参数个数 自动确定)
+    int maxGenerations;     // 最大进化代数
+    double mutationFactor;  // 变异缩放因子 F
+    double crossoverRate;   // 交叉概率 CR
+    int batchSize;          // 每批并行评估的个体数 (<=0 时按 CPU 核数自动确定)
+    double tolerance;       // 收敛阈值：种群目标函数的相对离散度
+    quint32 seed;           // 随机数种子 (固定种子保证拟合结果可复现)
+
+    DifferentialEvolutionConfig() :
+        populationSize(0),
+        maxGenerations(60),
+        mutationFactor(0.7),
+        crossoverRate(0.9),
+        batchSize(0),
+        tolerance(1e-4),
+        seed(20240601u) {}
+};
+
+class FittingEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FittingEngine(ModelManager* modelManager, QObject* parent = nullptr);
+
+    // 设置模型管理器
+    void setModelManager(ModelManager* m);
+
+    // 设置观测数据（时间、压力、导数），应在启动拟合前调用
+    void setObservedData(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d);
+    // 设置完整观测数据，用于拟合结束后的最终误差验证（为空时使用拟合数据的误差）
+    void setValidationData(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d);
+    // 获取最近一次拟合在完整观测数据上的验证误差 (MSE)
+    double getValidationError() const;
+    // 获取最近一次拟合最终参数下的残差向量（有完整观测数据时为验证残差，前半为压力、后半为导数）
+    QVector<double> getFinalResiduals() const;
+    // 最终残差的逐点状态 (FittingResidualKernel::PointState) 与其中压力残差的个数
+    QVector<char> getFinalResidualStates() const;
+    int getFinalPressureCount() const;
+
+    // 算法选择与配置
+    void setAlgorithm(FittingAlgorithm algorithm);
+    FittingAlgorithm getAlgorithm() const;
+    void setDifferentialEvolutionConfig(const DifferentialEvolutionConfig& config);
+    DifferentialEvolutionConfig getDifferentialEvolutionConfig() const;
+
+    // 多精度渐进拟合阶段配置（按顺序执行，最后一个阶段应为完整精度）
+    void setContinuationSchedule(const QVector<FittingFidelityStage>& stages);
+    QVector<FittingFidelityStage> getContinuationSchedule() const;
+    // 可分离最小二乘选项：eliminateScale 消去压力尺度参数 (h/q/B 中第一个参与拟合者)，
+    // eliminateTimeShift 消去时间尺度参数 (phi/Ct 中第一个参与拟合者，变产量历史生效时不消去)
+    void setSeparableOptions(bool eliminateScale, bool eliminateTimeShift);
+
+    // LM 边界处理方式（投影约束 / logit 变换）
+    void setBoundHandling(BoundHandling mode);
+
+    // 检查点间隔（秒，<=0 表示只在阶段结束和停止时发布）
+    void setCheckpointInterval(int seconds);
+    // 下一次 run() 从该检查点继续（跳过全局搜索与已完成的阶段，仅生效一次）
+    void setResumeCheckpoint(const FittingCheckpoint& checkpoint);
+    // 取出最近一次停止时发布的检查点并清空（run() 返回后调用，供调用方同步保存）
+    FittingCheckpoint takeStopCheckpoint();
+
+    // 默认渐进方案：粗网格/N=4 -> 中等网格/N=6 -> 完整数据/N=8
+    static QVector<FittingFidelityStage> defaultContinuationSchedule();
+    // 单一精度方案：全部迭代均在完整数据、N=8 下进行
+    static QVector<FittingFidelityStage> singleStageSchedule();
+
+    // 执行拟合（阻塞调用，应在工作线程中运行），返回最终参数
+    QMap<QString, double> run(ModelManager::ModelType modelType, const QList<FitParameter>& params, double weight);
+
+    // 请求停止拟合（线程安全，正在进行的模型计算会在当前时间点结束后立即返回）
+    void requestStop();
+    bool isStopRequested() const;
+    // 复位停止标志：由调度器在提交任务时调用，run() 内不复位，以免丢失任务启动前到达的停止请求
+    void resetStop();
+
+    // 静态工具：根据 L 与 Lf 更新无因次缝长 LfD
+    static void updateDependentParams(QMap<QString, double>& params);
+
+signals:
+    // 迭代更新信号（在工作线程中发射，快照只读共享）
+    void iterationUpdated(FittingSnapshotPtr snapshot);
+    // 进度信号 (0-100)
+    void progressChanged(int progress);
+    // 检查点信号（在工作线程中发射，由界面线程负责持久化）
+    void checkpointReached(const FittingCheckpoint& checkpoint);
+
+private:
+    // 差分进化全局搜索，返回种群最优个体
+    QMap<QString, double> runDifferentialEvolution(ModelManager::ModelType modelType, const QList<FitParameter>& params,
+                                                   const QVector<int>& fitIndices, const QMap<QString, double>& startParams,
+                                                   int progressBase, int progressSpan);
+
+    // Levenberg-Marquardt 局部优化，返回优化后的参数
+    QMap<QString, double> runLevenbergMarquardt(ModelManager::ModelType modelType, const QList<FitParameter>& params,
+                                                const QVector<int>& fitIndices, const QMap<QString, double>& startParams,
+                                                int progressBase, int progressSpan, double& finalMSE,
+                                                int maxIter, double plateauTolerance, bool isFinalStage,
+                                                int stageIndex, double initialLambda = 0.01, int startIter = 0);
+    // 记录最终残差及其逐点状态
+    void storeFinalResiduals(const FittingResidualKernel& kernel, const QVector<double>& residuals, const ModelCurveData& curve);
+    // 发布检查点并重新计时
+    void emitCheckpoint(int stage, int iteration, double lambda, double cost, const QMap<QString, double>& params);
+
+    // 切换到指定精度阶段（重新抽取拟合数据并设置反演阶数）
+    void activateStage(const FittingFidelityStage& stage);
+    // 按当前阶段的反演阶数计算理论曲线
+    ModelCurveData evaluateCurve(ModelManager::ModelType modelType, const QMap<QString, double>& params,
+                                 const QVector<double>& t = QVector<double>());
+
+    // 在完整观测数据上计算验证误差（理论曲线在对数网格上计算后对数插值）
+    double calculateValidationError(ModelManager::ModelType modelType, const QMap<QString, double>& params);
+
+    // 计算残差并写入 out（调用方复用缓冲区；计算取消时 out 为空）
+    // curveOut 非空时同时返回计算得到的理论曲线，供发布快照复用；
+    // paramsOut 非空时返回消去参数取最优值后的完整参数
+    void calculateResiduals(const QMap<QString, double>& params, ModelManager::ModelType modelType,
+                            QVector<double>& out, ModelCurveData* curveOut = nullptr, QMap<QString, double>* paramsOut = nullptr);
+    // 压力尺度投影：求最优竖直平移并作用于理论曲线，同时更新尺度参数
+    void applyScaleProjection(QVector<double>& pCal, QVector<double>& dCal, QMap<QString, double>& params) const;
+    // 时间尺度投影：在缓存的致密曲线上搜索最优水平平移，返回观测时间点上的理论曲线
+    ModelCurveData evaluateWithTimeShift(ModelManager::ModelType modelType, QMap<QString, double>& params);
+    // 计算雅可比矩阵
+    QVector<QVector<double>> computeJacobian(const QMap<QString, double>& params, const QVector<double>& residuals, const QVector<int>& fitIndices, ModelManager::ModelType modelType, const QList<FitParameter>& currentFitParams,
+                                             const QVector<FittingParameterTransform>& transforms);
+    // 求解线性方程组 (Eigen)
+    QVector<double> solveLinearSystem(const QVector<QVector<double>>& A, const QVector<double>& b);
+    // 计算平方误差和
+    double calculateSumSquaredError(const QVector<double>& residuals);
+
+    // 发送迭代更新（计算当前参数下的理论曲线）
+    void emitIteration(double error, ModelManager::ModelType modelType, const QMap<QString, double>& params);
+    // 发布迭代快照（直接使用已有曲线）
+    void publishSnapshot(double error, const QMap<QString, double>& params, const ModelCurveData& curve);
+
+private:
+    ModelManager* m_modelManager;
+
+    // 拟合数据（setObservedData 传入）
+    QVector<double> m_fitTime;
+    QVector<double> m_fitPressure;
+    QVector<double> m_fitDerivative;
+
+    // 当前精度阶段实际参与迭代的观测数据
+    QVector<double> m_obsTime;
+    QVector<double> m_obsPressure;
+    QVector<double> m_obsDerivative;
+    FittingResidualKernel m_obsKernel;  // 当前阶段观测数据的残差缓存
+
+    // 完整观测数据（验证用）
+    QVector<double> m_valTime;
+    QVector<double> m_valPressure;
+    QVector<double> m_valDerivative;
+    double m_validationError;
+    FittingResidualKernel m_valKernel;
+    double m_weight;        // 本次拟合的压力权重
+    QVector<double> m_finalResiduals;
+    QVector<char> m_finalStates;
+    int m_finalPressureCount;
+
+    FittingAlgorithm m_algorithm;
+    DifferentialEvolutionConfig m_deConfig;
+    QVector<FittingFidelityStage> m_schedule;
+    int m_stehfestN;        // 当前阶段的 Stehfest 反演阶数
+
+    // 可分离最小二乘
+    bool m_eliminateScale;
+    bool m_eliminateTimeShift;
+    SeparableParameter m_scaleParam;
+    SeparableParameter m_timeParam;
+
+    BoundHandling m_boundHandling;
+
+    // 取消令牌：传入模型计算，按时间点粒度响应停止请求
+    CancellationToken m_cancelToken;
+    // 最近一次发送的误差（对应当前最优参数），停止时直接返回
+    double m_lastError;
+
+    // 检查点
+    int m_checkpointInterval;       // 秒
+    QElapsedTimer m_checkpointTimer;
+    FittingCheckpoint m_resume;
+    FittingCheckpoint m_stopCheckpoint; // 停止时的检查点副本，不依赖排队信号送达
+    int m_runModelType;
+    int m_totalIterations;
+};
+
+#endif // FITTINGENGINE_H
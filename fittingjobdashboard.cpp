@@ -0,0 +1,141 @@
+/*
+ * fittingjobdashboard.cpp
+ * 文件作用：拟合任务监控面板的具体实现
+ * 功能描述：
+ * 1. 以表格形式显示 FittingJobScheduler 中的全部任务
+ * 2. 任务状态变化时刷新，同时每秒刷新一次已用时间与剩余时间
+ */
+
+#include "fittingjobdashboard.h"
+#include "ui_fittingjobdashboard.h"
+#include "fittingjobscheduler.h"
+#include <QHeaderView>
+#include <QTableWidgetItem>
+#include <algorithm>
+
+FittingJobDashboard::FittingJobDashboard(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::FittingJobDashboard)
+{
+    ui->setupUi(this);
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    QStringList headers;
+    headers << "ID" << "分析名称" << "状态" << "优先级" << "进度" << "迭代次数" << "当前误差" << "已用时间" << "预计剩余";
+    ui->tableJobs->setColumnCount(headers.size());
+    ui->tableJobs->setHorizontalHeaderLabels(headers);
+    ui->tableJobs->verticalHeader()->setVisible(false);
+    ui->tableJobs->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    FittingJobScheduler* scheduler = FittingJobScheduler::instance();
+    ui->spinConcurrency->setValue(scheduler->maxConcurrentJobs());
+
+    connect(ui->spinConcurrency, QOverload<int>::of(&QSpinBox::valueChanged), this, &FittingJobDashboard::onConcurrencyChanged);
+    connect(ui->btnCancelJob, &QPushButton::clicked, this, &FittingJobDashboard::onCancelJob);
+    connect(ui->btnRaisePriority, &QPushButton::clicked, this, &FittingJobDashboard::onRaisePriority);
+    connect(ui->btnLowerPriority, &QPushButton::clicked, this, &FittingJobDashboard::onLowerPriority);
+    connect(ui->btnClearFinished, &QPushButton::clicked, this, &FittingJobDashboard::onClearFinished);
+    connect(ui->btnClose, &QPushButton::clicked, this, &QDialog::close);
+
+    connect(scheduler, &FittingJobScheduler::jobAdded, this, &FittingJobDashboard::refreshTable);
+    connect(scheduler, &FittingJobScheduler::jobFinished, this, &FittingJobDashboard::refreshTable);
+
+    // 进度信号频繁，统一由定时器刷新
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(500);
+    connect(m_refreshTimer, &QTimer::timeout, this, &FittingJobDashboard::refreshTable);
+    m_refreshTimer->start();
+
+    refreshTable();
+}
+
+FittingJobDashboard::~FittingJobDashboard()
+{
+    delete ui;
+}
+
+QString FittingJobDashboard::formatSeconds(qint64 secs)
+{
+    if (secs < 0) return "--";
+    return QString("%1:%2").arg(secs / 60, 2, 10, QChar('0')).arg(secs % 60, 2, 10, QChar('0'));
+}
+
+int FittingJobDashboard::selectedJobId() const
+{
+    int row = ui->tableJobs->currentRow();
+    if (row < 0 || !ui->tableJobs->item(row, 0)) return -1;
+    return ui->tableJobs->item(row, 0)->text().toInt();
+}
+
+void FittingJobDashboard::refreshTable()
+{
+    int selectedId = selectedJobId();
+
+    QList<FittingJobInfo> jobs = FittingJobScheduler::instance()->jobs();
+    // 按提交顺序显示
+    std::sort(jobs.begin(), jobs.end(), [](const FittingJobInfo& a, const FittingJobInfo& b) { return a.id < b.id; });
+
+    ui->tableJobs->setRowCount(jobs.size());
+    int selectRow = -1;
+    for (int i = 0; i < jobs.size(); ++i) {
+        const FittingJobInfo& job = jobs[i];
+        QStringList cells;
+        cells << QString::number(job.id)
+              << job.name
+              << job.stateText()
+              << QString::number(job.priority)
+              << QString("%1%").arg(job.progress)
+              << QString::number(job.iterations)
+              << (job.iterations > 0 ? QString::number(job.cost, 'e', 3) : QString("--"))
+              << formatSeconds(job.startTime.isValid() ? job.elapsedSeconds() : -1)
+              << formatSeconds(job.etaSeconds());
+        for (int c = 0; c < cells.size(); ++c) {
+            QTableWidgetItem* item = ui->tableJobs->item(i, c);
+            if (!item) {
+                item = new QTableWidgetItem();
+                item->setTextAlignment(Qt::AlignCenter);
+                ui->tableJobs->setItem(i, c, item);
+            }
+            item->setText(cells[c]);
+        }
+        if (job.id == selectedId) selectRow = i;
+    }
+    if (selectRow >= 0) ui->tableJobs->selectRow(selectRow);
+}
+
+void FittingJobDashboard::onCancelJob()
+{
+    int id = selectedJobId();
+    if (id < 0) return;
+    FittingJobScheduler::instance()->cancel(id);
+    refreshTable();
+}
+
+void FittingJobDashboard::onRaisePriority()
+{
+    int id = selectedJobId();
+    if (id < 0) return;
+    FittingJobScheduler* scheduler = FittingJobScheduler::instance();
+    scheduler->setPriority(id, scheduler->job(id).priority + 1);
+    refreshTable();
+}
+
+void FittingJobDashboard::onLowerPriority()
+{
+    int id = selectedJobId();
+    if (id < 0) return;
+    FittingJobScheduler* scheduler = FittingJobScheduler::instance();
+    scheduler->setPriority(id, scheduler->job(id).priority - 1);
+    refreshTable();
+}
+
+void FittingJobDashboard::onClearFinished()
+{
+    FittingJobScheduler::instance()->clearFinished();
+    refreshTable();
+}
+
+void FittingJobDashboard::onConcurrencyChanged(int value)
+{
+    FittingJobScheduler::instance()->setMaxConcurrentJobs(value);
+}
@@ -0,0 +1,45 @@
+#ifndef FITTINGJOBDASHBOARD_H
+#define FITTINGJOBDASHBOARD_H
+
+#include <QDialog>
+#include <QTimer>
+
+namespace Ui {
+class FittingJobDashboard;
+}
+
+// ===========================================================================
+// 类名：FittingJobDashboard
+// 作用：拟合任务监控面板（非模态）
+// 功能：
+// 1. 列出调度器中所有拟合任务的状态、优先级、进度、迭代次数、当前误差与剩余时间
+// 2. 支持取消任务、调整排队任务的优先级、设置最大并行任务数
+// ===========================================================================
+
+class FittingJobDashboard : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit FittingJobDashboard(QWidget *parent = nullptr);
+    ~FittingJobDashboard();
+
+private slots:
+    void refreshTable();
+    void onCancelJob();
+    void onRaisePriority();
+    void onLowerPriority();
+    void onClearFinished();
+    void onConcurrencyChanged(int value);
+
+private:
+    Ui::FittingJobDashboard *ui;
+    QTimer* m_refreshTimer;
+
+    // 当前选中行对应的任务 ID（无选中返回 -1）
+    int selectedJobId() const;
+    // 秒数格式化为 mm:ss
+    static QString formatSeconds(qint64 secs);
+};
+
+#endif // FITTINGJOBDASHBOARD_H
@@ -0,0 +1,264 @@
+/*
+ * fittingjobscheduler.cpp
+ * 文件作用：拟合任务调度器实现文件
+ * 功能描述：
+ * 1. 使用独立的 QThreadPool 执行拟合任务，默认并发数为 CPU 核数的一半
+ *    （任务内的并行计算使用全局线程池，运行中的任务各占其一个名额，两者合计不超过核数）
+ * 2. 转发拟合引擎的进度与迭代信号，维护任务看板所需的统计信息
+ */
+
+#include "fittingjobscheduler.h"
+
+#include <QRunnable>
+#include <QThread>
+#include <QDebug>
+
+// ===========================================================================
+// FittingJobInfo
+// ===========================================================================
+qint64 FittingJobInfo::elapsedSeconds() const
+{
+    if (!startTime.isValid()) return 0;
+    QDateTime end = finishTime.isValid() ? finishTime : QDateTime::currentDateTime();
+    return startTime.secsTo(end);
+}
+
+qint64 FittingJobInfo::etaSeconds() const
+{
+    if (state != Running || progress <= 0) return -1;
+    return elapsedSeconds() * (100 - progress) / progress;
+}
+
+QString FittingJobInfo::stateText() const
+{
+    switch (state) {
+    case Queued: return "排队中";
+    case Running: return "运行中";
+    case Finished: return "已完成";
+    case Cancelled: return "已取消";
+    }
+    return QString();
+}
+
+// ===========================================================================
+// FittingJobRunnable：在线程池中执行一次拟合
+// ===========================================================================
+class FittingJobRunnable : public QRunnable
+{
+public:
+    FittingJobRunnable(FittingJobScheduler* scheduler, int jobId, FittingEngine* engine,
+                       ModelManager::ModelType modelType, const QList<FitParameter>& params, double weight)
+        : m_scheduler(scheduler), m_jobId(jobId), m_engine(engine),
+          m_modelType(modelType), m_params(params), m_weight(weight)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        // 先移出排队表，此后 cancel/setPriority 不再访问本执行体（结束后自动释放）
+        m_scheduler->markStarted(m_jobId);
+        QMetaObject::invokeMethod(m_scheduler, "onJobStarted", Qt::QueuedConnection, Q_ARG(int, m_jobId));
+        // 任务线程占用全局线程池的一个名额，使种群评估、叠加求和等内层并行计算与任务线程合计不超过核数
+        QThreadPool::globalInstance()->reserveThread();
+        m_engine->run(m_modelType, m_params, m_weight);
+        QThreadPool::globalInstance()->releaseThread();
+        QMetaObject::invokeMethod(m_scheduler, "onJobDone", Qt::QueuedConnection, Q_ARG(int, m_jobId));
+        m_scheduler->markInactive(m_jobId);
+    }
+
+private:
+    FittingJobScheduler* m_scheduler;
+    int m_jobId;
+    FittingEngine* m_engine;
+    ModelManager::ModelType m_modelType;
+    QList<FitParameter> m_params;
+    double m_weight;
+};
+
+// ===========================================================================
+// FittingJobScheduler
+// ===========================================================================
+FittingJobScheduler* FittingJobScheduler::instance()
+{
+    static FittingJobScheduler* s_instance = new FittingJobScheduler();
+    return s_instance;
+}
+
+FittingJobScheduler::FittingJobScheduler(QObject* parent)
+    : QObject(parent), m_nextId(1)
+{
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+}
+
+int FittingJobScheduler::submit(const QString& name, FittingEngine* engine, ModelManager::ModelType modelType,
+                                const QList<FitParameter>& params, double weight, int priority)
+{
+    int id = m_nextId++;
+
+    FittingJobInfo info;
+    info.id = id;
+    info.name = name;
+    info.priority = priority;
+    info.state = FittingJobInfo::Queued;
+    info.submitTime = QDateTime::currentDateTime();
+    m_jobs.insert(id, info);
+    m_engines.insert(id, engine);
+
+    // 引擎信号在工作线程发射，以调度器为上下文对象，自动排队到界面线程
+    QList<QMetaObject::Connection> conns;
+    conns << connect(engine, &FittingEngine::progressChanged, this, [this, id](int progress) {
+        if (!m_jobs.contains(id)) return;
+        m_jobs[id].progress = progress;
+        emit jobUpdated(id);
+    });
+    conns << connect(engine, &FittingEngine::iterationUpdated, this, [this, id](FittingSnapshotPtr snapshot) {
+        if (!m_jobs.contains(id) || !snapshot) return;
+        m_jobs[id].iterations++;
+        m_jobs[id].cost = snapshot->error;
+        emit jobUpdated(id);
+    });
+    m_connections.insert(id, conns);
+
+    // 停止标志在入队前复位：任务启动前到达的取消请求不会被 run() 清除
+    engine->resetStop();
+
+    FittingJobRunnable* runnable = new FittingJobRunnable(this, id, engine, modelType, params, weight);
+    {
+        QMutexLocker locker(&m_activeMutex);
+        m_active.insert(id);
+        m_queued.insert(id, runnable);
+        m_pool.start(runnable, priority);
+    }
+
+    emit jobAdded(id);
+    return id;
+}
+
+void FittingJobScheduler::cancel(int jobId)
+{
+    if (!m_jobs.contains(jobId)) return;
+    FittingJobInfo::State state = m_jobs[jobId].state;
+    if (state == FittingJobInfo::Finished || state == FittingJobInfo::Cancelled) return;
+
+    // 尚未开始执行：直接从队列中取出（持锁期间执行体不会开始运行或被释放）
+    bool taken = false;
+    {
+        QMutexLocker locker(&m_activeMutex);
+        QRunnable* runnable = m_queued.value(jobId, nullptr);
+        if (runnable && m_pool.tryTake(runnable)) {
+            delete runnable;
+            m_queued.remove(jobId);
+            taken = true;
+        }
+    }
+    if (taken) {
+        markInactive(jobId);
+        finishJob(jobId, FittingJobInfo::Cancelled);
+        return;
+    }
+
+    // 已在运行：请求引擎停止，结束时由 onJobDone 收尾
+    if (FittingEngine* engine = m_engines.value(jobId, nullptr)) engine->requestStop();
+    m_jobs[jobId].state = FittingJobInfo::Cancelled;
+    emit jobUpdated(jobId);
+}
+
+void FittingJobScheduler::cancelAndWait(int jobId)
+{
+    cancel(jobId);
+    QMutexLocker locker(&m_activeMutex);
+    while (m_active.contains(jobId)) m_activeCond.wait(&m_activeMutex);
+}
+
+void FittingJobScheduler::setPriority(int jobId, int priority)
+{
+    if (!m_jobs.contains(jobId)) return;
+    m_jobs[jobId].priority = priority;
+
+    // 排队中的任务重新入队以应用新优先级
+    {
+        QMutexLocker locker(&m_activeMutex);
+        QRunnable* runnable = m_queued.value(jobId, nullptr);
+        if (runnable && m_pool.tryTake(runnable)) m_pool.start(runnable, priority);
+    }
+    emit jobUpdated(jobId);
+}
+
+void FittingJobScheduler::setMaxConcurrentJobs(int n)
+{
+    m_pool.setMaxThreadCount(qMax(1, n));
+}
+
+int FittingJobScheduler::maxConcurrentJobs() const
+{
+    return m_pool.maxThreadCount();
+}
+
+QList<FittingJobInfo> FittingJobScheduler::jobs() const
+{
+    return m_jobs.values();
+}
+
+FittingJobInfo FittingJobScheduler::job(int jobId) const
+{
+    return m_jobs.value(jobId);
+}
+
+bool FittingJobScheduler::isActive(int jobId) const
+{
+    QMutexLocker locker(&m_activeMutex);
+    return m_active.contains(jobId);
+}
+
+void FittingJobScheduler::clearFinished()
+{
+    QList<int> ids = m_jobs.keys();
+    for (int id : ids) {
+        FittingJobInfo::State s = m_jobs[id].state;
+        if ((s == FittingJobInfo::Finished || s == FittingJobInfo::Cancelled) && !isActive(id))
+            m_jobs.remove(id);
+    }
+}
+
+void FittingJobScheduler::onJobStarted(int jobId)
+{
+    if (!m_jobs.contains(jobId)) return;
+    if (m_jobs[jobId].state == FittingJobInfo::Queued) m_jobs[jobId].state = FittingJobInfo::Running;
+    m_jobs[jobId].startTime = QDateTime::currentDateTime();
+    emit jobUpdated(jobId);
+}
+
+void FittingJobScheduler::onJobDone(int jobId)
+{
+    bool cancelled = m_jobs.contains(jobId) && m_jobs[jobId].state == FittingJobInfo::Cancelled;
+    finishJob(jobId, cancelled ? FittingJobInfo::Cancelled : FittingJobInfo::Finished);
+}
+
+void FittingJobScheduler::finishJob(int jobId, FittingJobInfo::State state)
+{
+    m_engines.remove(jobId);
+    for (const QMetaObject::Connection& c : m_connections.take(jobId)) disconnect(c);
+
+    if (m_jobs.contains(jobId)) {
+        FittingJobInfo& info = m_jobs[jobId];
+        info.state = state;
+        info.finishTime = QDateTime::currentDateTime();
+        if (state == FittingJobInfo::Finished) info.progress = 100;
+    }
+    emit jobUpdated(jobId);
+    emit jobFinished(jobId);
+}
+
+void FittingJobScheduler::markStarted(int jobId)
+{
+    QMutexLocker locker(&m_activeMutex);
+    m_queued.remove(jobId);
+}
+
+void FittingJobScheduler::markInactive(int jobId)
+{
+    QMutexLocker locker(&m_activeMutex);
+    m_active.remove(jobId);
+    m_activeCond.wakeAll();
+}
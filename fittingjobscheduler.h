@@ -0,0 +1,118 @@
+/*
+ * fittingjobscheduler.h
+ * 文件作用：拟合任务调度器头文件
+ * 功能描述：
+ * 1. 统一管理所有分析页发起的拟合任务，共享一个有界线程池，避免多页同时拟合时 CPU 超额订阅
+ * 2. 支持任务优先级（排队中的任务可调整）、进度、迭代次数、当前误差与剩余时间估计
+ * 3. 支持取消排队中或运行中的任务，以及等待任务结束（页面销毁前调用）
+ */
+
+#ifndef FITTINGJOBSCHEDULER_H
+#define FITTINGJOBSCHEDULER_H
+
+#include <QObject>
+#include <QMap>
+#include <QSet>
+#include <QList>
+#include <QDateTime>
+#include <QThreadPool>
+#include <QMutex>
+#include <QWaitCondition>
+#include "fittingengine.h"
+
+class QRunnable;
+
+// 拟合任务信息（仅在界面线程中读写）
+struct FittingJobInfo {
+    enum State {
+        Queued,     // 排队中
+        Running,    // 运行中
+        Finished,   // 已完成
+        Cancelled   // 已取消
+    };
+
+    int id;
+    QString name;           // 分析名称
+    int priority;           // 优先级（数值越大越先执行）
+    State state;
+    int progress;           // 进度 (0-100)
+    int iterations;         // 已发布的迭代次数
+    double cost;            // 当前误差 (MSE)
+    QDateTime submitTime;
+    QDateTime startTime;
+    QDateTime finishTime;
+
+    FittingJobInfo() : id(-1), priority(0), state(Queued), progress(0), iterations(0), cost(0.0) {}
+
+    // 已运行时间（秒）
+    qint64 elapsedSeconds() const;
+    // 按当前进度线性估计的剩余时间（秒），无法估计时返回 -1
+    qint64 etaSeconds() const;
+    // 状态文字
+    QString stateText() const;
+};
+
+class FittingJobScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 全局唯一调度器
+    static FittingJobScheduler* instance();
+
+    // 提交拟合任务，返回任务 ID。engine 在任务结束前不得销毁
+    int submit(const QString& name, FittingEngine* engine, ModelManager::ModelType modelType,
+               const QList<FitParameter>& params, double weight, int priority = 0);
+
+    // 取消任务：排队中的任务直接移出队列，运行中的任务请求停止
+    void cancel(int jobId);
+    // 取消任务并阻塞等待其结束
+    void cancelAndWait(int jobId);
+    // 调整排队中任务的优先级
+    void setPriority(int jobId, int priority);
+
+    // 同时运行的最大任务数
+    void setMaxConcurrentJobs(int n);
+    int maxConcurrentJobs() const;
+
+    QList<FittingJobInfo> jobs() const;
+    FittingJobInfo job(int jobId) const;
+    bool isActive(int jobId) const;
+
+    // 清除已结束（完成/取消）的任务记录
+    void clearFinished();
+
+signals:
+    void jobAdded(int jobId);
+    void jobUpdated(int jobId);
+    void jobFinished(int jobId);
+
+private slots:
+    void onJobStarted(int jobId);
+    void onJobDone(int jobId);
+
+private:
+    explicit FittingJobScheduler(QObject* parent = nullptr);
+    friend class FittingJobRunnable;
+
+    // 由工作线程在任务开始/结束时调用
+    void markStarted(int jobId);
+    void markInactive(int jobId);
+    void finishJob(int jobId, FittingJobInfo::State state);
+
+    QThreadPool m_pool;
+    int m_nextId;
+
+    QMap<int, FittingJobInfo> m_jobs;
+    QMap<int, FittingEngine*> m_engines;
+    QMap<int, QList<QMetaObject::Connection>> m_connections;
+
+    // 未结束任务集合（排队或运行中），供 cancelAndWait 跨线程等待；
+    // 排队中任务的执行体（用于取消和调整优先级）同样受该锁保护，执行体开始运行时自行移除
+    mutable QMutex m_activeMutex;
+    QMap<int, QRunnable*> m_queued;
+    QWaitCondition m_activeCond;
+    QSet<int> m_active;
+};
+
+#endif // FITTINGJOBSCHEDULER_H
@@ -0,0 +1,171 @@
+/*
+ * fittinglandscape.cpp
+ * 文件作用：二维目标函数曲面（误差地形图）计算实现文件
+ * 功能描述：
+ * 1. 节点缓存按最细网格分配，后台计算期间不再改变大小，各线程只写入各自的节点
+ * 2. 界面线程只读取已完成层级的节点（completedSize 以 acquire/release 语义发布）
+ */
+
+#include "fittinglandscape.h"
+#include "fittingengine.h"
+
+#include <QtConcurrent>
+#include <cmath>
+#include <limits>
+
+double LandscapeAxis::valueAt(int i, int n) const
+{
+    if (n <= 1) return min;
+    double f = double(i) / (n - 1);
+    if (logScale && min > 0 && max > 0) return std::pow(10.0, std::log10(min) + f * (std::log10(max) - std::log10(min)));
+    return min + f * (max - min);
+}
+
+double LandscapeAxis::plotCoord(double value) const
+{
+    return (logScale && value > 0) ? std::log10(value) : value;
+}
+
+FittingLandscape::FittingLandscape(ModelManager* modelManager, QObject* parent)
+    : QObject(parent)
+    , m_modelManager(modelManager)
+    , m_modelType(ModelManager::Model_1)
+    , m_finalSize(0)
+    , m_completedSize(0)
+{
+    connect(&m_watcher, &QFutureWatcher<void>::finished, this, &FittingLandscape::finished);
+}
+
+FittingLandscape::~FittingLandscape()
+{
+    m_cancelToken.cancel();
+    m_watcher.waitForFinished();
+}
+
+void FittingLandscape::setObservedData(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d)
+{
+    m_obsTime = t; m_obsPressure = p; m_obsDerivative = d;
+}
+
+void FittingLandscape::start(ModelManager::ModelType modelType, const QMap<QString, double>& baseParams,
+                             const LandscapeAxis& xAxis, const LandscapeAxis& yAxis, int finalSize, double weight)
+{
+    if (isRunning() || !m_modelManager || m_obsTime.isEmpty()) return;
+
+    // 网格尺寸取 2^k + 1，保证各级节点嵌套
+    int size = 5;
+    while (size < finalSize) size = 2 * size - 1;
+
+    m_modelType = modelType;
+    m_baseParams = baseParams;
+    m_xAxis = xAxis;
+    m_yAxis = yAxis;
+    m_finalSize = size;
+    m_kernel.prepare(m_obsPressure, m_obsDerivative, weight);
+    m_nodes = QVector<Node>(size * size);
+    m_completedSize.storeRelease(0);
+    m_cancelToken.reset();
+
+    m_watcher.setFuture(QtConcurrent::run([this]() { compute(); }));
+}
+
+void FittingLandscape::cancel()
+{
+    m_cancelToken.cancel();
+}
+
+bool FittingLandscape::isRunning() const
+{
+    return m_watcher.isRunning();
+}
+
+void FittingLandscape::evaluateNode(Node& node, int index)
+{
+    int ix = index % m_finalSize, iy = index / m_finalSize;
+
+    QMap<QString, double> params = m_baseParams;
+    params[m_xAxis.name] = m_xAxis.valueAt(ix, m_finalSize);
+    params[m_yAxis.name] = m_yAxis.valueAt(iy, m_finalSize);
+    FittingEngine::updateDependentParams(params);
+
+    ModelCurveData curve = m_modelManager->calculateTheoreticalCurve(m_modelType, params, m_obsTime, &m_cancelToken);
+    if (std::get<1>(curve).isEmpty()) return;   // 已取消
+
+    node.p = std::get<1>(curve);
+    node.d = std::get<2>(curve);
+    int count = 0;
+    double sse = m_kernel.sumSquares(node.p, node.d, &count);
+    node.mse = count > 0 ? sse / count : std::numeric_limits<double>::quiet_NaN();
+    node.computed = true;
+}
+
+void FittingLandscape::compute()
+{
+    // 节点缓存大小固定，先取得可写指针，避免并行访问时发生隐式共享分离
+    Node* nodes = m_nodes.data();
+    const int total = m_finalSize * m_finalSize;
+    int done = 0;
+
+    for (int size = 5; size <= m_finalSize; size = 2 * size - 1) {
+        int step = (m_finalSize - 1) / (size - 1);
+        QVector<int> pending;
+        for (int iy = 0; iy < m_finalSize; iy += step)
+            for (int ix = 0; ix < m_finalSize; ix += step)
+                if (!nodes[iy * m_finalSize + ix].computed) pending.append(iy * m_finalSize + ix);
+
+        QtConcurrent::blockingMap(pending, [this, nodes](int index) {
+            if (!m_cancelToken.isCancelled()) evaluateNode(nodes[index], index);
+        });
+        if (m_cancelToken.isCancelled()) return;
+
+        done += pending.size();
+        m_completedSize.storeRelease(size);
+        emit progressChanged(done * 100 / total);
+        emit levelFinished(size);
+        if (size == m_finalSize) break;
+    }
+}
+
+void FittingLandscape::setWeight(double weight)
+{
+    if (isRunning()) return;
+    m_kernel.prepare(m_obsPressure, m_obsDerivative, weight);
+    for (Node& node : m_nodes) {
+        if (!node.computed) continue;
+        int count = 0;
+        double sse = m_kernel.sumSquares(node.p, node.d, &count);
+        node.mse = count > 0 ? sse / count : std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+QVector<double> FittingLandscape::errorGrid(int& size) const
+{
+    size = completedSize();
+    QVector<double> grid;
+    if (size <= 0) return grid;
+
+    int step = (m_finalSize - 1) / (size - 1);
+    grid.resize(size * size);
+    const Node* nodes = m_nodes.constData();
+    for (int iy = 0; iy < size; ++iy) {
+        for (int ix = 0; ix < size; ++ix) {
+            const Node& node = nodes[(iy * step) * m_finalSize + ix * step];
+            grid[iy * size + ix] = node.computed ? node.mse : std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    return grid;
+}
+
+bool FittingLandscape::minimumNode(int& ix, int& iy, double& mse) const
+{
+    int size = 0;
+    QVector<double> grid = errorGrid(size);
+    bool found = false;
+    mse = std::numeric_limits<double>::max();
+    for (int i = 0; i < grid.size(); ++i) {
+        if (std::isfinite(grid[i]) && grid[i] < mse) {
+            mse = grid[i]; ix = i % size; iy = i / size; found = true;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,101 @@
+/*
+ * fittinglandscape.h
+ * 文件作用：二维目标函数曲面（误差地形图）计算头文件
+ * 功能描述：
+ * 1. 在两个拟合参数构成的网格上计算加权对数残差的均方误差 (MSE)，其余参数保持当前值
+ * 2. 逐级加密：网格尺寸 5 -> 9 -> 17 -> ...，上一级的节点是下一级的子集，已计算节点不重复计算
+ * 3. 每级节点通过 QtConcurrent 并行计算，计算过程可通过 CancellationToken 随时取消
+ * 4. 缓存每个节点的理论曲线，调整压力/导数权重时直接重算误差，无需重新计算模型
+ */
+
+#ifndef FITTINGLANDSCAPE_H
+#define FITTINGLANDSCAPE_H
+
+#include <QObject>
+#include <QMap>
+#include <QVector>
+#include <QFutureWatcher>
+#include <QAtomicInt>
+#include "modelmanager.h"
+#include "cancellationtoken.h"
+#include "fittingresidualkernel.h"
+
+// 地形图坐标轴：参数名与取值范围
+struct LandscapeAxis {
+    QString name;
+    double min;
+    double max;
+    bool logScale;      // 对数等分（要求 min > 0）
+
+    LandscapeAxis() : min(0.0), max(1.0), logScale(false) {}
+    // 第 i 个节点（共 n 个）的参数值
+    double valueAt(int i, int n) const;
+    // 绘图坐标（对数轴为 log10 值）
+    double plotCoord(double value) const;
+};
+
+class FittingLandscape : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FittingLandscape(ModelManager* modelManager, QObject* parent = nullptr);
+    ~FittingLandscape();
+
+    // 参与误差计算的观测数据
+    void setObservedData(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d);
+
+    // 启动后台计算，finalSize 为最终网格尺寸（取 2^k + 1）
+    void start(ModelManager::ModelType modelType, const QMap<QString, double>& baseParams,
+               const LandscapeAxis& xAxis, const LandscapeAxis& yAxis, int finalSize, double weight);
+    void cancel();
+    bool isRunning() const;
+
+    // 用缓存的理论曲线按新权重重算误差（计算进行中时无效）
+    void setWeight(double weight);
+
+    // 已完成的最细网格尺寸（0 表示尚无结果）
+    int completedSize() const { return m_completedSize.loadAcquire(); }
+    // 已完成网格的误差矩阵，下标 iy * size + ix，无效点为 NaN
+    QVector<double> errorGrid(int& size) const;
+    // 已完成网格中误差最小的节点（ix, iy 为已完成网格中的下标）
+    bool minimumNode(int& ix, int& iy, double& mse) const;
+
+    const LandscapeAxis& xAxis() const { return m_xAxis; }
+    const LandscapeAxis& yAxis() const { return m_yAxis; }
+
+signals:
+    void levelFinished(int size);
+    void progressChanged(int percent);
+    void finished();
+
+private:
+    // 节点缓存：最细网格下标
+    struct Node {
+        QVector<double> p;
+        QVector<double> d;
+        double mse;
+        bool computed;
+        Node() : mse(0.0), computed(false) {}
+    };
+
+    void compute();     // 工作线程
+    void evaluateNode(Node& node, int index);
+
+    ModelManager* m_modelManager;
+    QVector<double> m_obsTime, m_obsPressure, m_obsDerivative;
+    FittingResidualKernel m_kernel;
+
+    ModelManager::ModelType m_modelType;
+    QMap<QString, double> m_baseParams;
+    LandscapeAxis m_xAxis;
+    LandscapeAxis m_yAxis;
+    int m_finalSize;
+
+    QVector<Node> m_nodes;
+    QAtomicInt m_completedSize;
+    CancellationToken m_cancelToken;
+    QFutureWatcher<void> m_watcher;
+};
+
+#endif // FITTINGLANDSCAPE_H
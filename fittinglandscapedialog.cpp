@@ -0,0 +1,250 @@
+/*
+ * fittinglandscapedialog.cpp
+ * 文件作用：二维误差曲面弹窗的具体实现
+ * 功能描述：
+ * 1. 默认选取前两个参与拟合的参数，范围取参数上下限
+ * 2. 每完成一级网格即刷新热力图，粗网格结果先行显示
+ * 3. 对数等分的参数在 log10 坐标下绘制
+ */
+
+#include "fittinglandscapedialog.h"
+#include "ui_fittinglandscapedialog.h"
+#include "mousezoom.h"
+#include <QMessageBox>
+#include <cmath>
+#include <limits>
+
+FittingLandscapeDialog::FittingLandscapeDialog(ModelManager* modelManager, ModelManager::ModelType modelType, const QList<FitParameter>& params,
+                                               const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                                               double weight, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::FittingLandscapeDialog),
+    m_modelType(modelType),
+    m_params(params),
+    m_weight(weight)
+{
+    ui->setupUi(this);
+    this->setWindowTitle("误差曲面");
+
+    m_landscape = new FittingLandscape(modelManager, this);
+    m_landscape->setObservedData(t, p, d);
+
+    // 参数列表：参与拟合的参数排在前面
+    QStringList names;
+    for (const FitParameter& fp : m_params) if (fp.isFit) names << fp.name;
+    for (const FitParameter& fp : m_params) if (!fp.isFit && fp.name != "LfD") names << fp.name;
+    for (const QString& name : names) {
+        const FitParameter* fp = findParam(name);
+        QString label = fp->displayName.isEmpty() ? name : QString("%1 (%2)").arg(fp->displayName, name);
+        ui->comboX->addItem(label, name);
+        ui->comboY->addItem(label, name);
+    }
+    if (ui->comboY->count() > 1) ui->comboY->setCurrentIndex(1);
+
+    ui->comboResolution->addItem("17 × 17", 17);
+    ui->comboResolution->addItem("33 × 33", 33);
+    ui->comboResolution->addItem("65 × 65", 65);
+    ui->comboResolution->setCurrentIndex(1);
+    ui->spinWeight->setValue(qRound(m_weight * 100));
+
+    connect(ui->comboX, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &FittingLandscapeDialog::onParamChanged);
+    connect(ui->comboY, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &FittingLandscapeDialog::onParamChanged);
+    connect(ui->spinWeight, QOverload<int>::of(&QSpinBox::valueChanged), this, &FittingLandscapeDialog::onWeightChanged);
+    connect(ui->btnCompute, &QPushButton::clicked, this, &FittingLandscapeDialog::onCompute);
+    connect(ui->btnStop, &QPushButton::clicked, this, &FittingLandscapeDialog::onStop);
+    connect(ui->btnApply, &QPushButton::clicked, this, &FittingLandscapeDialog::onApply);
+    connect(ui->btnClose, &QPushButton::clicked, this, &FittingLandscapeDialog::reject);
+
+    connect(m_landscape, &FittingLandscape::progressChanged, ui->progressBar, &QProgressBar::setValue);
+    connect(m_landscape, &FittingLandscape::levelFinished, this, &FittingLandscapeDialog::onLevelFinished);
+    connect(m_landscape, &FittingLandscape::finished, this, &FittingLandscapeDialog::onFinished);
+
+    setupPlot();
+    onParamChanged();
+    updateButtons();
+}
+
+FittingLandscapeDialog::~FittingLandscapeDialog()
+{
+    delete ui;
+}
+
+const FitParameter* FittingLandscapeDialog::findParam(const QString& name) const
+{
+    for (const FitParameter& fp : m_params) if (fp.name == name) return &fp;
+    return nullptr;
+}
+
+void FittingLandscapeDialog::setupPlot()
+{
+    m_plot = new MouseZoom(this);
+    ui->plotContainer->layout()->addWidget(m_plot);
+    m_plot->setBackground(Qt::white);
+    m_plot->axisRect()->setupFullAxesBox(true);
+
+    m_colorMap = new QCPColorMap(m_plot->xAxis, m_plot->yAxis);
+    m_colorScale = new QCPColorScale(m_plot);
+    m_plot->plotLayout()->addElement(0, 1, m_colorScale);
+    m_colorScale->setType(QCPAxis::atRight);
+    m_colorScale->axis()->setLabel("log10(MSE)");
+    m_colorMap->setColorScale(m_colorScale);
+
+    // 分段色阶：相邻色带的边界即近似等值线
+    QCPColorGradient gradient(QCPColorGradient::gpJet);
+    gradient.setLevelCount(20);
+    gradient.setNanHandling(QCPColorGradient::nhTransparent);
+    m_colorMap->setGradient(gradient);
+    m_colorMap->setInterpolate(false);
+
+    QCPMarginGroup* marginGroup = new QCPMarginGroup(m_plot);
+    m_plot->axisRect()->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+    m_colorScale->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+
+    m_currentMarker = m_plot->addGraph();
+    m_currentMarker->setName("当前参数");
+    m_currentMarker->setLineStyle(QCPGraph::lsNone);
+    m_currentMarker->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCrossCircle, QPen(Qt::white, 2), QBrush(Qt::NoBrush), 14));
+
+    m_minMarker = m_plot->addGraph();
+    m_minMarker->setName("网格最小值");
+    m_minMarker->setLineStyle(QCPGraph::lsNone);
+    m_minMarker->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssStar, QPen(Qt::black, 2), QBrush(Qt::NoBrush), 14));
+
+    m_plot->legend->setVisible(true);
+    m_plot->legend->setFont(QFont("Arial", 9));
+    m_plot->legend->setBrush(QBrush(QColor(255, 255, 255, 200)));
+}
+
+void FittingLandscapeDialog::onParamChanged()
+{
+    // 范围默认取参数上下限；未设置上下限时取当前值的 0.1 ~ 10 倍
+    auto fill = [this](const QString& name, QLineEdit* editMin, QLineEdit* editMax, QCheckBox* checkLog) {
+        const FitParameter* fp = findParam(name);
+        if (!fp) return;
+        double lo = fp->min, hi = fp->max;
+        if (!(hi > lo)) { lo = fp->value > 0 ? fp->value * 0.1 : -1.0; hi = fp->value > 0 ? fp->value * 10.0 : 1.0; }
+        editMin->setText(QString::number(lo, 'g', 6));
+        editMax->setText(QString::number(hi, 'g', 6));
+        checkLog->setChecked(lo > 0 && hi / lo >= 10.0);
+    };
+    fill(ui->comboX->currentData().toString(), ui->editXMin, ui->editXMax, ui->checkXLog);
+    fill(ui->comboY->currentData().toString(), ui->editYMin, ui->editYMax, ui->checkYLog);
+}
+
+void FittingLandscapeDialog::onCompute()
+{
+    if (m_landscape->isRunning()) return;
+
+    LandscapeAxis x, y;
+    x.name = ui->comboX->currentData().toString();
+    y.name = ui->comboY->currentData().toString();
+    if (x.name.isEmpty() || y.name.isEmpty() || x.name == y.name) {
+        QMessageBox::warning(this, "提示", "请选择两个不同的参数。");
+        return;
+    }
+    x.min = ui->editXMin->text().toDouble(); x.max = ui->editXMax->text().toDouble(); x.logScale = ui->checkXLog->isChecked();
+    y.min = ui->editYMin->text().toDouble(); y.max = ui->editYMax->text().toDouble(); y.logScale = ui->checkYLog->isChecked();
+    if (!(x.max > x.min) || !(y.max > y.min) || (x.logScale && x.min <= 0) || (y.logScale && y.min <= 0)) {
+        QMessageBox::warning(this, "提示", "参数范围无效（对数等分要求下限大于 0）。");
+        return;
+    }
+
+    QMap<QString, double> base;
+    for (const FitParameter& fp : m_params) base.insert(fp.name, fp.value);
+
+    m_colorMap->data()->clear();
+    m_minMarker->data()->clear();
+    m_plot->xAxis->setLabel(x.logScale ? QString("log10(%1)").arg(x.name) : x.name);
+    m_plot->yAxis->setLabel(y.logScale ? QString("log10(%1)").arg(y.name) : y.name);
+    m_plot->xAxis->setRange(x.plotCoord(x.min), x.plotCoord(x.max));
+    m_plot->yAxis->setRange(y.plotCoord(y.min), y.plotCoord(y.max));
+    m_currentMarker->data()->clear();
+    m_currentMarker->addData(x.plotCoord(base.value(x.name)), y.plotCoord(base.value(y.name)));
+    m_plot->replot();
+
+    ui->progressBar->setValue(0);
+    m_landscape->start(m_modelType, base, x, y, ui->comboResolution->currentData().toInt(), m_weight);
+    updateButtons();
+}
+
+void FittingLandscapeDialog::onStop()
+{
+    m_landscape->cancel();
+}
+
+void FittingLandscapeDialog::onLevelFinished(int size)
+{
+    int n = 0;
+    QVector<double> grid = m_landscape->errorGrid(n);
+    if (n != size || n <= 0) return;
+
+    const LandscapeAxis& x = m_landscape->xAxis();
+    const LandscapeAxis& y = m_landscape->yAxis();
+    m_colorMap->data()->setSize(n, n);
+    m_colorMap->data()->setRange(QCPRange(x.plotCoord(x.min), x.plotCoord(x.max)), QCPRange(y.plotCoord(y.min), y.plotCoord(y.max)));
+    for (int iy = 0; iy < n; ++iy) {
+        for (int ix = 0; ix < n; ++ix) {
+            double mse = grid[iy * n + ix];
+            m_colorMap->data()->setCell(ix, iy, (std::isfinite(mse) && mse > 0) ? std::log10(mse) : std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+    m_colorMap->rescaleDataRange(true);
+
+    int bx = 0, by = 0; double bestMse = 0.0;
+    m_minMarker->data()->clear();
+    if (m_landscape->minimumNode(bx, by, bestMse)) {
+        double vx = x.valueAt(bx, n), vy = y.valueAt(by, n);
+        m_minMarker->addData(x.plotCoord(vx), y.plotCoord(vy));
+        ui->labelResult->setText(QString("网格最小误差: %1   %2 = %3, %4 = %5 (%6 × %6)")
+                                 .arg(bestMse, 0, 'e', 3).arg(x.name).arg(vx, 0, 'g', 5).arg(y.name).arg(vy, 0, 'g', 5).arg(n));
+    }
+    m_plot->replot();
+}
+
+void FittingLandscapeDialog::onFinished()
+{
+    updateButtons();
+}
+
+void FittingLandscapeDialog::onWeightChanged(int percent)
+{
+    m_weight = percent / 100.0;
+    if (m_landscape->isRunning() || m_landscape->completedSize() <= 0) return;
+    m_landscape->setWeight(m_weight);
+    onLevelFinished(m_landscape->completedSize());
+}
+
+void FittingLandscapeDialog::onApply()
+{
+    int n = m_landscape->completedSize();
+    int bx = 0, by = 0; double bestMse = 0.0;
+    if (n <= 0 || !m_landscape->minimumNode(bx, by, bestMse)) return;
+
+    const LandscapeAxis& x = m_landscape->xAxis();
+    const LandscapeAxis& y = m_landscape->yAxis();
+    for (FitParameter& fp : m_params) {
+        if (fp.name == x.name) fp.value = x.valueAt(bx, n);
+        if (fp.name == y.name) fp.value = y.valueAt(by, n);
+    }
+    accept();
+}
+
+void FittingLandscapeDialog::reject()
+{
+    m_landscape->cancel();
+    QDialog::reject();
+}
+
+void FittingLandscapeDialog::updateButtons()
+{
+    bool running = m_landscape->isRunning();
+    ui->spinWeight->setEnabled(!running);
+    ui->btnCompute->setEnabled(!running);
+    ui->btnStop->setEnabled(running);
+    ui->btnApply->setEnabled(!running);
+}
+
+QList<FitParameter> FittingLandscapeDialog::getUpdatedParams() const
+{
+    return m_params;
+}
@@ -0,0 +1,69 @@
+#ifndef FITTINGLANDSCAPEDIALOG_H
+#define FITTINGLANDSCAPEDIALOG_H
+
+#include <QDialog>
+#include "fittinglandscape.h"
+#include "fittingparameterchart.h"
+
+namespace Ui {
+class FittingLandscapeDialog;
+}
+
+class MouseZoom;
+class QCPColorMap;
+class QCPColorScale;
+class QCPGraph;
+
+// ===========================================================================
+// 类名：FittingLandscapeDialog
+// 作用：二维误差曲面弹窗
+// 功能：
+// 1. 选择两个参数及其范围（线性/对数等分）与网格尺寸，后台逐级加密计算误差曲面
+// 2. 以热力图显示 log10(MSE)，色阶分段显示近似等值线
+// 3. 标记当前参数值（当前最优）与网格最小误差点，可将网格最优值写回参数表
+// ===========================================================================
+
+class FittingLandscapeDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    FittingLandscapeDialog(ModelManager* modelManager, ModelManager::ModelType modelType, const QList<FitParameter>& params,
+                           const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                           double weight, QWidget *parent = nullptr);
+    ~FittingLandscapeDialog();
+
+    // 采用网格最优值后的参数列表
+    QList<FitParameter> getUpdatedParams() const;
+
+protected:
+    void reject() override;
+
+private slots:
+    void onParamChanged();
+    void onCompute();
+    void onStop();
+    void onApply();
+    void onLevelFinished(int size);
+    void onFinished();
+    void onWeightChanged(int percent);
+
+private:
+    Ui::FittingLandscapeDialog *ui;
+    FittingLandscape* m_landscape;
+    ModelManager::ModelType m_modelType;
+    QList<FitParameter> m_params;
+    double m_weight;
+
+    MouseZoom* m_plot;
+    QCPColorMap* m_colorMap;
+    QCPColorScale* m_colorScale;
+    QCPGraph* m_currentMarker;   // 当前参数值
+    QCPGraph* m_minMarker;       // 网格最小误差点
+
+    void setupPlot();
+    void updateButtons();
+    const FitParameter* findParam(const QString& name) const;
+};
+
+#endif // FITTINGLANDSCAPEDIALOG_H
@@ -0,0 +1,287 @@
+/*
+ * fittingmcmc.cpp
+ * 文件作用：拟合参数后验分布的 MCMC 采样器实现文件
+ * 功能描述：
+ * 1. 每个步行者持有独立的随机数发生器（由总种子派生），并行更新时结果仍可复现
+ * 2. 延迟接受：第一级以代理后验与 stretch move 提议比 z^(d-1) 判定，
+ *    第二级以 [L(y)·Ls(x)] / [L(x)·Ls(y)] 判定，两级均通过才接受
+ * 3. 链文件每步追加全部步行者的位置（含预烧段），列为 step, walker, logp, 各参数外部值
+ */
+
+#include "fittingmcmc.h"
+#include "fittingengine.h"
+
+#include <QtConcurrent>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+FittingMcmcSampler::FittingMcmcSampler(ModelManager* modelManager, QObject* parent)
+    : QObject(parent)
+    , m_modelManager(modelManager)
+    , m_modelType(ModelManager::Model_1)
+    , m_sigma2(1.0)
+    , m_completedSteps(0)
+    , m_proposals(0)
+    , m_accepted(0)
+    , m_fullEvals(0)
+    , m_surrogateEvals(0)
+{
+    connect(&m_watcher, &QFutureWatcher<void>::finished, this, &FittingMcmcSampler::finished);
+}
+
+FittingMcmcSampler::~FittingMcmcSampler()
+{
+    m_cancelToken.cancel();
+    m_watcher.waitForFinished();
+}
+
+void FittingMcmcSampler::setObservedData(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d)
+{
+    m_obsTime = t; m_obsPressure = p; m_obsDerivative = d;
+}
+
+void FittingMcmcSampler::start(ModelManager::ModelType modelType, const QList<FitParameter>& params, double weight,
+                               const McmcSettings& settings)
+{
+    if (isRunning() || !m_modelManager || m_obsTime.isEmpty()) return;
+
+    m_modelType = modelType;
+    m_params = params;
+    m_settings = settings;
+    m_baseParams.clear();
+    m_fitIndices.clear();
+    m_transforms.clear();
+    m_names.clear();
+    // 变产量历史生效时 q 不影响理论曲线（与 FittingEngine 一致），不参与采样
+    const bool multiRate = m_modelManager && m_modelManager->getRateHistory().isMultiRate();
+    for (int i = 0; i < params.size(); ++i) {
+        m_baseParams.insert(params[i].name, params[i].value);
+        if (!params[i].isFit || (multiRate && params[i].name == "q")) continue;
+        m_fitIndices.append(i);
+        m_transforms.append(FittingParameterTransform::forParameter(params[i], BoundHandling::Projected));
+        m_names.append(params[i].name);
+    }
+
+    // 步行者数量取偶数且不少于 2 × 参数个数
+    int d = m_fitIndices.size();
+    m_settings.walkers = qMax(m_settings.walkers, 2 * d + 2);
+    if (m_settings.walkers % 2) ++m_settings.walkers;
+    m_settings.burnIn = qBound(0, m_settings.burnIn, m_settings.steps);
+    m_settings.thin = qMax(1, m_settings.thin);
+
+    m_kernel.prepare(m_obsPressure, m_obsDerivative, weight);
+    m_samples.clear();
+    m_summaries.clear();
+    m_completedSteps = 0;
+    m_error.clear();
+    m_proposals.storeRelaxed(0);
+    m_accepted.storeRelaxed(0);
+    m_fullEvals.storeRelaxed(0);
+    m_surrogateEvals.storeRelaxed(0);
+    m_cancelToken.reset();
+
+    m_watcher.setFuture(QtConcurrent::run([this]() { run(); }));
+}
+
+void FittingMcmcSampler::cancel()
+{
+    m_cancelToken.cancel();
+}
+
+bool FittingMcmcSampler::isRunning() const
+{
+    return m_watcher.isRunning();
+}
+
+double FittingMcmcSampler::acceptanceRate() const
+{
+    int n = m_proposals.loadRelaxed();
+    return n > 0 ? double(m_accepted.loadRelaxed()) / n : 0.0;
+}
+
+bool FittingMcmcSampler::inPrior(const QVector<double>& u) const
+{
+    for (int i = 0; i < u.size(); ++i) {
+        if (!std::isfinite(u[i]) || u[i] < m_transforms[i].internalLower() || u[i] > m_transforms[i].internalUpper()) return false;
+    }
+    return true;
+}
+
+double FittingMcmcSampler::logPosterior(const QVector<double>& u, int stehfestN)
+{
+    QMap<QString, double> p = m_baseParams;
+    for (int i = 0; i < u.size(); ++i) p[m_names.at(i)] = m_transforms.at(i).toExternal(u[i]);
+    FittingEngine::updateDependentParams(p);
+    p["N"] = stehfestN;
+
+    ModelCurveData curve = m_modelManager->calculateTheoreticalCurve(m_modelType, p, m_obsTime, &m_cancelToken);
+    if (std::get<1>(curve).isEmpty()) return std::numeric_limits<double>::quiet_NaN();   // 已取消
+
+    int count = 0;
+    double sse = m_kernel.sumSquares(std::get<1>(curve), std::get<2>(curve), &count);
+    if (count == 0 || !std::isfinite(sse)) return -std::numeric_limits<double>::infinity();
+    return -0.5 * sse / m_sigma2;
+}
+
+void FittingMcmcSampler::updateWalker(Walker& w, const Walker* others, int otherCount)
+{
+    const int d = w.u.size();
+    const double a = m_settings.stretch;
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+    std::uniform_int_distribution<int> pick(0, otherCount - 1);
+
+    // stretch move: y = x_j + z (x - x_j)，z 服从 g(z) ∝ 1/sqrt(z)，z ∈ [1/a, a]
+    const Walker& partner = others[pick(w.rng)];
+    double r = uni(w.rng);
+    double z = std::pow((a - 1.0) * r + 1.0, 2) / a;
+    QVector<double> y(d);
+    for (int i = 0; i < d; ++i) y[i] = partner.u[i] + z * (w.u[i] - partner.u[i]);
+    double logProposal = (d - 1) * std::log(z);
+    double logU1 = std::log(uni(w.rng));
+    double logU2 = std::log(uni(w.rng));
+
+    m_proposals.fetchAndAddRelaxed(1);
+    if (!inPrior(y)) return;
+
+    double logpS = 0.0;
+    double logAlpha = logProposal;
+    if (m_settings.useSurrogate) {
+        // 第一级：代理后验
+        logpS = logPosterior(y, m_settings.surrogateN);
+        m_surrogateEvals.fetchAndAddRelaxed(1);
+        if (std::isnan(logpS) || logU1 >= logProposal + logpS - w.logpS) return;
+        logAlpha = -(logpS - w.logpS);
+    }
+
+    // 第二级（或无代理时唯一一级）：全精度后验
+    double logp = logPosterior(y, m_settings.fullN);
+    m_fullEvals.fetchAndAddRelaxed(1);
+    if (std::isnan(logp)) return;
+    logAlpha += logp - w.logp;
+    if ((m_settings.useSurrogate ? logU2 : logU1) >= logAlpha) return;
+
+    w.u = y;
+    w.logp = logp;
+    w.logpS = logpS;
+    m_accepted.fetchAndAddRelaxed(1);
+}
+
+void FittingMcmcSampler::run()
+{
+    const int d = m_fitIndices.size();
+    const int nw = m_settings.walkers;
+    if (d == 0) { m_error = "没有参与拟合的参数。"; return; }
+
+    // 1. 噪声方差：以当前参数（拟合结果）的残差均方估计
+    QVector<double> u0(d);
+    for (int i = 0; i < d; ++i) u0[i] = m_transforms[i].project(m_transforms[i].toInternal(m_params[m_fitIndices[i]].value));
+    {
+        QMap<QString, double> p = m_baseParams;
+        FittingEngine::updateDependentParams(p);
+        p["N"] = m_settings.fullN;
+        ModelCurveData curve = m_modelManager->calculateTheoreticalCurve(m_modelType, p, m_obsTime, &m_cancelToken);
+        if (std::get<1>(curve).isEmpty()) return;
+        int count = 0;
+        double sse = m_kernel.sumSquares(std::get<1>(curve), std::get<2>(curve), &count);
+        if (count <= d || !std::isfinite(sse) || sse <= 0) { m_error = "有效观测点不足，无法估计噪声方差。"; return; }
+        m_sigma2 = sse / (count - d);
+    }
+
+    // 2. 初始化步行者：在当前参数附近的小球内随机分布
+    std::mt19937_64 master(m_settings.seed);
+    std::normal_distribution<double> gauss(0.0, 1.0);
+    m_walkers = QVector<Walker>(nw);
+    for (Walker& w : m_walkers) {
+        w.rng.seed(master());
+        w.u = u0;
+        for (int i = 0; i < d; ++i) {
+            double lo = m_transforms[i].internalLower(), hi = m_transforms[i].internalUpper();
+            double width = (std::isfinite(lo) && std::isfinite(hi)) ? 0.01 * (hi - lo) : 0.01 * qMax(1.0, std::abs(u0[i]));
+            w.u[i] = m_transforms[i].project(u0[i] + width * gauss(w.rng));
+        }
+    }
+    Walker* walkers = m_walkers.data();
+    QVector<int> all(nw);
+    for (int i = 0; i < nw; ++i) all[i] = i;
+    QtConcurrent::blockingMap(all, [this, walkers](int i) {
+        Walker& w = walkers[i];
+        w.logp = logPosterior(w.u, m_settings.fullN);
+        w.logpS = m_settings.useSurrogate ? logPosterior(w.u, m_settings.surrogateN) : 0.0;
+    });
+    if (m_cancelToken.isCancelled()) return;
+
+    // 3. 链文件
+    QFile chainFile(m_settings.chainFile);
+    QTextStream chainOut(&chainFile);
+    bool streaming = false;
+    if (!m_settings.chainFile.isEmpty()) {
+        streaming = chainFile.open(QIODevice::WriteOnly | QIODevice::Text);
+        if (streaming) chainOut << "step,walker,logp," << m_names.join(",") << "\n";
+        else m_error = "无法写入链文件: " + m_settings.chainFile;
+    }
+
+    // 4. 红蓝分组迭代：前半组以后半组为参照并行更新，然后交换
+    const int half = nw / 2;
+    QVector<int> firstHalf(half), secondHalf(half);
+    for (int i = 0; i < half; ++i) { firstHalf[i] = i; secondHalf[i] = half + i; }
+
+    m_samples.reserve(((m_settings.steps - m_settings.burnIn) / m_settings.thin + 1) * nw * d);
+    for (int step = 0; step < m_settings.steps; ++step) {
+        QtConcurrent::blockingMap(firstHalf, [this, walkers, half](int i) { updateWalker(walkers[i], walkers + half, half); });
+        QtConcurrent::blockingMap(secondHalf, [this, walkers, half](int i) { updateWalker(walkers[i], walkers, half); });
+        if (m_cancelToken.isCancelled()) break;
+
+        if (streaming) {
+            for (int k = 0; k < nw; ++k) {
+                chainOut << step << "," << k << "," << walkers[k].logp;
+                for (int i = 0; i < d; ++i) chainOut << "," << m_transforms[i].toExternal(walkers[k].u[i]);
+                chainOut << "\n";
+            }
+            chainOut.flush();
+        }
+        if (step >= m_settings.burnIn && (step - m_settings.burnIn) % m_settings.thin == 0) {
+            for (int k = 0; k < nw; ++k)
+                for (int i = 0; i < d; ++i) m_samples.append(m_transforms[i].toExternal(walkers[k].u[i]));
+        }
+        m_completedSteps = step + 1;
+        emit progressChanged(step + 1, m_settings.steps, acceptanceRate());
+    }
+
+    computeSummaries();
+}
+
+void FittingMcmcSampler::computeSummaries()
+{
+    m_summaries.clear();
+    const int d = m_names.size();
+    const int n = sampleCount();
+    if (n == 0) return;
+
+    auto quantile = [](const std::vector<double>& v, double q) {
+        double pos = q * (v.size() - 1);
+        size_t lo = size_t(pos);
+        size_t hi = std::min(lo + 1, v.size() - 1);
+        return v[lo] + (pos - lo) * (v[hi] - v[lo]);
+    };
+
+    std::vector<double> v(n);
+    for (int i = 0; i < d; ++i) {
+        double sum = 0.0;
+        for (int s = 0; s < n; ++s) { v[s] = m_samples[s * d + i]; sum += v[s]; }
+        std::sort(v.begin(), v.end());
+
+        McmcParamSummary ps;
+        ps.name = m_names[i];
+        ps.logScale = (m_transforms[i].type() == FittingParameterTransform::Log);
+        ps.mean = sum / n;
+        ps.median = quantile(v, 0.5);
+        ps.lo68 = quantile(v, 0.16);
+        ps.hi68 = quantile(v, 0.84);
+        ps.lo95 = quantile(v, 0.025);
+        ps.hi95 = quantile(v, 0.975);
+        m_summaries.append(ps);
+    }
+}
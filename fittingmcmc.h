@@ -0,0 +1,134 @@
+/*
+ * fittingmcmc.h
+ * 文件作用：拟合参数后验分布的 MCMC 采样器头文件
+ * 功能描述：
+ * 1. 仿射不变集成采样 (Goodman-Weare stretch move)，采样在参数内部坐标（对数/线性）中进行，
+ *    先验为参数上下限内的均匀分布（对数坐标参数即对数均匀）
+ * 2. 似然取加权对数残差：log L = -SSE / (2·σ²)，σ² 由当前参数（拟合结果）的残差均方估计
+ * 3. 红蓝分组更新：每半组步行者只依赖另一半组的位置，同组内通过 QtConcurrent 并行计算
+ * 4. 代理加速：可选用低阶 Stehfest 反演作为代理似然进行两级延迟接受，
+ *    第一级被拒绝的提议不做全精度计算，且平稳分布仍为全精度后验
+ * 5. 链数据逐步写入 CSV 文件，停止后已完成的样本仍可用于统计
+ */
+
+#ifndef FITTINGMCMC_H
+#define FITTINGMCMC_H
+
+#include <QObject>
+#include <QMap>
+#include <QVector>
+#include <QFutureWatcher>
+#include <QAtomicInt>
+#include <random>
+#include "modelmanager.h"
+#include "fittingparameterchart.h"
+#include "fittingparametertransform.h"
+#include "fittingresidualkernel.h"
+#include "cancellationtoken.h"
+
+// 采样设置
+struct McmcSettings {
+    int walkers;            // 步行者数量（取偶数，不少于 2 × 参数个数）
+    int steps;              // 总步数
+    int burnIn;             // 预烧步数（不计入统计）
+    int thin;               // 抽稀间隔
+    double stretch;         // stretch move 缩放参数 a
+    bool useSurrogate;      // 低精度代理两级延迟接受
+    int surrogateN;         // 代理似然的 Stehfest 阶数
+    int fullN;              // 全精度似然的 Stehfest 阶数
+    quint64 seed;
+    QString chainFile;      // 链数据输出文件（为空时不写文件）
+
+    McmcSettings() : walkers(32), steps(1000), burnIn(300), thin(1), stretch(2.0),
+        useSurrogate(true), surrogateN(4), fullN(8), seed(1) {}
+};
+
+// 单个参数的后验统计（外部单位）
+struct McmcParamSummary {
+    QString name;
+    bool logScale;          // 内部坐标为 log10
+    double mean;
+    double median;
+    double lo68, hi68;      // 16% / 84% 分位数
+    double lo95, hi95;      // 2.5% / 97.5% 分位数
+
+    McmcParamSummary() : logScale(false), mean(0), median(0), lo68(0), hi68(0), lo95(0), hi95(0) {}
+};
+
+class FittingMcmcSampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FittingMcmcSampler(ModelManager* modelManager, QObject* parent = nullptr);
+    ~FittingMcmcSampler();
+
+    void setObservedData(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d);
+
+    // 以 params 中参与拟合的参数为采样变量，当前值为初始中心
+    void start(ModelManager::ModelType modelType, const QList<FitParameter>& params, double weight,
+               const McmcSettings& settings);
+    void cancel();
+    bool isRunning() const;
+
+    // --- 结果（finished 后有效）---
+    const QStringList& paramNames() const { return m_names; }
+    // 统计样本（外部单位），第 s 个样本的第 i 个参数位于 s * paramCount + i
+    const QVector<double>& samples() const { return m_samples; }
+    int sampleCount() const { return m_names.isEmpty() ? 0 : m_samples.size() / m_names.size(); }
+    const QList<McmcParamSummary>& summaries() const { return m_summaries; }
+    int completedSteps() const { return m_completedSteps; }
+    double acceptanceRate() const;
+    double noiseVariance() const { return m_sigma2; }
+    int fullEvaluations() const { return m_fullEvals.loadRelaxed(); }
+    int surrogateEvaluations() const { return m_surrogateEvals.loadRelaxed(); }
+    QString lastError() const { return m_error; }
+
+signals:
+    void progressChanged(int step, int totalSteps, double acceptance);
+    void finished();
+
+private:
+    struct Walker {
+        QVector<double> u;      // 内部坐标
+        double logp;            // 全精度对数后验
+        double logpS;           // 代理对数后验
+        std::mt19937_64 rng;
+    };
+
+    void run();     // 工作线程
+    bool inPrior(const QVector<double>& u) const;
+    // 返回对数后验（不含常数项）；计算被取消时返回 NaN
+    double logPosterior(const QVector<double>& u, int stehfestN);
+    void updateWalker(Walker& w, const Walker* others, int otherCount);
+    void computeSummaries();
+
+    ModelManager* m_modelManager;
+    QVector<double> m_obsTime, m_obsPressure, m_obsDerivative;
+    FittingResidualKernel m_kernel;
+
+    ModelManager::ModelType m_modelType;
+    QMap<QString, double> m_baseParams;
+    QList<int> m_fitIndices;
+    QList<FitParameter> m_params;
+    QVector<FittingParameterTransform> m_transforms;
+    McmcSettings m_settings;
+    double m_sigma2;
+
+    QVector<Walker> m_walkers;
+    QStringList m_names;
+    QVector<double> m_samples;
+    QList<McmcParamSummary> m_summaries;
+    int m_completedSteps;
+    QString m_error;
+
+    QAtomicInt m_proposals;
+    QAtomicInt m_accepted;
+    QAtomicInt m_fullEvals;
+    QAtomicInt m_surrogateEvals;
+
+    CancellationToken m_cancelToken;
+    QFutureWatcher<void> m_watcher;
+};
+
+#endif // FITTINGMCMC_H
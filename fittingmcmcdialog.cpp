@@ -0,0 +1,259 @@
+/*
+ * fittingmcmcdialog.cpp
+ * 文件作用：拟合参数后验采样弹窗的具体实现
+ * 功能描述：
+ * 1. 链文件默认保存在项目目录下，为空时不写文件
+ * 2. 对数坐标采样的参数在角图中以 log10 值绘制，直方图标出 16% / 50% / 84% 分位数
+ * 3. 采样被停止时，已完成的预烧后样本仍参与统计与绘图
+ */
+
+#include "fittingmcmcdialog.h"
+#include "ui_fittingmcmcdialog.h"
+#include "qcustomplot.h"
+#include "modelparameter.h"
+#include <QFileDialog>
+#include <QMessageBox>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+FittingMcmcDialog::FittingMcmcDialog(ModelManager* modelManager, ModelManager::ModelType modelType, const QList<FitParameter>& params,
+                                     const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                                     double weight, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::FittingMcmcDialog),
+    m_modelType(modelType),
+    m_params(params),
+    m_weight(weight)
+{
+    ui->setupUi(this);
+    this->setWindowTitle("后验采样 (MCMC)");
+
+    m_sampler = new FittingMcmcSampler(modelManager, this);
+    m_sampler->setObservedData(t, p, d);
+
+    QString projectDir = ModelParameter::instance()->getProjectPath();
+    if (!projectDir.isEmpty()) ui->editChainFile->setText(projectDir + "/mcmc_chain.csv");
+
+    QStringList headers;
+    headers << "参数" << "当前值" << "后验中位数" << "68% 可信区间" << "95% 可信区间";
+    ui->tableSummary->setColumnCount(headers.size());
+    ui->tableSummary->setHorizontalHeaderLabels(headers);
+    ui->tableSummary->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    ui->tableSummary->horizontalHeader()->setStretchLastSection(true);
+
+    m_plot = new QCustomPlot(this);
+    m_plot->setBackground(Qt::white);
+    ui->plotContainer->layout()->addWidget(m_plot);
+
+    connect(ui->btnRun, &QPushButton::clicked, this, &FittingMcmcDialog::onRun);
+    connect(ui->btnStop, &QPushButton::clicked, this, &FittingMcmcDialog::onStop);
+    connect(ui->btnBrowseChain, &QPushButton::clicked, this, &FittingMcmcDialog::onBrowseChainFile);
+    connect(ui->btnApply, &QPushButton::clicked, this, &FittingMcmcDialog::onApply);
+    connect(ui->btnClose, &QPushButton::clicked, this, &FittingMcmcDialog::reject);
+    connect(m_sampler, &FittingMcmcSampler::progressChanged, this, &FittingMcmcDialog::onProgress);
+    connect(m_sampler, &FittingMcmcSampler::finished, this, &FittingMcmcDialog::onFinished);
+
+    updateButtons();
+}
+
+FittingMcmcDialog::~FittingMcmcDialog()
+{
+    delete ui;
+}
+
+void FittingMcmcDialog::onBrowseChainFile()
+{
+    QString path = QFileDialog::getSaveFileName(this, "链数据文件", ui->editChainFile->text(), "CSV Files (*.csv)");
+    if (!path.isEmpty()) ui->editChainFile->setText(path);
+}
+
+void FittingMcmcDialog::onRun()
+{
+    if (m_sampler->isRunning()) return;
+    bool anyFit = false;
+    for (const FitParameter& fp : m_params) anyFit = anyFit || fp.isFit;
+    if (!anyFit) { QMessageBox::warning(this, "提示", "请先在参数表中勾选参与拟合的参数。"); return; }
+
+    McmcSettings s;
+    s.walkers = ui->spinWalkers->value();
+    s.steps = ui->spinSteps->value();
+    s.burnIn = qMin(ui->spinBurnIn->value(), s.steps - 1);
+    s.thin = ui->spinThin->value();
+    s.useSurrogate = ui->checkSurrogate->isChecked();
+    s.seed = quint64(ui->spinSeed->value());
+    s.chainFile = ui->editChainFile->text().trimmed();
+
+    ui->progressBar->setValue(0);
+    ui->labelResult->setText("采样中...");
+    m_sampler->start(m_modelType, m_params, m_weight, s);
+    updateButtons();
+}
+
+void FittingMcmcDialog::onStop()
+{
+    m_sampler->cancel();
+}
+
+void FittingMcmcDialog::onProgress(int step, int totalSteps, double acceptance)
+{
+    ui->progressBar->setValue(totalSteps > 0 ? step * 100 / totalSteps : 0);
+    ui->labelResult->setText(QString("步数: %1 / %2   接受率: %3%").arg(step).arg(totalSteps).arg(acceptance * 100.0, 0, 'f', 1));
+}
+
+void FittingMcmcDialog::onFinished()
+{
+    updateButtons();
+    if (!m_sampler->lastError().isEmpty()) QMessageBox::warning(this, "提示", m_sampler->lastError());
+
+    QString text = QString("完成步数: %1   接受率: %2%   样本数: %3   全精度计算: %4 次")
+                       .arg(m_sampler->completedSteps()).arg(m_sampler->acceptanceRate() * 100.0, 0, 'f', 1)
+                       .arg(m_sampler->sampleCount()).arg(m_sampler->fullEvaluations());
+    if (m_sampler->surrogateEvaluations() > 0) text += QString("   代理计算: %1 次").arg(m_sampler->surrogateEvaluations());
+    ui->labelResult->setText(text);
+
+    updateSummaryTable();
+    buildCornerPlot();
+}
+
+void FittingMcmcDialog::updateSummaryTable()
+{
+    const QList<McmcParamSummary>& list = m_sampler->summaries();
+    ui->tableSummary->setRowCount(list.size());
+    for (int i = 0; i < list.size(); ++i) {
+        const McmcParamSummary& s = list[i];
+        double current = 0.0;
+        for (const FitParameter& fp : m_params) if (fp.name == s.name) current = fp.value;
+
+        auto fmt = [](double v) { return QString::number(v, 'g', 5); };
+        QStringList cells;
+        cells << s.name << fmt(current) << fmt(s.median)
+              << QString("[%1, %2]").arg(fmt(s.lo68), fmt(s.hi68))
+              << QString("[%1, %2]").arg(fmt(s.lo95), fmt(s.hi95));
+        for (int c = 0; c < cells.size(); ++c) {
+            QTableWidgetItem* item = new QTableWidgetItem(cells[c]);
+            item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+            ui->tableSummary->setItem(i, c, item);
+        }
+    }
+}
+
+void FittingMcmcDialog::buildCornerPlot()
+{
+    m_plot->clearPlottables();
+    m_plot->plotLayout()->clear();
+
+    const QList<McmcParamSummary>& list = m_sampler->summaries();
+    const QVector<double>& samples = m_sampler->samples();
+    const int d = list.size();
+    const int n = m_sampler->sampleCount();
+    if (d == 0 || n == 0) { m_plot->replot(); return; }
+
+    // 绘图坐标：对数采样的参数取 log10
+    QVector<QVector<double>> coords(d, QVector<double>(n));
+    QVector<QCPRange> ranges(d);
+    for (int i = 0; i < d; ++i) {
+        double lo = std::numeric_limits<double>::max(), hi = -std::numeric_limits<double>::max();
+        for (int s = 0; s < n; ++s) {
+            double v = samples[s * d + i];
+            v = (list[i].logScale && v > 0) ? std::log10(v) : v;
+            coords[i][s] = v;
+            lo = qMin(lo, v); hi = qMax(hi, v);
+        }
+        if (!(hi > lo)) { lo -= 0.5; hi += 0.5; }
+        ranges[i] = QCPRange(lo, hi);
+    }
+    auto label = [&list](int i) { return list[i].logScale ? QString("log10(%1)").arg(list[i].name) : list[i].name; };
+    auto coord = [&list](int i, double v) { return (list[i].logScale && v > 0) ? std::log10(v) : v; };
+
+    const int bins = 30;
+    QCPColorGradient gradient(QCPColorGradient::gpGrayscale);
+    gradient = gradient.inverted();
+
+    for (int row = 0; row < d; ++row) {
+        for (int col = 0; col <= row; ++col) {
+            QCPAxisRect* rect = new QCPAxisRect(m_plot);
+            m_plot->plotLayout()->addElement(row, col, rect);
+            rect->setupFullAxesBox(false);
+            QCPAxis* xa = rect->axis(QCPAxis::atBottom);
+            QCPAxis* ya = rect->axis(QCPAxis::atLeft);
+            xa->setTickLabels(row == d - 1);
+            ya->setTickLabels(col == 0 && row > 0);
+            if (row == d - 1) xa->setLabel(label(col));
+            if (col == 0 && row > 0) ya->setLabel(label(row));
+            xa->setRange(ranges[col]);
+
+            if (row == col) {
+                // 边缘分布直方图
+                double width = ranges[col].size() / bins;
+                QVector<double> keys(bins), counts(bins, 0.0);
+                for (int b = 0; b < bins; ++b) keys[b] = ranges[col].lower + (b + 0.5) * width;
+                for (double v : coords[col]) counts[qBound(0, int((v - ranges[col].lower) / width), bins - 1)] += 1.0;
+                double maxCount = *std::max_element(counts.begin(), counts.end());
+
+                QCPBars* bars = new QCPBars(xa, ya);
+                bars->setData(keys, counts);
+                bars->setWidth(width);
+                bars->setPen(QPen(QColor(70, 70, 70)));
+                bars->setBrush(QColor(120, 160, 220));
+                ya->setRange(0, maxCount * 1.1);
+
+                const double qs[3] = { list[col].lo68, list[col].median, list[col].hi68 };
+                for (int k = 0; k < 3; ++k) {
+                    QCPGraph* line = m_plot->addGraph(xa, ya);
+                    double x = coord(col, qs[k]);
+                    line->addData(x, 0.0);
+                    line->addData(x, maxCount * 1.1);
+                    line->setPen(QPen(Qt::red, 1, k == 1 ? Qt::SolidLine : Qt::DashLine));
+                }
+            } else {
+                // 联合分布二维直方图
+                ya->setRange(ranges[row]);
+                QCPColorMap* map = new QCPColorMap(xa, ya);
+                map->data()->setSize(bins, bins);
+                map->data()->setRange(ranges[col], ranges[row]);
+                map->data()->fill(0.0);
+                for (int s = 0; s < n; ++s) {
+                    int ix = 0, iy = 0;
+                    map->data()->coordToCell(coords[col][s], coords[row][s], &ix, &iy);
+                    ix = qBound(0, ix, bins - 1); iy = qBound(0, iy, bins - 1);
+                    map->data()->setCell(ix, iy, map->data()->cell(ix, iy) + 1.0);
+                }
+                map->setGradient(gradient);
+                map->setInterpolate(false);
+                map->rescaleDataRange(true);
+            }
+        }
+    }
+    m_plot->replot();
+}
+
+void FittingMcmcDialog::onApply()
+{
+    const QList<McmcParamSummary>& list = m_sampler->summaries();
+    if (list.isEmpty()) return;
+    for (FitParameter& fp : m_params) {
+        for (const McmcParamSummary& s : list) if (fp.name == s.name) fp.value = s.median;
+    }
+    accept();
+}
+
+void FittingMcmcDialog::reject()
+{
+    m_sampler->cancel();
+    QDialog::reject();
+}
+
+void FittingMcmcDialog::updateButtons()
+{
+    bool running = m_sampler->isRunning();
+    ui->groupSettings->setEnabled(!running);
+    ui->btnRun->setEnabled(!running);
+    ui->btnStop->setEnabled(running);
+    ui->btnApply->setEnabled(!running && !m_sampler->summaries().isEmpty());
+}
+
+QList<FitParameter> FittingMcmcDialog::getUpdatedParams() const
+{
+    return m_params;
+}
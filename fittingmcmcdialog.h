@@ -0,0 +1,60 @@
+#ifndef FITTINGMCMCDIALOG_H
+#define FITTINGMCMCDIALOG_H
+
+#include <QDialog>
+#include "fittingmcmc.h"
+
+namespace Ui {
+class FittingMcmcDialog;
+}
+
+class QCustomPlot;
+
+// ===========================================================================
+// 类名：FittingMcmcDialog
+// 作用：拟合参数后验采样弹窗
+// 功能：
+// 1. 设置步行者数量、步数、预烧、抽稀、代理加速与链文件，后台运行 MCMC 采样
+// 2. 表格显示各拟合参数的后验中位数与 68% / 95% 可信区间
+// 3. 角图 (corner plot)：对角线为边缘分布直方图，下三角为两两参数的联合分布密度
+// 4. 可将后验中位数写回参数表
+// ===========================================================================
+
+class FittingMcmcDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    FittingMcmcDialog(ModelManager* modelManager, ModelManager::ModelType modelType, const QList<FitParameter>& params,
+                      const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                      double weight, QWidget *parent = nullptr);
+    ~FittingMcmcDialog();
+
+    // 采用后验中位数后的参数列表
+    QList<FitParameter> getUpdatedParams() const;
+
+protected:
+    void reject() override;
+
+private slots:
+    void onRun();
+    void onStop();
+    void onBrowseChainFile();
+    void onProgress(int step, int totalSteps, double acceptance);
+    void onFinished();
+    void onApply();
+
+private:
+    Ui::FittingMcmcDialog *ui;
+    FittingMcmcSampler* m_sampler;
+    ModelManager::ModelType m_modelType;
+    QList<FitParameter> m_params;
+    double m_weight;
+    QCustomPlot* m_plot;
+
+    void updateSummaryTable();
+    void buildCornerPlot();
+    void updateButtons();
+};
+
+#endif // FITTINGMCMCDIALOG_H
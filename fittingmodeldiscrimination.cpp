@@ -0,0 +1,270 @@
+/*
+ * fittingmodeldiscrimination.cpp
+ * 文件作用：自动模型识别（多模型拟合与排序）实现文件
+ * 功能描述：
+ * 1. 三个恒定井储模型 (Model_2/4/6) 立即并行提交；
+ *    每个完成后，以其结果为初值提交对应的变井储模型 (Model_1/3/5)
+ * 2. 引擎最终残差（有完整观测数据时为验证残差）用于计算 AIC、BIC 与 Durbin-Watson 统计量
+ */
+
+#include "fittingmodeldiscrimination.h"
+#include "fittingjobscheduler.h"
+
+#include <QDebug>
+#include <cmath>
+#include <algorithm>
+
+QString ModelCandidateResult::stateText() const
+{
+    switch (state) {
+    case Waiting: return "等待";
+    case Running: return "拟合中";
+    case Finished: return "已完成";
+    case Cancelled: return "已取消";
+    case Failed: return "失败";
+    }
+    return QString();
+}
+
+FittingModelDiscrimination::FittingModelDiscrimination(ModelManager* modelManager, QObject* parent)
+    : QObject(parent)
+    , m_modelManager(modelManager)
+    , m_weight(0.5)
+    , m_priority(0)
+    , m_cancelled(false)
+{
+    connect(FittingJobScheduler::instance(), &FittingJobScheduler::jobFinished, this, &FittingModelDiscrimination::onJobFinished);
+}
+
+FittingModelDiscrimination::~FittingModelDiscrimination()
+{
+    // 引擎由本对象持有，销毁前必须等待所有任务退出
+    disconnect(FittingJobScheduler::instance(), nullptr, this, nullptr);
+    for (const ModelCandidateResult& r : m_results)
+        if (r.jobId >= 0) FittingJobScheduler::instance()->cancelAndWait(r.jobId);
+}
+
+void FittingModelDiscrimination::setObservedData(const QVector<double>& fitT, const QVector<double>& fitP, const QVector<double>& fitD,
+                                                 const QVector<double>& valT, const QVector<double>& valP, const QVector<double>& valD)
+{
+    m_fitT = fitT; m_fitP = fitP; m_fitD = fitD;
+    m_valT = valT; m_valP = valP; m_valD = valD;
+}
+
+void FittingModelDiscrimination::setEngineSetup(EngineSetup setup)
+{
+    m_engineSetup = setup;
+}
+
+ModelManager::ModelType FittingModelDiscrimination::coreModel(ModelManager::ModelType type)
+{
+    // Model_1/3/5 (变井储) 与 Model_2/4/6 (恒定井储) 两两共享储层与边界
+    int index = static_cast<int>(type);
+    return (index % 2 == 0) ? static_cast<ModelManager::ModelType>(index + 1) : type;
+}
+
+QList<FitParameter> FittingModelDiscrimination::buildCandidateParams(ModelManager* modelManager, ModelManager::ModelType type,
+                                                                     const QList<FitParameter>& baseParams)
+{
+    QList<FitParameter> result;
+    if (!modelManager) return result;
+
+    QMap<QString, FitParameter> baseMap;
+    for (const FitParameter& p : baseParams) baseMap.insert(p.name, p);
+
+    const bool constantStorage = (coreModel(type) == type);
+    QMap<QString, double> defaults = modelManager->getDefaultParameters(type);
+    for (auto it = defaults.cbegin(); it != defaults.cend(); ++it) {
+        const QString& name = it.key();
+        const bool storageParam = (name == "cD" || name == "S");
+
+        FitParameter p;
+        // 公共参数沿用当前分析页的值、范围与拟合标记；变井储参数为 0 时（来自恒定井储模型）改用默认值
+        if (baseMap.contains(name) && !(storageParam && !constantStorage && baseMap[name].value <= 0.0)) {
+            p = baseMap[name];
+        } else {
+            p.name = name;
+            p.value = it.value();
+            if (p.value > 0) { p.min = p.value * 0.01; p.max = p.value * 100.0; }
+            else { p.min = 0.0; p.max = 100.0; }
+            QString symbol, uniSym, unit;
+            FittingParameterChart::getParamDisplayInfo(p.name, p.displayName, symbol, uniSym, unit);
+            p.isVisible = true;
+            // 模型特有参数（井储、表皮、边界距离）是区分模型的关键，默认参与拟合
+            p.isFit = storageParam || name == "reD";
+        }
+
+        if (storageParam && constantStorage) { p.value = 0.0; p.isFit = false; }
+        result.append(p);
+    }
+    return result;
+}
+
+void FittingModelDiscrimination::start(const QList<FitParameter>& baseParams, double weight, int priority)
+{
+    if (isRunning() || !m_modelManager) return;
+
+    m_weight = weight;
+    m_priority = priority;
+    m_cancelled = false;
+
+    qDeleteAll(m_engines);
+    m_engines.clear();
+    m_results.clear();
+    m_lastParams.clear();
+
+    const int modelCount = static_cast<int>(ModelManager::Model_6) + 1;
+    for (int i = 0; i < modelCount; ++i) {
+        ModelCandidateResult r;
+        r.type = static_cast<ModelManager::ModelType>(i);
+        r.params = buildCandidateParams(m_modelManager, r.type, baseParams);
+        m_results.append(r);
+        m_engines.append(nullptr);
+        m_lastParams.append(QMap<QString, double>());
+    }
+
+    // 先提交恒定井储模型，变井储模型等待其结果作为初值
+    for (int i = 0; i < modelCount; ++i)
+        if (coreModel(m_results[i].type) == m_results[i].type) launch(i);
+}
+
+void FittingModelDiscrimination::launch(int index, const QMap<QString, double>& warmStart)
+{
+    ModelCandidateResult& r = m_results[index];
+
+    // 同核心模型的拟合结果作为公共参数初值（井储与表皮除外）
+    for (FitParameter& p : r.params) {
+        if (p.name == "cD" || p.name == "S" || !warmStart.contains(p.name)) continue;
+        p.value = qBound(p.min, warmStart[p.name], p.max);
+    }
+
+    FittingEngine* engine = new FittingEngine(m_modelManager, this);
+    engine->setObservedData(m_fitT, m_fitP, m_fitD);
+    engine->setValidationData(m_valT, m_valP, m_valD);
+    if (m_engineSetup) m_engineSetup(engine);
+    m_engines[index] = engine;
+
+    connect(engine, &FittingEngine::iterationUpdated, this, [this, index](FittingSnapshotPtr snapshot) {
+        if (snapshot) m_lastParams[index] = snapshot->params;
+    });
+    connect(engine, &FittingEngine::progressChanged, this, [this, index](int progress) {
+        m_results[index].progress = progress;
+        emit candidateUpdated(index);
+    });
+
+    QString jobName = "模型识别: " + ModelManager::getModelTypeName(r.type);
+    r.state = ModelCandidateResult::Running;
+    r.jobId = FittingJobScheduler::instance()->submit(jobName, engine, r.type, r.params, m_weight, m_priority);
+    emit candidateUpdated(index);
+}
+
+void FittingModelDiscrimination::onJobFinished(int jobId)
+{
+    int index = -1;
+    for (int i = 0; i < m_results.size(); ++i) if (m_results[i].jobId == jobId) { index = i; break; }
+    if (index < 0) return;
+
+    ModelCandidateResult& r = m_results[index];
+    r.jobId = -1;
+    bool cancelled = m_cancelled || FittingJobScheduler::instance()->job(jobId).state == FittingJobInfo::Cancelled;
+    if (cancelled) r.state = ModelCandidateResult::Cancelled;
+    else scoreCandidate(index);
+    emit candidateUpdated(index);
+
+    // 恒定井储模型完成后提交对应的变井储模型
+    if (coreModel(r.type) == r.type) {
+        for (int i = 0; i < m_results.size(); ++i) {
+            if (i == index || coreModel(m_results[i].type) != r.type || m_results[i].state != ModelCandidateResult::Waiting) continue;
+            if (m_cancelled) { m_results[i].state = ModelCandidateResult::Cancelled; emit candidateUpdated(i); }
+            else launch(i, r.state == ModelCandidateResult::Finished ? m_lastParams[index] : QMap<QString, double>());
+        }
+    }
+
+    if (!isRunning()) {
+        rankCandidates();
+        emit finished();
+    }
+}
+
+void FittingModelDiscrimination::scoreCandidate(int index)
+{
+    ModelCandidateResult& r = m_results[index];
+    FittingEngine* engine = m_engines[index];
+
+    // 更新为拟合结果
+    const QMap<QString, double>& fitted = m_lastParams[index];
+    r.k = 0;
+    for (FitParameter& p : r.params) {
+        if (fitted.contains(p.name)) p.value = fitted[p.name];
+        if (p.isFit) r.k++;
+    }
+
+    QVector<double> res = engine ? engine->getFinalResiduals() : QVector<double>();
+    QVector<char> states = engine ? engine->getFinalResidualStates() : QVector<char>();
+    if (states.size() != res.size()) { r.state = ModelCandidateResult::Failed; return; }
+
+    // 只统计观测值与理论值均有效的残差；观测无效点的残差被置零，不参与计数
+    double sse = 0.0, sum = 0.0;
+    int nInvalid = 0;
+    r.n = 0;
+    for (int i = 0; i < res.size(); ++i) {
+        if (states[i] == FittingResidualKernel::ModelInvalid) { ++nInvalid; continue; }
+        if (states[i] != FittingResidualKernel::Valid) continue;
+        sse += res[i] * res[i]; sum += res[i];
+        ++r.n;
+    }
+    if (r.n <= r.k) { r.state = ModelCandidateResult::Failed; return; }
+
+    r.mse = qMax(sse / r.n, 1e-300);
+    r.aic = r.n * std::log(r.mse) + 2.0 * r.k;
+    r.bic = r.n * std::log(r.mse) + r.k * std::log(double(r.n));
+    // 理论值无效的点按一个对数周期的偏差计入似然，避免模型靠产生无效值回避拟合
+    if (nInvalid > 0) {
+        const double c = std::log(10.0);
+        double penalty = nInvalid * (std::log(r.mse) + c * c / r.mse);
+        r.aic += penalty;
+        r.bic += penalty;
+    }
+    r.bias = sum / r.n;
+
+    // Durbin-Watson：压力与导数两段分别计算相邻有效残差的差分，避免跨段连接
+    const int nPressure = engine->getFinalPressureCount();
+    double num = 0.0;
+    for (int i = 1; i < res.size(); ++i) {
+        if (i == nPressure) continue;
+        if (states[i] != FittingResidualKernel::Valid || states[i - 1] != FittingResidualKernel::Valid) continue;
+        double diff = res[i] - res[i - 1];
+        num += diff * diff;
+    }
+    r.durbinWatson = sse > 0 ? num / sse : 0.0;
+    r.state = ModelCandidateResult::Finished;
+}
+
+void FittingModelDiscrimination::rankCandidates()
+{
+    QVector<int> order;
+    for (int i = 0; i < m_results.size(); ++i) {
+        m_results[i].rank = 0;
+        if (m_results[i].state == ModelCandidateResult::Finished) order.append(i);
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) { return m_results[a].aic < m_results[b].aic; });
+    for (int i = 0; i < order.size(); ++i) {
+        m_results[order[i]].rank = i + 1;
+        emit candidateUpdated(order[i]);
+    }
+}
+
+void FittingModelDiscrimination::cancel()
+{
+    m_cancelled = true;
+    for (int i = 0; i < m_results.size(); ++i) {
+        if (m_results[i].jobId >= 0) FittingJobScheduler::instance()->cancel(m_results[i].jobId);
+    }
+}
+
+bool FittingModelDiscrimination::isRunning() const
+{
+    for (const ModelCandidateResult& r : m_results)
+        if (r.state == ModelCandidateResult::Running || r.state == ModelCandidateResult::Waiting) return true;
+    return false;
+}
@@ -0,0 +1,110 @@
+/*
+ * fittingmodeldiscrimination.h
+ * 文件作用：自动模型识别（多模型拟合与排序）头文件
+ * 功能描述：
+ * 1. 对 ModelManager 中全部模型类型 (Model_1 ~ Model_6) 发起拟合，任务统一交给 FittingJobScheduler 并行执行
+ * 2. 共享同一储层核心的模型成对处理：先拟合恒定井储变体 (cD = S = 0)，
+ *    其结果作为对应变井储变体的初值，变井储变体只需在此基础上补充拟合井储与表皮
+ * 3. 按 AIC / BIC 信息准则对拟合结果排序，并给出残差诊断（Durbin-Watson 统计量、平均偏差）
+ */
+
+#ifndef FITTINGMODELDISCRIMINATION_H
+#define FITTINGMODELDISCRIMINATION_H
+
+#include <QObject>
+#include <QVector>
+#include <QList>
+#include <QMap>
+#include <functional>
+#include "fittingengine.h"
+
+// 单个候选模型的拟合与评价结果
+struct ModelCandidateResult {
+    enum State {
+        Waiting,    // 等待同核心模型的结果
+        Running,    // 已提交拟合
+        Finished,   // 拟合完成
+        Cancelled,  // 已取消
+        Failed      // 无有效残差
+    };
+
+    ModelManager::ModelType type;
+    State state;
+    int jobId;
+    int progress;
+    QList<FitParameter> params;     // 拟合参数（完成后为拟合结果）
+
+    int k;                  // 参与拟合的参数个数
+    int n;                  // 有效残差个数（观测值与理论值均有效）
+    double mse;             // 均方误差
+    double aic;             // Akaike 信息准则: n ln(MSE) + 2k
+    double bic;             // Bayesian 信息准则: n ln(MSE) + k ln(n)
+    double durbinWatson;    // 残差自相关诊断（接近 2 表示残差无明显系统性）
+    double bias;            // 残差平均值（系统性偏差）
+    int rank;               // 按 AIC 的排名（从 1 开始，未完成为 0）
+
+    ModelCandidateResult() : type(ModelManager::Model_1), state(Waiting), jobId(-1), progress(0),
+        k(0), n(0), mse(0.0), aic(0.0), bic(0.0), durbinWatson(0.0), bias(0.0), rank(0) {}
+
+    QString stateText() const;
+};
+
+class FittingModelDiscrimination : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 引擎配置回调：由界面按当前设置配置算法、渐进方案、边界处理等
+    using EngineSetup = std::function<void(FittingEngine*)>;
+
+    explicit FittingModelDiscrimination(ModelManager* modelManager, QObject* parent = nullptr);
+    ~FittingModelDiscrimination();
+
+    // 拟合数据（抽稀后）与评价用的完整观测数据
+    void setObservedData(const QVector<double>& fitT, const QVector<double>& fitP, const QVector<double>& fitD,
+                         const QVector<double>& valT, const QVector<double>& valP, const QVector<double>& valD);
+    void setEngineSetup(EngineSetup setup);
+
+    // 以当前分析页的参数设置为基础启动全部候选模型的拟合
+    void start(const QList<FitParameter>& baseParams, double weight, int priority = 0);
+    // 取消全部尚未结束的拟合
+    void cancel();
+    bool isRunning() const;
+
+    const QVector<ModelCandidateResult>& results() const { return m_results; }
+
+    // 由基础参数构造指定模型的拟合参数：公共参数沿用基础设置，模型特有参数使用默认值并参与拟合
+    static QList<FitParameter> buildCandidateParams(ModelManager* modelManager, ModelManager::ModelType type,
+                                                    const QList<FitParameter>& baseParams);
+    // 与指定模型共享储层核心的恒定井储模型（恒定井储模型返回自身）
+    static ModelManager::ModelType coreModel(ModelManager::ModelType type);
+
+signals:
+    void candidateUpdated(int index);
+    void finished();
+
+private slots:
+    void onJobFinished(int jobId);
+
+private:
+    // 提交第 index 个候选模型的拟合，warmStart 非空时以其中的公共参数为初值
+    void launch(int index, const QMap<QString, double>& warmStart = QMap<QString, double>());
+    // 根据拟合结果计算信息准则和残差诊断
+    void scoreCandidate(int index);
+    void rankCandidates();
+
+    ModelManager* m_modelManager;
+    EngineSetup m_engineSetup;
+
+    QVector<double> m_fitT, m_fitP, m_fitD;
+    QVector<double> m_valT, m_valP, m_valD;
+
+    QVector<ModelCandidateResult> m_results;
+    QVector<FittingEngine*> m_engines;
+    QVector<QMap<QString, double>> m_lastParams;    // 各引擎最近一次发布的参数
+    double m_weight;
+    int m_priority;
+    bool m_cancelled;
+};
+
+#endif // FITTINGMODELDISCRIMINATION_H
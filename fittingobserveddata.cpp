@@ -1,5 +1,6 @@
 #include "fittingobserveddata.h"
-#include "pressurederivativecalculator.h"
+#include "derivativeengine.h"
+#include "settingswidget.h"
 
 #include <QFileDialog>
 #include <QFile>
@@ -13,6 +14,8 @@
 #include <QHeaderView>
 #include <QRegularExpression>
 #include <cmath>
+#include <algorithm>
+#include <limits>
 
 // ===========================================================================
 // FittingDataLoadDialog 实现
@@ -50,7 +53,7 @@ FittingDataLoadDialog::FittingDataLoadDialog(const QList<QStringList>& previewDa
 
     grid->addWidget(new QLabel("时间列 *:",this), 0, 0); m_comboTime = new QComboBox(this); m_comboTime->addItems(opts); grid->addWidget(m_comboTime, 0, 1);
     grid->addWidget(new QLabel("压力列:",this), 0, 2); m_comboPressure = new QComboBox(this); m_comboPressure->addItem("不导入",-1); m_comboPressure->addItems(opts); if(opts.size()>1) m_comboPressure->setCurrentIndex(2); grid->addWidget(m_comboPressure, 0, 3);
-    grid->addWidget(new QLabel("导数列:",this), 1, 0); m_comboDeriv = new QComboBox(this); m_comboDeriv->addItem("自动计算 (Bourdet)",-1); m_comboDeriv->addItems(opts); grid->addWidget(m_comboDeriv, 1, 1);
+    grid->addWidget(new QLabel("导数列:",this), 1, 0); m_comboDeriv = new QComboBox(this); m_comboDeriv->addItem("自动计算 (按系统设置)",-1); m_comboDeriv->addItems(opts); grid->addWidget(m_comboDeriv, 1, 1);
     grid->addWidget(new QLabel("跳过首行数:",this), 1, 2); m_comboSkipRows = new QComboBox(this); for(int i=0;i<=20;++i) m_comboSkipRows->addItem(QString::number(i),i); m_comboSkipRows->setCurrentIndex(1); grid->addWidget(m_comboSkipRows, 1, 3);
     grid->addWidget(new QLabel("压力数据类型:",this), 2, 0); m_comboPressureType = new QComboBox(this); m_comboPressureType->addItem("原始压力 (自动计算压差 |P-Pi|)", 0); m_comboPressureType->addItem("压差数据 (直接使用 ΔP)", 1); grid->addWidget(m_comboPressureType, 2, 1, 1, 3);
 
@@ -133,7 +136,7 @@ bool FittingObservedData::loadDataFromFile(QWidget* parentWidget)
         }
     }
 
-    // 处理导数：如果文件中指定了导数列，直接读取；否则计算 Bourdet 导数
+    // 处理导数：如果文件中指定了导数列，直接读取；否则按系统设置中的导数算法与 L-Spacing 计算
     if (dCol >= 0) {
         for(int i=dlg.getSkipRows(); i<data.size(); ++i) {
             if(tCol<data[i].size() && data[i][tCol].toDouble() > 0 && dCol<data[i].size()) {
@@ -141,7 +144,8 @@ bool FittingObservedData::loadDataFromFile(QWidget* parentWidget)
             }
         }
     } else {
-        m_obsDerivative = PressureDerivativeCalculator::calculateBourdetDerivative(m_obsTime, m_obsPressure, 0.15);
+        m_obsDerivative = DerivativeEngine::compute(m_obsTime, m_obsPressure, DerivativeEngine::Algorithm(SettingsWidget::derivativeAlgorithm()),
+                                                    SettingsWidget::derivativeLSpacing());
     }
 
     return true;
@@ -150,3 +154,98 @@ bool FittingObservedData::loadDataFromFile(QWidget* parentWidget)
 QVector<double> FittingObservedData::getTime() const { return m_obsTime; }
 QVector<double> FittingObservedData::getPressure() const { return m_obsPressure; }
 QVector<double> FittingObservedData::getDerivative() const { return m_obsDerivative; }
+
+// 求中值（按值传参，内部使用 nth_element 部分排序）
+static double medianOfValues(QVector<double> v)
+{
+    if (v.isEmpty()) return 0.0;
+    int mid = v.size() / 2;
+    std::nth_element(v.begin(), v.begin() + mid, v.end());
+    double m = v[mid];
+    if (v.size() % 2 == 0) {
+        double lower = *std::max_element(v.begin(), v.begin() + mid);
+        m = 0.5 * (m + lower);
+    }
+    return m;
+}
+
+void FittingObservedData::decimateLogTime(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                                          int pointsPerDecade, DecimationMethod method,
+                                          QVector<double>& outT, QVector<double>& outP, QVector<double>& outD,
+                                          double outlierThreshold)
+{
+    outT.clear(); outP.clear(); outD.clear();
+    int n = qMin(t.size(), p.size());
+    auto derivAt = [&d](int i) { return i < d.size() ? d[i] : 0.0; };
+
+    // 1. 确定对数时间范围
+    double logMin = std::numeric_limits<double>::max();
+    double logMax = -std::numeric_limits<double>::max();
+    for (int i = 0; i < n; ++i) {
+        if (t[i] <= 0) continue;
+        double lt = log10(t[i]);
+        logMin = qMin(logMin, lt);
+        logMax = qMax(logMax, lt);
+    }
+
+    if (pointsPerDecade <= 0 || logMin > logMax) {
+        outT = t.mid(0, n); outP = p.mid(0, n);
+        for (int i = 0; i < n; ++i) outD.append(derivAt(i));
+        return;
+    }
+
+    // 2. 按对数时间分箱（输出天然按时间升序排列）
+    int nBins = int(std::floor((logMax - logMin) * pointsPerDecade)) + 1;
+    QVector<QVector<int>> bins(nBins);
+    for (int i = 0; i < n; ++i) {
+        if (t[i] <= 0) continue;
+        int b = qMin(nBins - 1, int((log10(t[i]) - logMin) * pointsPerDecade));
+        bins[b].append(i);
+    }
+
+    outT.reserve(nBins); outP.reserve(nBins); outD.reserve(nBins);
+    QVector<double> pv, dv, keptLogT, keptP, keptD;
+    for (const QVector<int>& bin : bins) {
+        if (bin.isEmpty()) continue;
+        if (bin.size() == 1) {
+            int i = bin.first();
+            outT.append(t[i]); outP.append(p[i]); outD.append(derivAt(i));
+            continue;
+        }
+
+        // 3. MAD 离群点剔除（1.4826 * MAD 为正态分布标准差的稳健估计）
+        pv.clear(); dv.clear();
+        for (int i : bin) { pv.append(p[i]); dv.append(derivAt(i)); }
+        double medP = medianOfValues(pv);
+        double medD = medianOfValues(dv);
+        QVector<double> devP, devD;
+        for (double v : pv) devP.append(std::abs(v - medP));
+        for (double v : dv) devD.append(std::abs(v - medD));
+        double madP = 1.4826 * medianOfValues(devP);
+        double madD = 1.4826 * medianOfValues(devD);
+
+        keptLogT.clear(); keptP.clear(); keptD.clear();
+        for (int i : bin) {
+            bool okP = (madP <= 0) || std::abs(p[i] - medP) <= outlierThreshold * madP;
+            bool okD = (madD <= 0) || std::abs(derivAt(i) - medD) <= outlierThreshold * madD;
+            if (okP && okD) { keptLogT.append(log10(t[i])); keptP.append(p[i]); keptD.append(derivAt(i)); }
+        }
+        if (keptP.isEmpty()) {
+            for (int i : bin) { keptLogT.append(log10(t[i])); keptP.append(p[i]); keptD.append(derivAt(i)); }
+        }
+
+        // 4. 代表点：时间取对数均值，压力/导数取中值或均值
+        double sumLogT = 0.0;
+        for (double v : keptLogT) sumLogT += v;
+        outT.append(pow(10.0, sumLogT / keptLogT.size()));
+        if (method == DecimationMethod::Median) {
+            outP.append(medianOfValues(keptP));
+            outD.append(medianOfValues(keptD));
+        } else {
+            double sp = 0.0, sd = 0.0;
+            for (int k = 0; k < keptP.size(); ++k) { sp += keptP[k]; sd += keptD[k]; }
+            outP.append(sp / keptP.size());
+            outD.append(sd / keptD.size());
+        }
+    }
+}
@@ -7,6 +7,12 @@
 #include <QTableWidget>
 #include <QComboBox>
 
+// 对数时间抽稀的区间代表值计算方法
+enum class DecimationMethod {
+    Median = 0, // 区间中值（抗噪声能力强）
+    Mean = 1    // 区间均值
+};
+
 // ===========================================================================
 // 数据加载对话框 (从 fittingwidget.h 移动至此)
 // ===========================================================================
@@ -43,6 +49,14 @@ public:
     QVector<double> getPressure() const;
     QVector<double> getDerivative() const;
 
+    // 对数时间抽稀：将观测数据压缩为每个对数周期 pointsPerDecade 个点
+    // 每个区间先按中值绝对偏差 (MAD) 剔除离群点，再取中值或均值作为代表点
+    // pointsPerDecade <= 0 时原样输出
+    static void decimateLogTime(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                                int pointsPerDecade, DecimationMethod method,
+                                QVector<double>& outT, QVector<double>& outP, QVector<double>& outD,
+                                double outlierThreshold = 3.0);
+
 private:
     QVector<double> m_obsTime;
     QVector<double> m_obsPressure;
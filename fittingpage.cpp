@@ -2,6 +2,7 @@
 #include "ui_fittingpage.h" // 【关键】必须包含这个由 uic 自动生成的头文件
 #include "wt_fittingwidget.h" // 【关键】引用改名后的拟合控件头文件
 #include "modelparameter.h"
+#include "fittingjobdashboard.h"
 #include <QInputDialog>
 #include <QMessageBox>
 #include <QJsonArray>
@@ -57,6 +58,7 @@ FittingWidget* FittingPage::createNewTab(const QString &name, const QJsonObject
     FittingWidget* w = new FittingWidget(this);
     if(m_modelManager) w->setModelManager(m_modelManager);
 
+    w->setAnalysisName(name);
     connect(w, &FittingWidget::sigRequestSave, this, &FittingPage::onChildRequestSave);
 
     int index = ui->tabWidget->addTab(w, name);
@@ -126,6 +128,8 @@ void FittingPage::on_btnRenameAnalysis_clicked()
     QString newName = QInputDialog::getText(this, "重命名", "请输入新的分析名称:", QLineEdit::Normal, oldName, &ok);
     if(ok && !newName.isEmpty()) {
         ui->tabWidget->setTabText(idx, newName);
+        FittingWidget* w = qobject_cast<FittingWidget*>(ui->tabWidget->widget(idx));
+        if(w) w->setAnalysisName(newName);
     }
 }
 
@@ -146,6 +150,30 @@ void FittingPage::on_btnDeleteAnalysis_clicked()
     }
 }
 
+void FittingPage::on_btnRunAll_clicked()
+{
+    // 批量拟合使用较低优先级，单页手动拟合可插队；结束后不逐页弹窗
+    int submitted = 0;
+    for(int i = 0; i < ui->tabWidget->count(); ++i) {
+        FittingWidget* w = qobject_cast<FittingWidget*>(ui->tabWidget->widget(i));
+        if(w && w->startFit(0, true)) submitted++;
+    }
+
+    if(submitted == 0) {
+        QMessageBox::information(this, "提示", "没有可提交的分析页（未加载观测数据或正在拟合）。");
+        return;
+    }
+    on_btnJobDashboard_clicked();
+}
+
+void FittingPage::on_btnJobDashboard_clicked()
+{
+    if(!m_dashboard) m_dashboard = new FittingJobDashboard(this);
+    m_dashboard->show();
+    m_dashboard->raise();
+    m_dashboard->activateWindow();
+}
+
 void FittingPage::saveAllFittingStates()
 {
     QJsonArray analysesArray;
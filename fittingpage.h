@@ -4,10 +4,12 @@
 #include <QWidget>
 #include <QJsonObject>
 #include <QTabWidget> // 显式包含，防止报错
+#include <QPointer>
 #include "modelmanager.h"
 
 // 前置声明
 class FittingWidget;
+class FittingJobDashboard;
 
 namespace Ui {
 class FittingPage;
@@ -40,11 +42,14 @@ private slots:
     void on_btnNewAnalysis_clicked();
     void on_btnRenameAnalysis_clicked();
     void on_btnDeleteAnalysis_clicked();
+    void on_btnRunAll_clicked();        // 将所有分析页提交到拟合任务队列
+    void on_btnJobDashboard_clicked();  // 打开任务监控面板
     void onChildRequestSave();
 
 private:
     Ui::FittingPage *ui;
     ModelManager* m_modelManager;
+    QPointer<FittingJobDashboard> m_dashboard;
 
     // 内部函数：创建新页签
     FittingWidget* createNewTab(const QString& name, const QJsonObject& initData = QJsonObject());
@@ -0,0 +1,60 @@
+/*
+ * fittingparametertransform.h
+ * 文件作用：拟合参数变换与边界处理头文件
+ * 功能描述：
+ * 1. 根据参数上下限（而不是参数名）为每个拟合参数选择内部坐标：
+ *    - 正值且跨度不小于一个数量级：log10 变换
+ *    - 其余：线性
+ * 2. 两种边界处理方式：
+ *    - 投影约束 (Projected)：内部坐标仍受上下限约束，LM 采用有效集 + 投影步长
+ *    - Logit 变换 (Logit)：有界参数映射到无界内部坐标 (logit / log-logit)，LM 无需处理边界
+ */
+
+#ifndef FITTINGPARAMETERTRANSFORM_H
+#define FITTINGPARAMETERTRANSFORM_H
+
+#include "fittingparameterchart.h"
+
+// 边界处理方式
+enum class BoundHandling {
+    Projected = 0,  // 有效集投影
+    Logit = 1       // logit 变换
+};
+
+class FittingParameterTransform
+{
+public:
+    enum Type {
+        Linear,     // u = v
+        Log,        // u = log10(v)
+        Logit,      // u = logit((v - min) / (max - min))
+        LogLogit    // u = logit((log10 v - log10 min) / (log10 max - log10 min))
+    };
+
+    FittingParameterTransform();
+
+    // 根据参数上下限创建变换
+    static FittingParameterTransform forParameter(const FitParameter& p, BoundHandling mode);
+
+    Type type() const { return m_type; }
+
+    // 外部值 <-> 内部坐标
+    double toInternal(double v) const;
+    double toExternal(double u) const;
+
+    // 内部坐标的可行域（logit 类变换为无界）
+    double internalLower() const;
+    double internalUpper() const;
+    // 将内部坐标投影到可行域
+    double project(double u) const;
+
+    // 雅可比矩阵有限差分步长（内部坐标单位）
+    double finiteDifferenceStep() const;
+
+private:
+    Type m_type;
+    double m_min;
+    double m_max;
+};
+
+#endif // FITTINGPARAMETERTRANSFORM_H
@@ -0,0 +1,127 @@
+/*
+ * fittingresidualkernel.cpp
+ * 文件作用：拟合残差计算核心实现文件
+ * 功能描述：
+ * 1. 观测对数与权重在 prepare 中一次性计算
+ * 2. evaluate / sumSquares 内层循环只含一次对数运算与一次比较，便于编译器展开与向量化
+ */
+
+#include "fittingresidualkernel.h"
+#include <cmath>
+
+namespace {
+const double kMinValue = 1e-10;   // 有效点判据
+}
+
+FittingResidualKernel::FittingResidualKernel() : m_weight(0.5) {}
+
+void FittingResidualKernel::clear()
+{
+    m_logP.clear(); m_logD.clear();
+    m_wP.clear(); m_wD.clear();
+    m_validP.clear(); m_validD.clear();
+}
+
+void FittingResidualKernel::prepare(const QVector<double>& obsP, const QVector<double>& obsD, double weight)
+{
+    m_weight = weight;
+    const double wp = weight;
+    const double wd = 1.0 - weight;
+    const int nP = obsP.size();
+    const int nD = qMin(obsD.size(), nP);
+
+    m_logP.resize(nP); m_wP.resize(nP); m_validP.clear(); m_validP.reserve(nP);
+    for (int i = 0; i < nP; ++i) {
+        bool valid = obsP[i] > kMinValue;
+        m_logP[i] = valid ? std::log(obsP[i]) : 0.0;
+        m_wP[i] = valid ? wp : 0.0;
+        if (valid) m_validP.append(i);
+    }
+
+    m_logD.resize(nD); m_wD.resize(nD); m_validD.clear(); m_validD.reserve(nD);
+    for (int i = 0; i < nD; ++i) {
+        bool valid = obsD[i] > kMinValue;
+        m_logD[i] = valid ? std::log(obsD[i]) : 0.0;
+        m_wD[i] = valid ? wd : 0.0;
+        if (valid) m_validD.append(i);
+    }
+}
+
+void FittingResidualKernel::evaluate(const QVector<double>& pCal, const QVector<double>& dCal, QVector<double>& out) const
+{
+    const int nP = qMin(m_logP.size(), pCal.size());
+    const int nD = qMin(qMin(m_logD.size(), dCal.size()), nP);
+    out.resize(nP + nD);
+    if (nP + nD == 0) return;
+
+    double* r = out.data();
+    const double* lp = m_logP.constData();
+    const double* wp = m_wP.constData();
+    const double* cp = pCal.constData();
+    for (int i = 0; i < nP; ++i) r[i] = cp[i] > kMinValue ? (lp[i] - std::log(cp[i])) * wp[i] : 0.0;
+
+    double* rd = r + nP;
+    const double* ld = m_logD.constData();
+    const double* wd = m_wD.constData();
+    const double* cd = dCal.constData();
+    for (int i = 0; i < nD; ++i) rd[i] = cd[i] > kMinValue ? (ld[i] - std::log(cd[i])) * wd[i] : 0.0;
+}
+
+double FittingResidualKernel::sumSquares(const QVector<double>& pCal, const QVector<double>& dCal, int* count) const
+{
+    const int nP = qMin(m_logP.size(), pCal.size());
+    const int nD = qMin(qMin(m_logD.size(), dCal.size()), nP);
+    if (count) *count = nP + nD;
+
+    double sse = 0.0;
+    const double* cp = pCal.constData();
+    for (int i = 0; i < nP; ++i) {
+        double v = cp[i] > kMinValue ? (m_logP[i] - std::log(cp[i])) * m_wP[i] : 0.0;
+        sse += v * v;
+    }
+    const double* cd = dCal.constData();
+    for (int i = 0; i < nD; ++i) {
+        double v = cd[i] > kMinValue ? (m_logD[i] - std::log(cd[i])) * m_wD[i] : 0.0;
+        sse += v * v;
+    }
+    return sse;
+}
+
+void FittingResidualKernel::pointStates(const QVector<double>& pCal, const QVector<double>& dCal, QVector<char>& out) const
+{
+    const int nP = qMin(m_logP.size(), pCal.size());
+    const int nD = qMin(qMin(m_logD.size(), dCal.size()), nP);
+    out.fill(Masked, nP + nD);
+    for (int i : m_validP) {
+        if (i >= nP) break;
+        out[i] = pCal[i] > kMinValue ? Valid : ModelInvalid;
+    }
+    for (int i : m_validD) {
+        if (i >= nD) break;
+        out[nP + i] = dCal[i] > kMinValue ? Valid : ModelInvalid;
+    }
+}
+
+double FittingResidualKernel::optimalLogShift(const QVector<double>& pCal, const QVector<double>& dCal) const
+{
+    const int nP = qMin(m_logP.size(), pCal.size());
+    const int nD = qMin(qMin(m_logD.size(), dCal.size()), nP);
+    double sumA = 0.0, sumB = 0.0;
+    int cntP = 0, cntD = 0;
+
+    // 只遍历有效观测点
+    for (int i : m_validP) {
+        if (i >= nP) break;
+        if (pCal[i] > kMinValue) { sumA += m_logP[i] - std::log(pCal[i]); ++cntP; }
+    }
+    for (int i : m_validD) {
+        if (i >= nD) break;
+        if (dCal[i] > kMinValue) { sumB += m_logD[i] - std::log(dCal[i]); ++cntD; }
+    }
+
+    const double wp2 = m_weight * m_weight;
+    const double wd2 = (1.0 - m_weight) * (1.0 - m_weight);
+    double den = wp2 * cntP + wd2 * cntD;
+    if (den <= 0.0) return 0.0;
+    return (wp2 * sumA + wd2 * sumB) / den;
+}
@@ -0,0 +1,52 @@
+/*
+ * fittingresidualkernel.h
+ * 文件作用：拟合残差计算核心头文件
+ * 功能描述：
+ * 1. 每个拟合阶段对观测数据只预处理一次：观测值对数、逐点权重（无效点权重为 0）、有效点下标表，
+ *    以结构数组 (SoA) 形式连续存放
+ * 2. 残差计算为紧凑循环，写入调用方提供的缓冲区，尺寸不变时不重新分配内存
+ * 3. 残差排列与有效点判据与原逐次计算一致：前段为压力残差，后段为导数残差，
+ *    观测值或理论值 <= 1e-10 的点残差为 0
+ */
+
+#ifndef FITTINGRESIDUALKERNEL_H
+#define FITTINGRESIDUALKERNEL_H
+
+#include <QVector>
+
+class FittingResidualKernel
+{
+public:
+    // 逐点残差状态：观测无效（残差恒为 0）/ 观测与理论值均有效 / 观测有效但理论值无效
+    enum PointState : char { Masked = 0, Valid = 1, ModelInvalid = 2 };
+
+    FittingResidualKernel();
+
+    // 由观测压力、导数与压力权重 (导数权重为 1 - weight) 构建缓存
+    void prepare(const QVector<double>& obsP, const QVector<double>& obsD, double weight);
+    void clear();
+
+    int pressureCount() const { return m_logP.size(); }
+    int derivativeCount() const { return m_logD.size(); }
+    double weight() const { return m_weight; }
+
+    // 计算加权对数残差写入 out（理论曲线为空时 out 为空）
+    void evaluate(const QVector<double>& pCal, const QVector<double>& dCal, QVector<double>& out) const;
+    // 直接计算残差平方和，不生成残差向量；count 非空时返回残差个数
+    double sumSquares(const QVector<double>& pCal, const QVector<double>& dCal, int* count = nullptr) const;
+    // 逐点残差状态写入 out，排列与 evaluate 一致
+    void pointStates(const QVector<double>& pCal, const QVector<double>& dCal, QVector<char>& out) const;
+    // 使残差平方和最小的竖直对数平移量 s* = (wp²·Σa + wd²·Σb) / (wp²·n_p + wd²·n_d)，复用缓存的观测对数
+    double optimalLogShift(const QVector<double>& pCal, const QVector<double>& dCal) const;
+
+private:
+    QVector<double> m_logP;     // 观测压力自然对数（无效点为 0）
+    QVector<double> m_logD;     // 观测导数自然对数（无效点为 0）
+    QVector<double> m_wP;       // 压力逐点权重（有效点为 weight，无效点为 0）
+    QVector<double> m_wD;       // 导数逐点权重（有效点为 1 - weight，无效点为 0）
+    QVector<int> m_validP;      // 有效压力观测点下标
+    QVector<int> m_validD;      // 有效导数观测点下标
+    double m_weight;
+};
+
+#endif // FITTINGRESIDUALKERNEL_H
@@ -0,0 +1,56 @@
+/*
+ * fittingseparable.cpp
+ * 文件作用：试井拟合可分离最小二乘工具类实现文件
+ * 功能描述：
+ * 1. 双对数插值（用于在缓存曲线上做时间平移）
+ * 2. 黄金分割一维搜索
+ */
+
+#include "fittingseparable.h"
+
+#include <algorithm>
+#include <cmath>
+
+QVector<double> FittingSeparable::interpolateLogLog(const QVector<double>& gridT, const QVector<double>& gridY,
+                                                    const QVector<double>& t, double timeScale)
+{
+    QVector<double> out(t.size(), 0.0);
+    int n = qMin(gridT.size(), gridY.size());
+    if (n == 0) return out;
+    if (n == 1) { out.fill(gridY[0]); return out; }
+
+    for (int i = 0; i < t.size(); ++i) {
+        double ti = t[i] * timeScale;
+        if (ti <= 0) continue;
+        int hi = int(std::lower_bound(gridT.begin(), gridT.begin() + n, ti) - gridT.begin());
+        hi = qBound(1, hi, n - 1);
+        int lo = hi - 1;
+        if (gridY[lo] <= 0 || gridY[hi] <= 0) {
+            out[i] = (gridY[lo] > 0) ? gridY[lo] : gridY[hi];
+            continue;
+        }
+        double f = (std::log(ti) - std::log(gridT[lo])) / (std::log(gridT[hi]) - std::log(gridT[lo]));
+        out[i] = std::exp(std::log(gridY[lo]) + f * (std::log(gridY[hi]) - std::log(gridY[lo])));
+    }
+    return out;
+}
+
+double FittingSeparable::goldenSectionSearch(const std::function<double(double)>& f, double a, double b,
+                                             double tolerance, int maxIterations)
+{
+    const double invPhi = (std::sqrt(5.0) - 1.0) / 2.0;
+    if (b < a) std::swap(a, b);
+    double c = b - invPhi * (b - a);
+    double d = a + invPhi * (b - a);
+    double fc = f(c), fd = f(d);
+    for (int it = 0; it < maxIterations && (b - a) > tolerance; ++it) {
+        if (fc < fd) {
+            b = d; d = c; fd = fc;
+            c = b - invPhi * (b - a); fc = f(c);
+        } else {
+            a = c; c = d; fc = fd;
+            d = a + invPhi * (b - a); fd = f(d);
+        }
+    }
+    return 0.5 * (a + b);
+}
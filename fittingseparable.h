@@ -0,0 +1,35 @@
+/*
+ * fittingseparable.h
+ * 文件作用：试井拟合可分离最小二乘 (Variable Projection) 工具类头文件
+ * 功能描述：
+ * 1. 对数空间中理论压力 = log(factor) + log(PD)，factor = 1.842e-3·q·mu·B/(kf·h)
+ *    只引起双对数曲线的整体竖直平移，其最优值可对任意形状参数解析求出
+ * 2. 时间无因次化系数 (phi, Ct) 只引起双对数曲线的整体水平平移，
+ *    可在缓存的理论曲线上通过一维黄金分割搜索求出
+ * 3. 提供双对数插值等辅助算法，供 FittingEngine 消去上述参数
+ */
+
+#ifndef FITTINGSEPARABLE_H
+#define FITTINGSEPARABLE_H
+
+#include <QVector>
+#include <functional>
+
+class FittingSeparable
+{
+public:
+    /**
+     * @brief 双对数线性插值（gridT 须严格升序），超出范围时按端点线性外推
+     *        非正值不参与对数插值，取相邻正值
+     */
+    static QVector<double> interpolateLogLog(const QVector<double>& gridT, const QVector<double>& gridY,
+                                             const QVector<double>& t, double timeScale = 1.0);
+
+    /**
+     * @brief 一维黄金分割搜索，返回 [a, b] 内使 f 最小的自变量
+     */
+    static double goldenSectionSearch(const std::function<double(double)>& f, double a, double b,
+                                      double tolerance = 1e-4, int maxIterations = 60);
+};
+
+#endif // FITTINGSEPARABLE_H
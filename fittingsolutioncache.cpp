@@ -0,0 +1,198 @@
+/*
+ * fittingsolutioncache.cpp
+ * 文件作用：历史拟合解缓存（热启动）实现文件
+ * 功能描述：
+ * 1. 缓存结构：{ 数据哈希: { fingerprint: [...], lastUsed, models: { 模型类型: 解 } } }
+ * 2. 数据集超过上限时淘汰最久未更新的数据集
+ */
+
+#include "fittingsolutioncache.h"
+#include "fittingmodeldiscrimination.h"
+#include "modelparameter.h"
+
+#include <QCryptographicHash>
+#include <QJsonArray>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const int kFingerprintPoints = 16;
+}
+
+QJsonObject FitSolution::toJson() const
+{
+    QJsonObject obj;
+    obj["modelType"] = static_cast<int>(modelType);
+    QJsonObject p;
+    for (auto it = params.begin(); it != params.end(); ++it) p[it.key()] = it.value();
+    obj["params"] = p;
+    obj["error"] = error;
+    obj["time"] = time.toString(Qt::ISODate);
+    return obj;
+}
+
+FitSolution FitSolution::fromJson(const QJsonObject& obj)
+{
+    FitSolution s;
+    s.modelType = static_cast<ModelManager::ModelType>(obj.value("modelType").toInt());
+    QJsonObject p = obj.value("params").toObject();
+    for (auto it = p.begin(); it != p.end(); ++it) s.params.insert(it.key(), it.value().toDouble());
+    s.error = obj.value("error").toDouble();
+    s.time = QDateTime::fromString(obj.value("time").toString(), Qt::ISODate);
+    return s;
+}
+
+QString FittingSolutionCache::dataHash(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QVector<double>* v : { &t, &p, &d }) {
+        hash.addData(QByteArrayView(reinterpret_cast<const char*>(v->constData()), v->size() * qsizetype(sizeof(double))));
+    }
+    return QString::fromLatin1(hash.result().toHex().left(16));
+}
+
+QVector<double> FittingSolutionCache::fingerprint(const QVector<double>& t, const QVector<double>& p)
+{
+    // 有效点（时间、压力均为正），按时间升序
+    QVector<QPair<double, double>> pts;
+    for (int i = 0; i < qMin(t.size(), p.size()); ++i)
+        if (t[i] > 0 && p[i] > 0) pts.append(qMakePair(std::log10(t[i]), std::log10(p[i])));
+    if (pts.size() < 2) return QVector<double>();
+    std::sort(pts.begin(), pts.end());
+
+    // 指纹：[log10 tMin, log10 tMax, 16 个等距对数时间处的 log10 压力]
+    double lo = pts.first().first, hi = pts.last().first;
+    QVector<double> fp;
+    fp << lo << hi;
+    int j = 0;
+    for (int k = 0; k < kFingerprintPoints; ++k) {
+        double x = lo + (hi - lo) * k / (kFingerprintPoints - 1);
+        while (j < pts.size() - 2 && pts[j + 1].first < x) ++j;
+        double x0 = pts[j].first, x1 = pts[j + 1].first;
+        double f = (x1 > x0) ? qBound(0.0, (x - x0) / (x1 - x0), 1.0) : 0.0;
+        fp << pts[j].second + f * (pts[j + 1].second - pts[j].second);
+    }
+    return fp;
+}
+
+double FittingSolutionCache::fingerprintDistance(const QVector<double>& a, const QVector<double>& b)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    if (a.size() != kFingerprintPoints + 2 || b.size() != a.size()) return inf;
+    if (std::abs(a[0] - b[0]) > 0.3 || std::abs(a[1] - b[1]) > 0.3) return inf;
+    double sum = 0.0;
+    for (int k = 2; k < a.size(); ++k) sum += (a[k] - b[k]) * (a[k] - b[k]);
+    return std::sqrt(sum / kFingerprintPoints);
+}
+
+void FittingSolutionCache::store(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                                 ModelManager::ModelType modelType, const QMap<QString, double>& params, double error)
+{
+    if (t.isEmpty() || params.isEmpty() || !std::isfinite(error)) return;
+
+    ModelParameter* mp = ModelParameter::instance();
+    QJsonObject all = mp->getFitSolutions();
+    QString key = dataHash(t, p, d);
+    QDateTime now = QDateTime::currentDateTime();
+
+    QJsonObject entry = all.value(key).toObject();
+    if (!entry.contains("fingerprint")) {
+        QJsonArray fpArray;
+        for (double v : fingerprint(t, p)) fpArray.append(v);
+        entry["fingerprint"] = fpArray;
+    }
+    entry["lastUsed"] = now.toString(Qt::ISODate);
+
+    QJsonObject models = entry.value("models").toObject();
+    QString typeKey = QString::number(static_cast<int>(modelType));
+    FitSolution old = FitSolution::fromJson(models.value(typeKey).toObject());
+    if (!old.isValid() || error <= old.error) {
+        FitSolution s;
+        s.modelType = modelType;
+        s.params = params;
+        s.error = error;
+        s.time = now;
+        models[typeKey] = s.toJson();
+    }
+    entry["models"] = models;
+    all[key] = entry;
+
+    // 超过上限时淘汰最久未更新的数据集
+    while (all.size() > kMaxDatasets) {
+        QString oldestKey;
+        QDateTime oldest;
+        for (auto it = all.begin(); it != all.end(); ++it) {
+            QDateTime used = QDateTime::fromString(it.value().toObject().value("lastUsed").toString(), Qt::ISODate);
+            if (oldestKey.isEmpty() || used < oldest) { oldestKey = it.key(); oldest = used; }
+        }
+        all.remove(oldestKey);
+    }
+
+    mp->saveFitSolutions(all);
+}
+
+QList<FitSolution> FittingSolutionCache::matching(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d)
+{
+    QList<FitSolution> list;
+    if (t.isEmpty()) return list;
+
+    QJsonObject all = ModelParameter::instance()->getFitSolutions();
+    QString key = dataHash(t, p, d);
+    QVector<double> fp = fingerprint(t, p);
+
+    for (auto it = all.begin(); it != all.end(); ++it) {
+        QJsonObject entry = it.value().toObject();
+        bool exact = (it.key() == key);
+        double dist = 0.0;
+        if (!exact) {
+            QVector<double> other;
+            for (const QJsonValue& v : entry.value("fingerprint").toArray()) other.append(v.toDouble());
+            dist = fingerprintDistance(fp, other);
+            if (!(dist <= kNearDistance)) continue;
+        }
+        QJsonObject models = entry.value("models").toObject();
+        for (auto m = models.begin(); m != models.end(); ++m) {
+            FitSolution s = FitSolution::fromJson(m.value().toObject());
+            if (!s.isValid()) continue;
+            s.exactData = exact;
+            s.dataDistance = dist;
+            list.append(s);
+        }
+    }
+    return list;
+}
+
+FitSolution FittingSolutionCache::best(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                                       ModelManager::ModelType modelType)
+{
+    FitSolution result;
+    for (const FitSolution& s : matching(t, p, d)) {
+        if (s.modelType != modelType) continue;
+        // 哈希一致的数据优先；同为近似数据时取指纹更近者，其次误差更小者
+        bool better = !result.isValid()
+                      || (s.exactData && !result.exactData)
+                      || (s.exactData == result.exactData && s.dataDistance < result.dataDistance)
+                      || (s.exactData == result.exactData && s.dataDistance == result.dataDistance && s.error < result.error);
+        if (better) result = s;
+    }
+    return result;
+}
+
+QList<FitSolution> FittingSolutionCache::related(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                                                 ModelManager::ModelType modelType)
+{
+    QList<FitSolution> list = matching(t, p, d);
+    ModelManager::ModelType core = FittingModelDiscrimination::coreModel(modelType);
+    auto rank = [modelType, core](const FitSolution& s) {
+        if (s.modelType == modelType) return 0;
+        if (FittingModelDiscrimination::coreModel(s.modelType) == core) return 1;
+        return 2;
+    };
+    std::stable_sort(list.begin(), list.end(), [&rank](const FitSolution& a, const FitSolution& b) {
+        if (rank(a) != rank(b)) return rank(a) < rank(b);
+        if (a.exactData != b.exactData) return a.exactData;
+        return a.error < b.error;
+    });
+    return list;
+}
@@ -0,0 +1,65 @@
+/*
+ * fittingsolutioncache.h
+ * 文件作用：历史拟合解缓存（热启动）头文件
+ * 功能描述：
+ * 1. 每次拟合完成后，按观测数据哈希与模型类型保存拟合参数与误差，随项目持久化 (_fitcache.json)
+ * 2. 数据指纹：在对数时间上等距取 16 个点的 log10(压力)，数据小幅修改后哈希改变，
+ *    但指纹距离仍很小，可匹配到修改前的解作为初值
+ * 3. 查询当前数据 + 模型的最优历史解，以及同一数据下其他模型（优先同核心模型的井储变体）的解
+ */
+
+#ifndef FITTINGSOLUTIONCACHE_H
+#define FITTINGSOLUTIONCACHE_H
+
+#include <QMap>
+#include <QVector>
+#include <QString>
+#include <QDateTime>
+#include <QJsonObject>
+#include "modelmanager.h"
+
+// 单条历史解
+struct FitSolution {
+    ModelManager::ModelType modelType;
+    QMap<QString, double> params;
+    double error;           // 拟合误差 (MSE)
+    QDateTime time;
+    bool exactData;         // 数据哈希完全一致（否则为指纹近似匹配）
+    double dataDistance;    // 数据指纹距离（log10 压力均方根差）
+
+    FitSolution() : modelType(ModelManager::Model_1), error(0.0), exactData(false), dataDistance(0.0) {}
+    bool isValid() const { return !params.isEmpty(); }
+
+    QJsonObject toJson() const;
+    static FitSolution fromJson(const QJsonObject& obj);
+};
+
+class FittingSolutionCache
+{
+public:
+    // 保存拟合解；同一数据同一模型只保留误差最小的解
+    static void store(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                      ModelManager::ModelType modelType, const QMap<QString, double>& params, double error);
+
+    // 当前数据 + 模型的最优历史解：优先哈希一致的数据，其次指纹最接近的数据
+    static FitSolution best(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                            ModelManager::ModelType modelType);
+
+    // 当前数据（含近似数据）下的全部历史解：同模型在前，其次同核心模型，其余按误差排序
+    static QList<FitSolution> related(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d,
+                                      ModelManager::ModelType modelType);
+
+    static QString dataHash(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d);
+    static QVector<double> fingerprint(const QVector<double>& t, const QVector<double>& p);
+    // 指纹距离；时间范围相差超过 0.3 个对数周期时返回无穷大
+    static double fingerprintDistance(const QVector<double>& a, const QVector<double>& b);
+
+    static const int kMaxDatasets = 50;         // 最多保留的数据集数量（按最近使用淘汰）
+    static constexpr double kNearDistance = 0.05; // 近似数据的指纹距离阈值
+
+private:
+    // 收集与当前数据匹配（哈希一致或指纹接近）的全部解
+    static QList<FitSolution> matching(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d);
+};
+
+#endif // FITTINGSOLUTIONCACHE_H
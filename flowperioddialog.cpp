@@ -0,0 +1,136 @@
+/*
+ * flowperioddialog.cpp
+ * 文件作用：流动段划分结果弹窗的具体实现
+ * 功能描述：
+ * 1. 各段数据集由 FlowPeriodSegmenter::buildDatasets 预先算好，切换预览时不再计算
+ * 2. 点数不足、无法求导数的段仍列出，但不能送至拟合
+ */
+
+#include "flowperioddialog.h"
+#include "ui_flowperioddialog.h"
+#include "mousezoom.h"
+#include <QHeaderView>
+#include <QTableWidgetItem>
+
+FlowPeriodDialog::FlowPeriodDialog(const QVector<FlowPeriodData>& periods, bool byRate, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::FlowPeriodDialog),
+    m_periods(periods)
+{
+    ui->setupUi(this);
+    this->setWindowTitle("流动段划分");
+
+    setupPlot();
+    populateTable(byRate);
+
+    connect(ui->tablePeriods, &QTableWidget::itemSelectionChanged, this, &FlowPeriodDialog::onSelectionChanged);
+    connect(ui->btnApply, &QPushButton::clicked, this, &FlowPeriodDialog::accept);
+    connect(ui->btnCancel, &QPushButton::clicked, this, &FlowPeriodDialog::reject);
+
+    int shutIns = 0;
+    for (const FlowPeriodData& data : m_periods) if (data.period.shutIn) ++shutIns;
+    ui->labelResult->setText(QString("%1：共 %2 个流动段，其中关井 %3 个")
+                             .arg(byRate ? "按产量划分" : "无产量数据，按压力变化方向划分")
+                             .arg(m_periods.size()).arg(shutIns));
+
+    // 默认选中最后一个可用的段
+    for (int i = m_periods.size() - 1; i >= 0; --i) {
+        if (!m_periods[i].derivative.isEmpty()) { ui->tablePeriods->selectRow(i); break; }
+    }
+    onSelectionChanged();
+}
+
+FlowPeriodDialog::~FlowPeriodDialog()
+{
+    delete ui;
+}
+
+int FlowPeriodDialog::selectedIndex() const
+{
+    QList<QTableWidgetItem*> items = ui->tablePeriods->selectedItems();
+    return items.isEmpty() ? -1 : items.first()->row();
+}
+
+void FlowPeriodDialog::setupPlot()
+{
+    m_plot = new MouseZoom(this);
+    ui->plotContainer->layout()->addWidget(m_plot);
+    m_plot->setBackground(Qt::white);
+    m_plot->axisRect()->setupFullAxesBox(true);
+
+    QSharedPointer<QCPAxisTickerLog> logTicker(new QCPAxisTickerLog);
+    m_plot->xAxis->setScaleType(QCPAxis::stLogarithmic);
+    m_plot->xAxis->setTicker(logTicker);
+    m_plot->yAxis->setScaleType(QCPAxis::stLogarithmic);
+    m_plot->yAxis->setTicker(logTicker);
+    m_plot->xAxis->setLabel("Δt (h)");
+    m_plot->yAxis->setLabel("Pressure / Derivative");
+
+    m_pressureGraph = m_plot->addGraph();
+    m_pressureGraph->setName("压差");
+    m_pressureGraph->setLineStyle(QCPGraph::lsNone);
+    m_pressureGraph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, Qt::red, Qt::red, 4));
+
+    m_derivativeGraph = m_plot->addGraph();
+    m_derivativeGraph->setName("叠加导数");
+    m_derivativeGraph->setLineStyle(QCPGraph::lsNone);
+    m_derivativeGraph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssTriangle, Qt::blue, Qt::blue, 5));
+
+    m_plot->legend->setVisible(true);
+    m_plot->legend->setFont(QFont("Arial", 9));
+    m_plot->legend->setBrush(QBrush(QColor(255, 255, 255, 200)));
+}
+
+void FlowPeriodDialog::populateTable(bool byRate)
+{
+    QStringList headers;
+    headers << "序号" << "类型" << "开始时间" << "结束时间" << "点数" << (byRate ? "产量" : "产量(相对)") << "L-Spacing";
+    ui->tablePeriods->setColumnCount(headers.size());
+    ui->tablePeriods->setHorizontalHeaderLabels(headers);
+    ui->tablePeriods->verticalHeader()->setVisible(false);
+    ui->tablePeriods->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    ui->tablePeriods->setRowCount(m_periods.size());
+    for (int i = 0; i < m_periods.size(); ++i) {
+        const FlowPeriodData& data = m_periods[i];
+        QStringList texts;
+        texts << QString::number(i + 1) << (data.period.shutIn ? "关井" : "流动")
+              << QString::number(data.period.startTime, 'g', 6) << QString::number(data.period.endTime, 'g', 6)
+              << QString::number(data.time.size()) << QString::number(data.period.rate, 'g', 4)
+              << (data.derivative.isEmpty() ? QString("--") : QString::number(data.lSpacing, 'f', 3));
+        for (int col = 0; col < texts.size(); ++col) {
+            QTableWidgetItem* item = new QTableWidgetItem(texts[col]);
+            item->setTextAlignment(Qt::AlignCenter);
+            if (data.derivative.isEmpty()) item->setForeground(Qt::gray);
+            ui->tablePeriods->setItem(i, col, item);
+        }
+    }
+}
+
+void FlowPeriodDialog::onSelectionChanged()
+{
+    int index = selectedIndex();
+    bool usable = index >= 0 && !m_periods[index].derivative.isEmpty();
+    ui->btnApply->setEnabled(usable);
+    if (!usable) {
+        m_pressureGraph->data()->clear();
+        m_derivativeGraph->data()->clear();
+    } else {
+        const FlowPeriodData& data = m_periods[index];
+        setPositiveData(m_pressureGraph, data.time, data.pressure);
+        setPositiveData(m_derivativeGraph, data.time, data.derivative);
+    }
+    m_plot->rescaleAxes();
+    m_plot->replot();
+}
+
+void FlowPeriodDialog::setPositiveData(QCPGraph* graph, const QVector<double>& x, const QVector<double>& y)
+{
+    QVector<double> xs, ys;
+    xs.reserve(x.size());
+    ys.reserve(x.size());
+    for (int i = 0; i < x.size() && i < y.size(); ++i) {
+        if (x[i] > 0 && y[i] > 0) { xs.append(x[i]); ys.append(y[i]); }
+    }
+    graph->setData(xs, ys);
+}
@@ -0,0 +1,51 @@
+#ifndef FLOWPERIODDIALOG_H
+#define FLOWPERIODDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+#include "flowperiodsegmenter.h"
+
+namespace Ui {
+class FlowPeriodDialog;
+}
+
+class MouseZoom;
+class QCPGraph;
+
+// ===========================================================================
+// 类名：FlowPeriodDialog
+// 作用：流动段划分结果弹窗
+// 功能：
+// 1. 表格列出自动划分的各流动段（类型、起止时间、点数、产量、L-Spacing）
+// 2. 选中行即在双对数图上预览该段的压差与叠加导数
+// 3. “送至拟合”返回选中的流动段
+// ===========================================================================
+
+class FlowPeriodDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    FlowPeriodDialog(const QVector<FlowPeriodData>& periods, bool byRate, QWidget *parent = nullptr);
+    ~FlowPeriodDialog();
+
+    // 选中的流动段，未选中时返回 -1
+    int selectedIndex() const;
+
+private slots:
+    void onSelectionChanged();
+
+private:
+    Ui::FlowPeriodDialog *ui;
+    QVector<FlowPeriodData> m_periods;
+
+    MouseZoom* m_plot;
+    QCPGraph* m_pressureGraph;
+    QCPGraph* m_derivativeGraph;
+
+    void setupPlot();
+    void populateTable(bool byRate);
+    static void setPositiveData(QCPGraph* graph, const QVector<double>& x, const QVector<double>& y);
+};
+
+#endif // FLOWPERIODDIALOG_H
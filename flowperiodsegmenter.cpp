@@ -0,0 +1,230 @@
+/*
+ * flowperiodsegmenter.cpp
+ * 文件作用：长期监测数据的流动段自动划分实现文件
+ * 功能描述：
+ * 1. 二分分割以显式栈代替递归，候选分割点只在距两端 minLength 以外搜索
+ * 2. 数据集的等效时间由划分得到的产量史计算，首个流动段之前（尚未改变产量）直接使用 Δt
+ */
+
+#include "flowperiodsegmenter.h"
+#include "timetransform.h"
+#include "derivativeengine.h"
+
+#include <QtConcurrent>
+#include <QPair>
+#include <algorithm>
+#include <cmath>
+
+FlowPeriodSegmenter::FlowPeriodSegmenter(const Config& config)
+    : m_config(config)
+{
+}
+
+double FlowPeriodSegmenter::robustSigma(const QVector<double>& y)
+{
+    // 关井段记录的产量常为精确的 0，只用非零差分估计流动段的噪声
+    QVector<double> d;
+    for (int i = 0; i + 1 < y.size(); ++i) {
+        if (y[i + 1] != y[i]) d.append(y[i + 1] - y[i]);
+    }
+    if (d.size() < 3) return 0.0;
+    std::nth_element(d.begin(), d.begin() + d.size() / 2, d.end());
+    const double median = d[d.size() / 2];
+    for (double& v : d) v = std::abs(v - median);
+    std::nth_element(d.begin(), d.begin() + d.size() / 2, d.end());
+    // 差分的标准差为 √2 σ，MAD · 1.4826 为正态标准差的估计
+    return 1.4826 * d[d.size() / 2] / std::sqrt(2.0);
+}
+
+QVector<int> FlowPeriodSegmenter::changePoints(const QVector<double>& y) const
+{
+    const int n = y.size();
+    QVector<int> starts;
+    if (n == 0) return starts;
+    starts.append(0);
+
+    QVector<double> sum(n + 1, 0.0), sumSq(n + 1, 0.0);
+    for (int i = 0; i < n; ++i) {
+        sum[i + 1] = sum[i] + y[i];
+        sumSq[i + 1] = sumSq[i] + y[i] * y[i];
+    }
+    auto cost = [&sum, &sumSq](int b, int e) {
+        const double s = sum[e] - sum[b];
+        return qMax(0.0, sumSq[e] - sumSq[b] - s * s / (e - b));
+    };
+
+    const double sigma = robustSigma(y);
+    // 无噪声的阶梯数据 σ = 0，以总平方和的极小比例作下限避免舍入误差造成分割
+    const double penalty = qMax(m_config.penaltyFactor * sigma * sigma * std::log(double(qMax(n, 2))),
+                                1e-10 * cost(0, n) + 1e-300);
+    const int minLength = qMax(1, m_config.minLength);
+
+    QVector<QPair<int, int>> stack;
+    stack.append(qMakePair(0, n));
+    while (!stack.isEmpty()) {
+        const QPair<int, int> segment = stack.takeLast();
+        const int b = segment.first, e = segment.second;
+        if (e - b < 2 * minLength) continue;
+        const double whole = cost(b, e);
+        double bestGain = 0.0;
+        int bestK = -1;
+        for (int k = b + minLength; k <= e - minLength; ++k) {
+            const double gain = whole - cost(b, k) - cost(k, e);
+            if (gain > bestGain) { bestGain = gain; bestK = k; }
+        }
+        if (bestK < 0 || bestGain <= penalty) continue;
+        starts.append(bestK);
+        stack.append(qMakePair(b, bestK));
+        stack.append(qMakePair(bestK, e));
+    }
+    std::sort(starts.begin(), starts.end());
+    return starts;
+}
+
+QVector<FlowPeriod> FlowPeriodSegmenter::makePeriods(const QVector<double>& t, const QVector<int>& starts,
+                                                     const QVector<double>& levels)
+{
+    QVector<FlowPeriod> periods;
+    const int n = t.size();
+    for (int s = 0; s < starts.size(); ++s) {
+        FlowPeriod period;
+        period.firstRow = starts[s];
+        period.endRow = s + 1 < starts.size() ? starts[s + 1] : n - 1;
+        period.startTime = t[period.firstRow];
+        period.endTime = t[period.endRow];
+        period.rate = levels[s];
+        period.shutIn = (levels[s] == 0.0);
+        periods.append(period);
+    }
+    return periods;
+}
+
+QVector<FlowPeriod> FlowPeriodSegmenter::segmentByRate(const QVector<double>& t, const QVector<double>& q) const
+{
+    const int n = qMin(t.size(), q.size());
+    if (n < 2) return QVector<FlowPeriod>();
+
+    QVector<double> y(n);
+    double last = 0.0, qMaxAbs = 0.0;
+    for (int i = 0; i < n; ++i) {
+        if (std::isfinite(q[i])) last = std::abs(q[i]);
+        y[i] = last;
+        qMaxAbs = qMax(qMaxAbs, last);
+    }
+
+    QVector<int> starts = changePoints(y);
+    QVector<double> levels;
+    for (int s = 0; s < starts.size(); ++s) {
+        const int end = s + 1 < starts.size() ? starts[s + 1] : n;
+        double mean = 0.0;
+        for (int i = starts[s]; i < end; ++i) mean += y[i];
+        mean /= (end - starts[s]);
+        levels.append(mean <= m_config.shutInFraction * qMaxAbs ? 0.0 : mean);
+    }
+
+    // 相邻两段都判为关井时合并
+    QVector<int> mergedStarts;
+    QVector<double> mergedLevels;
+    for (int s = 0; s < starts.size(); ++s) {
+        if (!mergedLevels.isEmpty() && mergedLevels.last() == 0.0 && levels[s] == 0.0) continue;
+        mergedStarts.append(starts[s]);
+        mergedLevels.append(levels[s]);
+    }
+    return makePeriods(t.mid(0, n), mergedStarts, mergedLevels);
+}
+
+QVector<FlowPeriod> FlowPeriodSegmenter::segmentByPressure(const QVector<double>& t, const QVector<double>& p) const
+{
+    const int n = qMin(t.size(), p.size());
+    if (n < 3) return QVector<FlowPeriod>();
+
+    // 密集采样时单点压差远小于噪声，先按块平均再求差分；块数上限 kPressureBlocks
+    const int block = qMax(1, n / kPressureBlocks);
+    const int blocks = n / block;
+    if (blocks < 3) return QVector<FlowPeriod>();
+    QVector<double> mean(blocks, 0.0);
+    for (int b = 0; b < blocks; ++b) {
+        for (int i = b * block; i < (b + 1) * block; ++i) mean[b] += p[i];
+        mean[b] /= block;
+    }
+    QVector<double> diff(blocks - 1);
+    for (int b = 0; b + 1 < blocks; ++b) diff[b] = mean[b + 1] - mean[b];
+    // 差分噪声以中位数绝对值估计（差分本身的中位数绝对偏差受趋势影响小）
+    QVector<double> absDiff(diff.size());
+    for (int i = 0; i < diff.size(); ++i) absDiff[i] = std::abs(diff[i]);
+    std::nth_element(absDiff.begin(), absDiff.begin() + absDiff.size() / 2, absDiff.end());
+    const double scale = qMax(3.0 * 1.4826 * absDiff[absDiff.size() / 2], 1e-300);
+    QVector<double> y(diff.size());
+    for (int i = 0; i < diff.size(); ++i) y[i] = qBound(-1.0, diff[i] / scale, 1.0);
+
+    // 段内均值为正（压力上升）为关井恢复，否则为流动；相邻同类段合并
+    QVector<int> starts = changePoints(y);
+    QVector<int> mergedStarts;
+    QVector<double> mergedLevels;
+    for (int s = 0; s < starts.size(); ++s) {
+        const int end = s + 1 < starts.size() ? starts[s + 1] : y.size();
+        double sum = 0.0;
+        for (int i = starts[s]; i < end; ++i) sum += y[i];
+        const double level = sum > 0 ? 0.0 : 1.0;
+        if (!mergedLevels.isEmpty() && mergedLevels.last() == level) continue;
+
+        // 转折点在差分 k 涉及的两个块内：关井取压力最低点，开井取压力最高点
+        int row = 0;
+        if (s > 0) {
+            const int first = starts[s] * block;
+            const int last = qMin(n, (starts[s] + 2) * block);
+            row = first;
+            for (int i = first; i < last; ++i) {
+                if (level == 0.0 ? p[i] < p[row] : p[i] > p[row]) row = i;
+            }
+        }
+        mergedStarts.append(row);
+        mergedLevels.append(level);
+    }
+    return makePeriods(t.mid(0, n), mergedStarts, mergedLevels);
+}
+
+RateHistory FlowPeriodSegmenter::rateHistory(const QVector<FlowPeriod>& periods)
+{
+    RateHistory history;
+    for (const FlowPeriod& period : periods) {
+        history.startTimes.append(period.startTime);
+        history.rates.append(period.rate);
+    }
+    return history;
+}
+
+QVector<FlowPeriodData> FlowPeriodSegmenter::buildDatasets(const QVector<double>& t, const QVector<double>& p,
+                                                           const QVector<FlowPeriod>& periods, const CancellationToken* token)
+{
+    QVector<FlowPeriodData> datasets(periods.size());
+    for (int i = 0; i < periods.size(); ++i) {
+        datasets[i].period = periods[i];
+        datasets[i].lSpacing = DerivativeEngine::kDefaultLSpacing;
+    }
+    const TimeTransform transform(rateHistory(periods));
+
+    QtConcurrent::blockingMap(datasets, [&t, &p, &transform, token](FlowPeriodData& data) {
+        if (CancellationToken::isCancelled(token)) return;
+        const FlowPeriod& period = data.period;
+        const int last = qMin(period.endRow, qMin(t.size(), p.size()) - 1);
+        const double p0 = p[period.firstRow];
+        QVector<double> absTime;
+        for (int i = period.firstRow + 1; i <= last; ++i) {
+            const double dt = t[i] - period.startTime;
+            if (!(dt > 0) || !std::isfinite(p[i])) continue;
+            absTime.append(t[i]);
+            data.time.append(dt);
+            data.pressure.append(std::abs(p[i] - p0));
+        }
+        if (data.time.size() < 3) return;
+
+        const int index = transform.periodAt(absTime.first());
+        QVector<double> te = index >= 0 && transform.periodStart(index) == period.startTime
+                ? transform.transform(absTime, TimeTransform::EquivalentTime, index) : data.time;
+        data.lSpacing = DerivativeEngine::selectLSpacing(te, data.pressure).lSpacing;
+        data.derivative = DerivativeEngine::bourdet(te, data.pressure, data.lSpacing);
+    });
+    if (CancellationToken::isCancelled(token)) return QVector<FlowPeriodData>();
+    return datasets;
+}
@@ -0,0 +1,81 @@
+/*
+ * flowperiodsegmenter.h
+ * 文件作用：长期监测数据的流动段自动划分头文件
+ * 功能描述：
+ * 1. 变点检测：分段常数均值模型的二分分割，段内平方和由前缀和 O(1) 求得，
+ *    每层扫描代价 O(n)，分割均衡时总代价 O(n log n)；分割收益超过 penaltyFactor · σ² · ln n 时才分割，
+ *    σ 由一阶差分的中位数绝对偏差稳健估计
+ * 2. 有产量列时对产量检测，产量接近 0 的段为关井；无产量时对压力的块平均一阶差分（按噪声截断为 ±1）检测，
+ *    只能识别压降与压力恢复的交替，相邻同类段合并，段界取转折处的压力极值点
+ * 3. 各流动段生成数据集：段内经过时间、相对段开始压力的压差、叠加导数（等效时间上的 Bourdet 导数，
+ *    L-Spacing 自动选择），各段并行计算
+ */
+
+#ifndef FLOWPERIODSEGMENTER_H
+#define FLOWPERIODSEGMENTER_H
+
+#include <QVector>
+#include "ratesuperposition.h"
+#include "cancellationtoken.h"
+
+struct FlowPeriod
+{
+    int firstRow;       // 段开始样本（Δt = 0）
+    int endRow;         // 下一段的开始样本（段内最后一个样本）
+    double startTime;
+    double endTime;
+    double rate;        // 段内平均产量；按压力划分时流动段为 1、关井为 0
+    bool shutIn;
+};
+
+struct FlowPeriodData
+{
+    FlowPeriod period;
+    QVector<double> time;           // 段内经过时间 Δt
+    QVector<double> pressure;       // |p - 段开始压力|
+    QVector<double> derivative;     // 叠加导数 dΔp/dX
+    double lSpacing;
+};
+
+class FlowPeriodSegmenter
+{
+public:
+    struct Config {
+        double penaltyFactor;   // 分割惩罚系数
+        int minLength;          // 每段最少样本数
+        double shutInFraction;  // |q| 低于最大产量的该比例视为关井
+
+        Config() : penaltyFactor(3.0), minLength(5), shutInFraction(0.02) {}
+    };
+
+    static const int kPressureBlocks = 20000;  // 按压力划分时的最大块数
+
+    explicit FlowPeriodSegmenter(const Config& config = Config());
+
+    /**
+     * @brief 分段常数均值的变点
+     * @return 各段起点下标（升序，首个为 0）
+     */
+    QVector<int> changePoints(const QVector<double>& y) const;
+
+    // 按产量列划分（无效产量按前一个有效值处理）
+    QVector<FlowPeriod> segmentByRate(const QVector<double>& t, const QVector<double>& q) const;
+    // 按压力变化方向划分
+    QVector<FlowPeriod> segmentByPressure(const QVector<double>& t, const QVector<double>& p) const;
+
+    // 流动段对应的产量历史，供叠加时间与理论模型使用
+    static RateHistory rateHistory(const QVector<FlowPeriod>& periods);
+
+    // 生成各流动段的数据集（并行）；取消时返回空
+    static QVector<FlowPeriodData> buildDatasets(const QVector<double>& t, const QVector<double>& p,
+                                                 const QVector<FlowPeriod>& periods, const CancellationToken* token = nullptr);
+
+private:
+    static double robustSigma(const QVector<double>& y);
+    static QVector<FlowPeriod> makePeriods(const QVector<double>& t, const QVector<int>& starts,
+                                           const QVector<double>& levels);
+
+    Config m_config;
+};
+
+#endif // FLOWPERIODSEGMENTER_H
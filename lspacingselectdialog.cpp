@@ -0,0 +1,170 @@
+/*
+ * lspacingselectdialog.cpp
+ * 文件作用：L-Spacing 自动选择弹窗的具体实现
+ * 功能描述：
+ * 1. 候选 L 与评分由 DerivativeEngine::selectLSpacing 在后台线程一次算出，界面不阻塞；
+ *    切换预览时只重算一条导数
+ * 2. 推荐行以粗体标出，噪声、偏差为导数单位的方差估计
+ */
+
+#include "lspacingselectdialog.h"
+#include "ui_lspacingselectdialog.h"
+#include "mousezoom.h"
+#include <QHeaderView>
+#include <QTableWidgetItem>
+#include <QtConcurrent>
+
+LSpacingSelectDialog::LSpacingSelectDialog(const QVector<double>& t, const QVector<double>& p, double currentL, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::LSpacingSelectDialog),
+    m_t(t),
+    m_p(p),
+    m_currentL(currentL)
+{
+    ui->setupUi(this);
+    this->setWindowTitle("L-Spacing 自动选择");
+
+    m_selection.bestIndex = -1;
+    m_selection.lSpacing = currentL;
+
+    setupPlot();
+    populateTable();
+
+    connect(ui->tableCandidates, &QTableWidget::itemSelectionChanged, this, &LSpacingSelectDialog::onSelectionChanged);
+    connect(ui->btnApply, &QPushButton::clicked, this, &LSpacingSelectDialog::accept);
+    connect(ui->btnCancel, &QPushButton::clicked, this, &LSpacingSelectDialog::reject);
+    connect(&m_watcher, &QFutureWatcher<DerivativeEngine::LSpacingSelection>::finished, this, &LSpacingSelectDialog::onSelectionComputed);
+
+    // 候选扫描对每个 L 计算整条导数，大数据量时耗时明显，放到后台线程；
+    // 任务只持有数据副本，关闭窗口时无需等待
+    ui->labelResult->setText("正在计算候选 L-Spacing...");
+    ui->btnApply->setEnabled(false);
+    onSelectionChanged();
+    const QVector<double> t = m_t, p = m_p;
+    m_watcher.setFuture(QtConcurrent::run([t, p]() { return DerivativeEngine::selectLSpacing(t, p); }));
+}
+
+void LSpacingSelectDialog::onSelectionComputed()
+{
+    m_selection = m_watcher.result();
+    populateTable();
+
+    if (m_selection.bestIndex >= 0) {
+        const DerivativeEngine::LSpacingCandidate& best = m_selection.candidates[m_selection.bestIndex];
+        ui->labelResult->setText(QString("推荐 L = %1（噪声 %2，偏差 %3）")
+                                 .arg(best.lSpacing, 0, 'f', 3).arg(best.noise, 0, 'g', 3).arg(best.bias, 0, 'g', 3));
+        ui->tableCandidates->selectRow(m_selection.bestIndex);
+        ui->btnApply->setEnabled(true);
+    } else {
+        ui->labelResult->setText("有效数据点不足，无法自动选择 L-Spacing");
+    }
+    onSelectionChanged();
+}
+
+LSpacingSelectDialog::~LSpacingSelectDialog()
+{
+    delete ui;
+}
+
+double LSpacingSelectDialog::getSelectedLSpacing() const
+{
+    int index = selectedIndex();
+    return index >= 0 ? m_selection.candidates[index].lSpacing : m_currentL;
+}
+
+int LSpacingSelectDialog::selectedIndex() const
+{
+    QList<QTableWidgetItem*> items = ui->tableCandidates->selectedItems();
+    return items.isEmpty() ? -1 : items.first()->row();
+}
+
+void LSpacingSelectDialog::setupPlot()
+{
+    m_plot = new MouseZoom(this);
+    ui->plotContainer->layout()->addWidget(m_plot);
+    m_plot->setBackground(Qt::white);
+    m_plot->axisRect()->setupFullAxesBox(true);
+
+    QSharedPointer<QCPAxisTickerLog> logTicker(new QCPAxisTickerLog);
+    m_plot->xAxis->setScaleType(QCPAxis::stLogarithmic);
+    m_plot->xAxis->setTicker(logTicker);
+    m_plot->yAxis->setScaleType(QCPAxis::stLogarithmic);
+    m_plot->yAxis->setTicker(logTicker);
+    m_plot->xAxis->setLabel("Time (h)");
+    m_plot->yAxis->setLabel("Pressure / Derivative");
+
+    m_pressureGraph = m_plot->addGraph();
+    m_pressureGraph->setName("压差");
+    m_pressureGraph->setLineStyle(QCPGraph::lsNone);
+    m_pressureGraph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, QColor(150, 150, 150), QColor(150, 150, 150), 4));
+    setPositiveData(m_pressureGraph, m_t, m_p);
+
+    m_currentGraph = m_plot->addGraph();
+    m_currentGraph->setName(QString("当前 L = %1").arg(m_currentL, 0, 'f', 3));
+    m_currentGraph->setLineStyle(QCPGraph::lsNone);
+    m_currentGraph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QColor(239, 154, 154), Qt::white, 5));
+    setPositiveData(m_currentGraph, m_t, DerivativeEngine::bourdet(m_t, m_p, m_currentL));
+
+    m_previewGraph = m_plot->addGraph();
+    m_previewGraph->setLineStyle(QCPGraph::lsNone);
+    m_previewGraph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssTriangle, Qt::blue, Qt::blue, 6));
+
+    m_plot->legend->setVisible(true);
+    m_plot->legend->setFont(QFont("Arial", 9));
+    m_plot->legend->setBrush(QBrush(QColor(255, 255, 255, 200)));
+}
+
+void LSpacingSelectDialog::populateTable()
+{
+    QStringList headers;
+    headers << "L-Spacing" << "噪声" << "偏差" << "总分";
+    ui->tableCandidates->setColumnCount(headers.size());
+    ui->tableCandidates->setHorizontalHeaderLabels(headers);
+    ui->tableCandidates->verticalHeader()->setVisible(false);
+    ui->tableCandidates->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    const QVector<DerivativeEngine::LSpacingCandidate>& candidates = m_selection.candidates;
+    ui->tableCandidates->setRowCount(candidates.size());
+    for (int i = 0; i < candidates.size(); ++i) {
+        const DerivativeEngine::LSpacingCandidate& c = candidates[i];
+        QStringList texts;
+        texts << QString::number(c.lSpacing, 'f', 3) << QString::number(c.noise, 'g', 3)
+              << QString::number(c.bias, 'g', 3) << QString::number(c.score, 'g', 3);
+        for (int col = 0; col < texts.size(); ++col) {
+            QTableWidgetItem* item = new QTableWidgetItem(texts[col]);
+            item->setTextAlignment(Qt::AlignCenter);
+            if (i == m_selection.bestIndex) {
+                QFont font = item->font();
+                font.setBold(true);
+                item->setFont(font);
+            }
+            ui->tableCandidates->setItem(i, col, item);
+        }
+    }
+}
+
+void LSpacingSelectDialog::onSelectionChanged()
+{
+    int index = selectedIndex();
+    if (index < 0) {
+        m_previewGraph->data()->clear();
+        m_previewGraph->setName("预览");
+    } else {
+        double L = m_selection.candidates[index].lSpacing;
+        m_previewGraph->setName(QString("L = %1").arg(L, 0, 'f', 3));
+        setPositiveData(m_previewGraph, m_t, DerivativeEngine::bourdet(m_t, m_p, L));
+    }
+    m_plot->rescaleAxes();
+    m_plot->replot();
+}
+
+void LSpacingSelectDialog::setPositiveData(QCPGraph* graph, const QVector<double>& x, const QVector<double>& y)
+{
+    QVector<double> xs, ys;
+    xs.reserve(x.size());
+    ys.reserve(x.size());
+    for (int i = 0; i < x.size() && i < y.size(); ++i) {
+        if (x[i] > 0 && y[i] > 0) { xs.append(x[i]); ys.append(y[i]); }
+    }
+    graph->setData(xs, ys);
+}
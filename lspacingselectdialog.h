@@ -0,0 +1,59 @@
+#ifndef LSPACINGSELECTDIALOG_H
+#define LSPACINGSELECTDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+#include <QFutureWatcher>
+#include "derivativeengine.h"
+
+namespace Ui {
+class LSpacingSelectDialog;
+}
+
+class MouseZoom;
+class QCPGraph;
+
+// ===========================================================================
+// 类名：LSpacingSelectDialog
+// 作用：L-Spacing 自动选择弹窗
+// 功能：
+// 1. 打开后在后台对一组 L 并行计算导数，按噪声与曲率偏差评分，完成后默认选中推荐值
+// 2. 表格列出各候选 L 的噪声、偏差与总分，选中行即在双对数图上预览该 L 的导数
+// 3. 预览图同时叠加当前 L 的导数作对比；采用后返回选中的 L
+// ===========================================================================
+
+class LSpacingSelectDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    LSpacingSelectDialog(const QVector<double>& t, const QVector<double>& p, double currentL, QWidget *parent = nullptr);
+    ~LSpacingSelectDialog();
+
+    double getSelectedLSpacing() const;
+
+private slots:
+    void onSelectionChanged();
+    void onSelectionComputed();
+
+private:
+    Ui::LSpacingSelectDialog *ui;
+    QVector<double> m_t;
+    QVector<double> m_p;
+    double m_currentL;
+    DerivativeEngine::LSpacingSelection m_selection;
+    QFutureWatcher<DerivativeEngine::LSpacingSelection> m_watcher;
+
+    MouseZoom* m_plot;
+    QCPGraph* m_pressureGraph;
+    QCPGraph* m_currentGraph;    // 当前 L 的导数
+    QCPGraph* m_previewGraph;    // 选中 L 的导数
+
+    void setupPlot();
+    void populateTable();
+    int selectedIndex() const;
+    // 双对数坐标只绘制正值
+    static void setPositiveData(QCPGraph* graph, const QVector<double>& x, const QVector<double>& y);
+};
+
+#endif // LSPACINGSELECTDIALOG_H
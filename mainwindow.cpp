@@ -18,6 +18,7 @@
 #include "wt_plottingwidget.h" // 引用图表头文件
 #include "fittingpage.h"
 #include "settingswidget.h"
+#include "derivativeengine.h"
 
 #include <QDateTime>
 #include <QMessageBox>
@@ -171,6 +172,9 @@ void MainWindow::init()
     ui->verticalLayoutHandle->addWidget(m_DataEditorWidget);
     connect(m_DataEditorWidget, &DataEditorWidget::fileChanged, this, &MainWindow::onFileLoaded);
     connect(m_DataEditorWidget, &DataEditorWidget::dataChanged, this, &MainWindow::onDataEditorDataChanged);
+    connect(m_DataEditorWidget, &DataEditorWidget::dataEdited, this, &MainWindow::onDataEditorDataEdited);
+    connect(m_DataEditorWidget, &DataEditorWidget::deconvolutionReady, this, &MainWindow::onDeconvolutionReady);
+    connect(m_DataEditorWidget, &DataEditorWidget::flowPeriodSelected, this, &MainWindow::onFlowPeriodSelected);
 
     // 3.3 模型管理器
     m_ModelManager = new ModelManager(this);
@@ -182,6 +186,8 @@ void MainWindow::init()
     // 使用新的 WT_PlottingWidget 类
     m_PlottingWidget = new WT_PlottingWidget(ui->pageData);
     ui->verticalLayout_2->addWidget(m_PlottingWidget);
+    connect(m_PlottingWidget, &WT_PlottingWidget::rateHistorySelected,
+            this, &MainWindow::onRateHistorySelected);
 
     // 3.5 拟合界面
     if (ui->pageFitting && ui->verticalLayoutFitting) {
@@ -340,12 +346,20 @@ void MainWindow::onTransferDataToPlotting()
 
 void MainWindow::onDataEditorDataChanged()
 {
+    onDataEditorDataEdited();
     if (ui->stackedWidget->currentIndex() == 3) {
         transferDataFromEditorToPlotting();
     }
     m_hasValidData = hasDataLoaded();
 }
 
+void MainWindow::onDataEditorDataEdited()
+{
+    m_fitCurveTime.clear();
+    m_fitCurvePressure.clear();
+    m_fitCurveDerivative.clear();
+}
+
 void MainWindow::onModelCalculationCompleted(const QString &analysisType, const QMap<QString, double> &results)
 {
     qDebug() << "模型计算完成：" << analysisType;
@@ -355,6 +369,11 @@ void MainWindow::transferDataToFitting()
 {
     if (!m_FittingPage || !m_DataEditorWidget) return;
 
+    if (!m_fitCurveTime.isEmpty()) {
+        m_FittingPage->setObservedDataToCurrent(m_fitCurveTime, m_fitCurvePressure, m_fitCurveDerivative);
+        return;
+    }
+
     QStandardItemModel* model = m_DataEditorWidget->getDataModel();
     if (!model || model->rowCount() == 0) {
         return;
@@ -363,8 +382,17 @@ void MainWindow::transferDataToFitting()
     QVector<double> tVec, pVec, dVec;
     double p_initial = 0.0;
 
+    // 变产量历史指定了分析段时，观测数据与理论曲线一致：以段开始时间为零点、段开始时的压力为基准
+    const double origin = m_ModelManager ? m_ModelManager->getRateTimeOrigin() : 0.0;
+    if (origin > 0) {
+        for(int r=0; r<model->rowCount(); ++r) {
+            if (model->index(r, 0).data().toDouble() > origin) break;
+            p_initial = model->index(r, 1).data().toDouble();
+        }
+    }
+
     // 寻找初始压力
-    for(int r=0; r<model->rowCount(); ++r) {
+    for(int r=0; r<model->rowCount() && origin <= 0; ++r) {
         QModelIndex idx = model->index(r, 1);
         if(idx.isValid()) {
             double p = idx.data().toDouble();
@@ -377,7 +405,7 @@ void MainWindow::transferDataToFitting()
 
     // 提取数据
     for(int r=0; r<model->rowCount(); ++r) {
-        double t = model->index(r, 0).data().toDouble();
+        double t = model->index(r, 0).data().toDouble() - origin;
         double p_raw = model->index(r, 1).data().toDouble();
         if (t > 0) {
             tVec.append(t);
@@ -385,29 +413,49 @@ void MainWindow::transferDataToFitting()
         }
     }
 
-    // 计算导数
-    dVec.resize(tVec.size());
-    if (tVec.size() > 2) {
-        dVec[0] = 0;
-        dVec[tVec.size()-1] = 0;
-        for(int i=1; i<tVec.size()-1; ++i) {
-            double lnt1 = std::log(tVec[i-1]);
-            double lnt2 = std::log(tVec[i]);
-            double lnt3 = std::log(tVec[i+1]);
-            if (std::abs(lnt2 - lnt1) < 1e-9 || std::abs(lnt3 - lnt2) < 1e-9) {
-                dVec[i] = 0; continue;
-            }
-            double d1 = (pVec[i] - pVec[i-1]) / (lnt2 - lnt1);
-            double d2 = (pVec[i+1] - pVec[i]) / (lnt3 - lnt2);
-            double w1 = (lnt3 - lnt2) / (lnt3 - lnt1);
-            double w2 = (lnt2 - lnt1) / (lnt3 - lnt1);
-            dVec[i] = d1 * w1 + d2 * w2;
-        }
-    }
+    // 计算导数（与拟合页面导入数据时相同：按系统设置中的导数算法与 L-Spacing）
+    dVec = DerivativeEngine::compute(tVec, pVec, DerivativeEngine::Algorithm(SettingsWidget::derivativeAlgorithm()),
+                                     SettingsWidget::derivativeLSpacing());
 
     m_FittingPage->setObservedDataToCurrent(tVec, pVec, dVec);
 }
 
+void MainWindow::onRateHistorySelected(const RateHistory& history, double timeOrigin)
+{
+    if (!m_ModelManager) return;
+    m_ModelManager->setRateHistory(history, timeOrigin);
+    if (this->statusBar()) {
+        this->statusBar()->showMessage(history.isMultiRate() ? QString("理论模型使用 %1 段变产量历史，分析段从 t = %2 开始")
+                                                                   .arg(history.stepCount()).arg(timeOrigin, 0, 'g', 6)
+                                                             : QString("理论模型使用单一产量"), 5000);
+    }
+}
+
+void MainWindow::onDeconvolutionReady(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d, double referenceRate)
+{
+    // 单位响应对应常产量
+    setFittingCurve(t, p, d, QString("拟合使用反褶积曲线，参考产量 %1").arg(referenceRate, 0, 'g', 6));
+}
+
+void MainWindow::onFlowPeriodSelected(const FlowPeriodData& data, int index)
+{
+    // 叠加导数已计入之前的产量史，拟合按该段的产量变化作单一产量处理
+    setFittingCurve(data.time, data.pressure, data.derivative,
+                    QString("拟合使用第 %1 个流动段（%2，L = %3）")
+                    .arg(index + 1).arg(data.period.shutIn ? "关井" : "流动").arg(data.lSpacing, 0, 'f', 3));
+}
+
+void MainWindow::setFittingCurve(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d, const QString& message)
+{
+    m_fitCurveTime = t;
+    m_fitCurvePressure = p;
+    m_fitCurveDerivative = d;
+
+    if (m_ModelManager) m_ModelManager->setRateHistory(RateHistory());
+    if (m_FittingPage) m_FittingPage->setObservedDataToCurrent(t, p, d);
+    if (this->statusBar()) this->statusBar()->showMessage(message, 5000);
+}
+
 void MainWindow::onFittingProgressChanged(int progress)
 {
     if (this->statusBar()) {
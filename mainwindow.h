@@ -16,6 +16,7 @@
 #include <QTimer>
 #include <QStandardItemModel>
 #include "modelmanager.h"
+#include "flowperiodsegmenter.h"
 
 // 前向声明子窗口类，减少头文件依赖
 class NavBtn;
@@ -65,6 +66,8 @@ private slots:
     void onTransferDataToPlotting();
     // 数据编辑器内容发生变化时的回调
     void onDataEditorDataChanged();
+    // 表格被编辑：反褶积/流动段拟合曲线不再对应当前数据
+    void onDataEditorDataEdited();
 
     // --- 设置与模型相关槽函数 ---
     // 系统通用设置变更回调
@@ -75,6 +78,12 @@ private slots:
     void onModelCalculationCompleted(const QString &analysisType, const QMap<QString, double> &results);
     // 拟合进度更新回调
     void onFittingProgressChanged(int progress);
+    // 绘图界面选定产量历史，交给模型叠加计算
+    void onRateHistorySelected(const RateHistory& history, double timeOrigin);
+    // 数据编辑器反褶积完成，拟合改用单位响应曲线
+    void onDeconvolutionReady(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d, double referenceRate);
+    // 数据编辑器选中流动段，拟合改用该段的压差与叠加导数
+    void onFlowPeriodSelected(const FlowPeriodData& data, int index);
 
 private:
     Ui::MainWindow *ui;
@@ -97,6 +106,9 @@ private:
     // 标记是否已加载项目（新建或打开），用于控制功能访问权限
     bool m_isProjectLoaded = false;
 
+    // 反褶积或流动段得到的拟合曲线；数据编辑后失效，恢复为原始数据
+    QVector<double> m_fitCurveTime, m_fitCurvePressure, m_fitCurveDerivative;
+
     // --- 内部私有辅助函数 ---
     // 将数据从编辑器传输至绘图模块
     void transferDataFromEditorToPlotting();
@@ -104,6 +116,8 @@ private:
     void updateNavigationState();
     // 将数据传输至拟合模块
     void transferDataToFitting();
+    // 以指定曲线代替原始数据作为拟合实测曲线（单一产量，不叠加产量史）
+    void setFittingCurve(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d, const QString& message);
 
     // 获取数据编辑器的数据模型
     QStandardItemModel* getDataEditorModel() const;
@@ -0,0 +1,172 @@
+/*
+ * modeldiscriminationdialog.cpp
+ * 文件作用：自动模型识别弹窗的具体实现
+ * 功能描述：
+ * 1. 表格列出 Model_1 ~ Model_6 的拟合状态、参数个数、MSE、AIC、ΔAIC、BIC、Durbin-Watson 与排名
+ * 2. 识别完成后按排名重排表格并默认选中最优模型
+ * 3. 关闭弹窗时取消仍在运行的拟合
+ */
+
+#include "modeldiscriminationdialog.h"
+#include "ui_modeldiscriminationdialog.h"
+#include <QHeaderView>
+#include <QMessageBox>
+#include <limits>
+
+ModelDiscriminationDialog::ModelDiscriminationDialog(FittingModelDiscrimination* discrimination, const QList<FitParameter>& baseParams,
+                                                     double weight, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::ModelDiscriminationDialog),
+    m_discrimination(discrimination),
+    m_baseParams(baseParams),
+    m_weight(weight),
+    m_selectedIndex(-1)
+{
+    ui->setupUi(this);
+    this->setWindowTitle("自动模型识别");
+
+    connect(ui->btnStart, &QPushButton::clicked, this, &ModelDiscriminationDialog::onStart);
+    connect(ui->btnStop, &QPushButton::clicked, this, &ModelDiscriminationDialog::onStop);
+    connect(ui->btnApply, &QPushButton::clicked, this, &ModelDiscriminationDialog::onApply);
+    connect(ui->btnClose, &QPushButton::clicked, this, &ModelDiscriminationDialog::reject);
+    connect(ui->tableResults, &QTableWidget::itemSelectionChanged, this, &ModelDiscriminationDialog::updateButtons);
+
+    connect(m_discrimination, &FittingModelDiscrimination::candidateUpdated, this, &ModelDiscriminationDialog::refreshRow);
+    connect(m_discrimination, &FittingModelDiscrimination::finished, this, &ModelDiscriminationDialog::onFinished);
+
+    initTable();
+    updateButtons();
+}
+
+ModelDiscriminationDialog::~ModelDiscriminationDialog()
+{
+    delete ui;
+}
+
+void ModelDiscriminationDialog::initTable()
+{
+    QStringList headers;
+    headers << "排名" << "模型" << "状态" << "进度" << "拟合参数数" << "MSE" << "AIC" << "ΔAIC" << "BIC" << "Durbin-Watson" << "平均偏差";
+    ui->tableResults->setColumnCount(headers.size());
+    ui->tableResults->setHorizontalHeaderLabels(headers);
+    ui->tableResults->verticalHeader()->setVisible(false);
+    ui->tableResults->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    ui->tableResults->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+
+    const int modelCount = static_cast<int>(ModelManager::Model_6) + 1;
+    ui->tableResults->setRowCount(modelCount);
+    for (int i = 0; i < modelCount; ++i) {
+        for (int c = 0; c < headers.size(); ++c) {
+            QTableWidgetItem* item = new QTableWidgetItem();
+            item->setTextAlignment(Qt::AlignCenter);
+            ui->tableResults->setItem(i, c, item);
+        }
+        // 行号与候选序号对应，排序后通过 UserRole 找回
+        ui->tableResults->item(i, 0)->setData(Qt::UserRole, i);
+        ui->tableResults->item(i, 1)->setText(ModelManager::getModelTypeName(static_cast<ModelManager::ModelType>(i)));
+    }
+}
+
+void ModelDiscriminationDialog::refreshRow(int index)
+{
+    const QVector<ModelCandidateResult>& results = m_discrimination->results();
+    if (index < 0 || index >= results.size()) return;
+    const ModelCandidateResult& r = results[index];
+
+    int row = -1;
+    for (int i = 0; i < ui->tableResults->rowCount(); ++i)
+        if (ui->tableResults->item(i, 0)->data(Qt::UserRole).toInt() == index) { row = i; break; }
+    if (row < 0) return;
+
+    // 最优 AIC，用于计算 ΔAIC
+    double bestAic = std::numeric_limits<double>::max();
+    for (const ModelCandidateResult& c : results)
+        if (c.state == ModelCandidateResult::Finished) bestAic = qMin(bestAic, c.aic);
+
+    bool done = (r.state == ModelCandidateResult::Finished);
+    auto setText = [this, row](int col, const QString& text) { ui->tableResults->item(row, col)->setText(text); };
+    setText(0, r.rank > 0 ? QString::number(r.rank) : QString("--"));
+    setText(2, r.stateText());
+    setText(3, QString("%1%").arg(done ? 100 : r.progress));
+    setText(4, done ? QString::number(r.k) : QString("--"));
+    setText(5, done ? QString::number(r.mse, 'e', 3) : QString("--"));
+    setText(6, done ? QString::number(r.aic, 'f', 1) : QString("--"));
+    setText(7, done ? QString::number(r.aic - bestAic, 'f', 1) : QString("--"));
+    setText(8, done ? QString::number(r.bic, 'f', 1) : QString("--"));
+    setText(9, done ? QString::number(r.durbinWatson, 'f', 2) : QString("--"));
+    setText(10, done ? QString::number(r.bias, 'e', 2) : QString("--"));
+}
+
+void ModelDiscriminationDialog::onStart()
+{
+    if (m_discrimination->isRunning()) return;
+    ui->tableResults->setSortingEnabled(false);
+    m_discrimination->start(m_baseParams, m_weight);
+    updateButtons();
+}
+
+void ModelDiscriminationDialog::onStop()
+{
+    m_discrimination->cancel();
+}
+
+void ModelDiscriminationDialog::onFinished()
+{
+    const QVector<ModelCandidateResult>& results = m_discrimination->results();
+    for (int i = 0; i < results.size(); ++i) refreshRow(i);
+
+    // 按排名重排：未完成的模型排在最后
+    for (int i = 0; i < ui->tableResults->rowCount(); ++i) {
+        int index = ui->tableResults->item(i, 0)->data(Qt::UserRole).toInt();
+        int rank = results[index].rank;
+        ui->tableResults->item(i, 0)->setData(Qt::DisplayRole, rank > 0 ? rank : 99);
+    }
+    ui->tableResults->sortItems(0, Qt::AscendingOrder);
+    for (int i = 0; i < ui->tableResults->rowCount(); ++i) {
+        QTableWidgetItem* item = ui->tableResults->item(i, 0);
+        if (item->data(Qt::DisplayRole).toInt() == 99) item->setText("--");
+    }
+    if (ui->tableResults->rowCount() > 0 && results[ui->tableResults->item(0, 0)->data(Qt::UserRole).toInt()].rank == 1)
+        ui->tableResults->selectRow(0);
+    updateButtons();
+}
+
+void ModelDiscriminationDialog::onApply()
+{
+    int row = ui->tableResults->currentRow();
+    if (row < 0) return;
+    int index = ui->tableResults->item(row, 0)->data(Qt::UserRole).toInt();
+    if (m_discrimination->results()[index].state != ModelCandidateResult::Finished) {
+        QMessageBox::warning(this, "提示", "所选模型尚未完成拟合。");
+        return;
+    }
+    m_selectedIndex = index;
+    accept();
+}
+
+void ModelDiscriminationDialog::reject()
+{
+    if (m_discrimination->isRunning()) {
+        if (QMessageBox::question(this, "确认", "模型识别仍在进行，确定停止并关闭吗？") != QMessageBox::Yes) return;
+        m_discrimination->cancel();
+    }
+    QDialog::reject();
+}
+
+void ModelDiscriminationDialog::updateButtons()
+{
+    bool running = m_discrimination->isRunning();
+    ui->btnStart->setEnabled(!running);
+    ui->btnStop->setEnabled(running);
+    ui->btnApply->setEnabled(!running && ui->tableResults->currentRow() >= 0);
+}
+
+ModelManager::ModelType ModelDiscriminationDialog::getSelectedModel() const
+{
+    return m_selectedIndex >= 0 ? m_discrimination->results()[m_selectedIndex].type : ModelManager::Model_1;
+}
+
+QList<FitParameter> ModelDiscriminationDialog::getSelectedParameters() const
+{
+    return m_selectedIndex >= 0 ? m_discrimination->results()[m_selectedIndex].params : QList<FitParameter>();
+}
@@ -0,0 +1,54 @@
+#ifndef MODELDISCRIMINATIONDIALOG_H
+#define MODELDISCRIMINATIONDIALOG_H
+
+#include <QDialog>
+#include "fittingmodeldiscrimination.h"
+
+namespace Ui {
+class ModelDiscriminationDialog;
+}
+
+// ===========================================================================
+// 类名：ModelDiscriminationDialog
+// 作用：自动模型识别弹窗
+// 功能：
+// 1. 启动全部候选模型的后台拟合，实时显示各模型的状态与进度
+// 2. 全部完成后按 AIC 排序，显示 ΔAIC、BIC 与残差诊断
+// 3. 用户选择模型后，将模型类型与拟合参数返回给拟合界面
+// ===========================================================================
+
+class ModelDiscriminationDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ModelDiscriminationDialog(FittingModelDiscrimination* discrimination, const QList<FitParameter>& baseParams,
+                                       double weight, QWidget *parent = nullptr);
+    ~ModelDiscriminationDialog();
+
+    // 用户选择的模型及其拟合参数
+    ModelManager::ModelType getSelectedModel() const;
+    QList<FitParameter> getSelectedParameters() const;
+
+protected:
+    void reject() override;
+
+private slots:
+    void onStart();
+    void onStop();
+    void onApply();
+    void refreshRow(int index);
+    void onFinished();
+
+private:
+    Ui::ModelDiscriminationDialog *ui;
+    FittingModelDiscrimination* m_discrimination;
+    QList<FitParameter> m_baseParams;
+    double m_weight;
+    int m_selectedIndex;
+
+    void initTable();
+    void updateButtons();
+};
+
+#endif // MODELDISCRIMINATIONDIALOG_H
@@ -5,12 +5,15 @@
  * 1. 管理所有试井模型的生命周期和界面切换
  * 2. 创建并配置模型选择的UI区域
  * 3. 协调模型计算请求与结果信号
+ * 4. 变产量：单位产量响应在对数网格上计算一次，由 RateSuperposition 按产量史叠加
  */
 
 #include "modelmanager.h"
 #include "modelselect.h"
 #include "modelparameter.h"
 #include "modelwidget01-06.h" // 包含合并后的类
+#include "derivativeengine.h"
+#include "settingswidget.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -21,7 +24,7 @@
 
 ModelManager::ModelManager(QWidget* parent)
     : QObject(parent), m_mainWidget(nullptr), m_btnSelectModel(nullptr), m_modelStack(nullptr)
-    , m_currentModelType(Model_1)
+    , m_currentModelType(Model_1), m_rateTimeOrigin(0.0)
 {
 }
 
@@ -221,13 +224,57 @@ QMap<QString, double> ModelManager::getDefaultParameters(ModelType type)
     return p;
 }
 
-ModelCurveData ModelManager::calculateTheoreticalCurve(ModelType type, const QMap<QString, double>& params, const QVector<double>& providedTime)
+ModelCurveData ModelManager::calculateTheoreticalCurve(ModelType type, const QMap<QString, double>& params, const QVector<double>& providedTime,
+                                                       const CancellationToken* token)
 {
     int index = (int)type;
-    if (index >= 0 && index < m_modelWidgets.size()) {
-        return m_modelWidgets[index]->calculateTheoreticalCurve(params, providedTime);
+    if (index < 0 || index >= m_modelWidgets.size()) return ModelCurveData();
+    ModelWidget01_06* widget = m_modelWidgets[index];
+
+    RateHistory history;
+    double origin = 0.0;
+    {
+        QMutexLocker locker(&m_rateMutex);
+        history = m_rateHistory;
+        origin = m_rateTimeOrigin;
     }
-    return ModelCurveData();
+    if (!history.isMultiRate()) return widget->calculateTheoreticalCurve(params, providedTime, token);
+
+    QVector<double> tPoints = providedTime.isEmpty() ? generateLogTimeSteps(100, -3.0, 3.0) : providedTime;
+    RateSuperposition superposition(history);
+    QVector<double> grid = superposition.unitResponseGrid(tPoints, origin);
+    if (grid.isEmpty()) return widget->calculateTheoreticalCurve(params, providedTime, token);
+
+    QMap<QString, double> unitParams = params;
+    unitParams["q"] = 1.0;
+    ModelCurveData unit = widget->calculateTheoreticalCurve(unitParams, grid, token);
+    if (std::get<0>(unit).isEmpty()) return ModelCurveData(); // 计算已取消
+    superposition.setUnitResponse(std::get<0>(unit), std::get<1>(unit));
+
+    // 叠加后的理论压力与实测数据按系统设置中相同的导数算法与 L-Spacing 求导，两者平滑程度一致
+    QVector<double> p = superposition.periodResponse(tPoints, origin);
+    QVector<double> d = DerivativeEngine::compute(tPoints, p, DerivativeEngine::Algorithm(SettingsWidget::derivativeAlgorithm()),
+                                                  SettingsWidget::derivativeLSpacing());
+    return std::make_tuple(tPoints, p, d);
+}
+
+void ModelManager::setRateHistory(const RateHistory& history, double timeOrigin)
+{
+    QMutexLocker locker(&m_rateMutex);
+    m_rateHistory = history;
+    m_rateTimeOrigin = timeOrigin;
+}
+
+RateHistory ModelManager::getRateHistory() const
+{
+    QMutexLocker locker(&m_rateMutex);
+    return m_rateHistory;
+}
+
+double ModelManager::getRateTimeOrigin() const
+{
+    QMutexLocker locker(&m_rateMutex);
+    return m_rateTimeOrigin;
 }
 
 QVector<double> ModelManager::generateLogTimeSteps(int count, double startExp, double endExp) {
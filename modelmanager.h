@@ -6,9 +6,11 @@
 #include <QVector>
 #include <QStackedWidget>
 #include <QPushButton>
+#include <QMutex>
 
 // 引入合并后的 ModelWidget 头文件
 #include "modelwidget01-06.h"
+#include "ratesuperposition.h"
 
 class ModelManager : public QObject
 {
@@ -37,7 +39,10 @@ public:
     static QString getModelTypeName(ModelType type);
 
     // 计算理论曲线接口 (供 FittingWidget 使用)
-    ModelCurveData calculateTheoreticalCurve(ModelType type, const QMap<QString, double>& params, const QVector<double>& providedTime = QVector<double>());
+    // token 非空且在计算中被取消时返回空曲线
+    // 设置了多段产量史时，以 q = 1 计算单位响应并按产量史叠加（参数 q 不再使用）
+    ModelCurveData calculateTheoreticalCurve(ModelType type, const QMap<QString, double>& params, const QVector<double>& providedTime = QVector<double>(),
+                                             const CancellationToken* token = nullptr);
 
     // 获取默认参数 (供 FittingWidget 使用)
     QMap<QString, double> getDefaultParameters(ModelType type);
@@ -56,6 +61,11 @@ public:
     void getObservedData(QVector<double>& t, QVector<double>& p, QVector<double>& d) const;
     bool hasObservedData() const;
 
+    // 变产量历史：timeOrigin 为理论曲线 t = 0 对应的产量史时间；单段产量等同于清除
+    void setRateHistory(const RateHistory& history, double timeOrigin = 0.0);
+    RateHistory getRateHistory() const;
+    double getRateTimeOrigin() const;
+
 signals:
     // 信号: 模型切换
     void modelSwitched(ModelType newType, ModelType oldType);
@@ -85,6 +95,11 @@ private:
     QVector<double> m_cachedObsTime;
     QVector<double> m_cachedObsPressure;
     QVector<double> m_cachedObsDerivative;
+
+    // 产量史（拟合线程并发读取，加锁复制）
+    mutable QMutex m_rateMutex;
+    RateHistory m_rateHistory;
+    double m_rateTimeOrigin;
 };
 
 #endif // MODELMANAGER_H
@@ -4,10 +4,13 @@
  * 功能描述:
  * 1. 实现项目数据的加载与保存。
  * 2. [关键] loadProject 时强制读取 _date.json 到 m_fullProjectData["table_data"]，解决数据丢失问题。
+ * 3. 拟合检查点写入 _fitckpt.json，使用 QSaveFile 保证写入中途崩溃不会损坏已有检查点。
+ * 4. 历史拟合解缓存写入 _fitcache.json，同样使用 QSaveFile 写入。
  */
 
 #include "modelparameter.h"
 #include <QFile>
+#include <QSaveFile>
 #include <QJsonDocument>
 #include <QFileInfo>
 #include <QDebug>
@@ -67,6 +70,24 @@ QString ModelParameter::getTableDataFilePath() const
     return fi.absolutePath() + "/" + baseName + "_date.json";
 }
 
+// 构造拟合检查点路径: 原文件名 + "_fitckpt.json"
+QString ModelParameter::getFitCheckpointFilePath() const
+{
+    if (m_projectFilePath.isEmpty()) return QString();
+    QFileInfo fi(m_projectFilePath);
+    QString baseName = fi.completeBaseName();
+    return fi.absolutePath() + "/" + baseName + "_fitckpt.json";
+}
+
+// 构造历史拟合解缓存路径: 原文件名 + "_fitcache.json"
+QString ModelParameter::getFitCacheFilePath() const
+{
+    if (m_projectFilePath.isEmpty()) return QString();
+    QFileInfo fi(m_projectFilePath);
+    QString baseName = fi.completeBaseName();
+    return fi.absolutePath() + "/" + baseName + "_fitcache.json";
+}
+
 bool ModelParameter::loadProject(const QString& filePath)
 {
     // 1. 加载主项目文件 (.pwt)
@@ -140,6 +161,28 @@ bool ModelParameter::loadProject(const QString& filePath)
         m_fullProjectData.remove("table_data");
     }
 
+    // 4. 加载拟合检查点 (_fitckpt.json)
+    m_fullProjectData.remove("fit_checkpoints");
+    QFile ckptFile(getFitCheckpointFilePath());
+    if (ckptFile.exists() && ckptFile.open(QIODevice::ReadOnly)) {
+        QJsonDocument d = QJsonDocument::fromJson(ckptFile.readAll());
+        if (!d.isNull() && d.isObject() && d.object().contains("fit_checkpoints")) {
+            m_fullProjectData["fit_checkpoints"] = d.object()["fit_checkpoints"];
+        }
+        ckptFile.close();
+    }
+
+    // 5. 加载历史拟合解缓存 (_fitcache.json)
+    m_fullProjectData.remove("fit_solutions");
+    QFile cacheFile(getFitCacheFilePath());
+    if (cacheFile.exists() && cacheFile.open(QIODevice::ReadOnly)) {
+        QJsonDocument d = QJsonDocument::fromJson(cacheFile.readAll());
+        if (!d.isNull() && d.isObject() && d.object().contains("fit_solutions")) {
+            m_fullProjectData["fit_solutions"] = d.object()["fit_solutions"];
+        }
+        cacheFile.close();
+    }
+
     return true;
 }
 
@@ -167,6 +210,8 @@ bool ModelParameter::saveProject()
     QJsonObject dataToWrite = m_fullProjectData;
     dataToWrite.remove("plotting_data");
     dataToWrite.remove("table_data");
+    dataToWrite.remove("fit_checkpoints");
+    dataToWrite.remove("fit_solutions");
 
     QFile file(m_projectFilePath);
     if (!file.open(QIODevice::WriteOnly)) return false;
@@ -195,6 +240,8 @@ void ModelParameter::saveFittingResult(const QJsonObject& fittingData)
         QJsonObject dataToWrite = m_fullProjectData;
         dataToWrite.remove("plotting_data");
         dataToWrite.remove("table_data");
+        dataToWrite.remove("fit_checkpoints");
+        dataToWrite.remove("fit_solutions");
         file.write(QJsonDocument(dataToWrite).toJson());
         file.close();
     }
@@ -256,3 +303,62 @@ QJsonArray ModelParameter::getTableData() const
     // 直接从内存缓存中读取（loadProject 时已填充）
     return m_fullProjectData.value("table_data").toArray();
 }
+
+// 保存拟合检查点
+void ModelParameter::saveFitCheckpoint(const QString& analysisName, const QJsonObject& checkpoint)
+{
+    QJsonObject all = m_fullProjectData.value("fit_checkpoints").toObject();
+    all[analysisName] = checkpoint;
+    m_fullProjectData["fit_checkpoints"] = all;
+    writeFitCheckpoints();
+}
+
+QJsonObject ModelParameter::getFitCheckpoint(const QString& analysisName) const
+{
+    return m_fullProjectData.value("fit_checkpoints").toObject().value(analysisName).toObject();
+}
+
+void ModelParameter::removeFitCheckpoint(const QString& analysisName)
+{
+    QJsonObject all = m_fullProjectData.value("fit_checkpoints").toObject();
+    if (!all.contains(analysisName)) return;
+    all.remove(analysisName);
+    m_fullProjectData["fit_checkpoints"] = all;
+    writeFitCheckpoints();
+}
+
+void ModelParameter::writeFitCheckpoints() const
+{
+    if (m_projectFilePath.isEmpty()) return;
+
+    QJsonObject dataObj;
+    dataObj["fit_checkpoints"] = m_fullProjectData.value("fit_checkpoints").toObject();
+
+    // 先写临时文件再替换，避免写入过程中崩溃导致检查点文件损坏
+    QSaveFile file(getFitCheckpointFilePath());
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(dataObj).toJson());
+        if (!file.commit()) qDebug() << "拟合检查点保存失败:" << getFitCheckpointFilePath();
+    }
+}
+
+// 保存历史拟合解缓存
+void ModelParameter::saveFitSolutions(const QJsonObject& solutions)
+{
+    m_fullProjectData["fit_solutions"] = solutions;
+    if (m_projectFilePath.isEmpty()) return;
+
+    QJsonObject dataObj;
+    dataObj["fit_solutions"] = solutions;
+
+    QSaveFile file(getFitCacheFilePath());
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(dataObj).toJson());
+        if (!file.commit()) qDebug() << "历史拟合解保存失败:" << getFitCacheFilePath();
+    }
+}
+
+QJsonObject ModelParameter::getFitSolutions() const
+{
+    return m_fullProjectData.value("fit_solutions").toObject();
+}
@@ -5,6 +5,8 @@
  * 1. 管理项目核心数据（孔隙度、粘度等）和文件路径。
  * 2. 负责 _chart.json (图表) 和 _date.json (表格) 的路径生成和存取。
  * 3. 确保项目保存和加载时，数据表格的内容能被正确持久化。
+ * 4. 负责 _fitckpt.json (拟合检查点) 的存取，供中断的拟合继续运行。
+ * 5. 负责 _fitcache.json (历史拟合解缓存) 的存取，供拟合热启动。
  */
 
 #ifndef MODELPARAMETER_H
@@ -76,6 +78,17 @@ public:
     // DataEditorWidget 加载项目时调用此函数恢复界面
     QJsonArray getTableData() const;
 
+    // 保存拟合检查点到 "_fitckpt.json"（按分析页名称区分）
+    // 未打开项目时只保存在内存中，当前会话内仍可继续拟合
+    void saveFitCheckpoint(const QString& analysisName, const QJsonObject& checkpoint);
+    QJsonObject getFitCheckpoint(const QString& analysisName) const;
+    void removeFitCheckpoint(const QString& analysisName);
+
+    // 历史拟合解缓存 "_fitcache.json"（结构由 FittingSolutionCache 维护）
+    // 未打开项目时只保存在内存中
+    void saveFitSolutions(const QJsonObject& solutions);
+    QJsonObject getFitSolutions() const;
+
 private:
     explicit ModelParameter(QObject* parent = nullptr);
     static ModelParameter* m_instance;
@@ -99,6 +112,10 @@ private:
     // 辅助：获取附属文件的绝对路径
     QString getPlottingDataFilePath() const;
     QString getTableDataFilePath() const;
+    QString getFitCheckpointFilePath() const;
+    QString getFitCacheFilePath() const;
+    // 将内存中的全部检查点写入 _fitckpt.json
+    void writeFitCheckpoints() const;
 };
 
 #endif // MODELPARAMETER_H
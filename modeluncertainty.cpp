@@ -0,0 +1,277 @@
+/*
+ * modeluncertainty.cpp
+ * 文件作用：理论模型的蒙特卡洛不确定性传播计算实现文件
+ * 功能描述：
+ * 1. 全部样本在启动时按随机种子一次抽取，结果可复现；计算期间样本与分组不再改变
+ * 2. 各分组只写入自己样本对应的曲线行，并行计算无需加锁
+ * 3. 分组内以第一个样本为参考，在覆盖全部平移量的加密时间网格上反演一次，
+ *    其余样本按 t·r 双对数插值并乘以压力比例得到曲线（导数为对数导数，同样只做竖直平移）
+ */
+
+#include "modeluncertainty.h"
+#include "fittingseparable.h"
+
+#include <QtConcurrent>
+#include <QElapsedTimer>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
+
+double UncertainParam::sample(std::mt19937_64& rng) const
+{
+    switch (dist) {
+    case Uniform: {
+        std::uniform_real_distribution<double> u(qMin(a, b), qMax(a, b));
+        return u(rng);
+    }
+    case Normal: {
+        if (a <= 0) return value;
+        std::normal_distribution<double> n(value, a);
+        double v = n(rng);
+        // 基准值为正的物性参数截断为正值，多次重抽仍失败时取基准值
+        for (int i = 0; value > 0 && v <= 0 && i < 100; ++i) v = n(rng);
+        return (value > 0 && v <= 0) ? value : v;
+    }
+    case LogNormal: {
+        if (value <= 0 || a <= 0) return value;
+        std::lognormal_distribution<double> ln(std::log(value), a);
+        return ln(rng);
+    }
+    case Triangular: {
+        double lo = qMin(a, b), hi = qMax(a, b);
+        double mode = qBound(lo, value, hi);
+        if (hi - lo <= 0) return mode;
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        double x = u(rng);
+        double f = (mode - lo) / (hi - lo);
+        if (x < f) return lo + std::sqrt(x * (hi - lo) * (mode - lo));
+        return hi - std::sqrt((1.0 - x) * (hi - lo) * (hi - mode));
+    }
+    default:
+        return value;
+    }
+}
+
+QStringList UncertainParam::distributionNames()
+{
+    return { "固定", "均匀", "正态", "对数正态", "三角" };
+}
+
+ModelUncertainty::ModelUncertainty(const Evaluator& evaluator, QObject* parent)
+    : QObject(parent)
+    , m_evaluator(evaluator)
+    , m_validCount(0)
+    , m_evaluationCounter(0)
+    , m_evaluations(0)
+    , m_elapsed(0.0)
+{
+    connect(&m_watcher, &QFutureWatcher<void>::finished, this, &ModelUncertainty::finished);
+}
+
+ModelUncertainty::~ModelUncertainty()
+{
+    m_cancelToken.cancel();
+    m_watcher.waitForFinished();
+}
+
+bool ModelUncertainty::isTimeScaleParam(const QString& name)
+{
+    return name == "phi" || name == "mu" || name == "Ct";
+}
+
+bool ModelUncertainty::isPressureScaleParam(const QString& name)
+{
+    return name == "q" || name == "mu" || name == "B" || name == "h";
+}
+
+double ModelUncertainty::timeScale(const QMap<QString, double>& p)
+{
+    double v = p.value("phi", 0.05) * p.value("mu", 0.5) * p.value("Ct", 5e-4);
+    return v > 0 ? 1.0 / v : 0.0;
+}
+
+double ModelUncertainty::pressureScale(const QMap<QString, double>& p)
+{
+    double h = p.value("h", 20.0);
+    return h > 0 ? p.value("q", 5.0) * p.value("mu", 0.5) * p.value("B", 1.05) / h : 0.0;
+}
+
+void ModelUncertainty::start(const QMap<QString, double>& baseParams, const QList<UncertainParam>& dists,
+                             const QVector<double>& t, int sampleCount, quint64 seed)
+{
+    if (isRunning() || !m_evaluator || t.size() < 2 || sampleCount <= 0) return;
+
+    m_time = t;
+    for (int b = 0; b < 3; ++b) { m_pBands[b].clear(); m_dBands[b].clear(); }
+    m_validCount = 0;
+    m_evaluations = 0;
+    m_evaluationCounter.storeRelaxed(0);
+    m_elapsed = 0.0;
+
+    // 1. 抽样（界面线程一次完成，保证给定种子时结果可复现）
+    QList<UncertainParam> randomParams;
+    for (const UncertainParam& up : dists) if (up.isRandom()) randomParams.append(up);
+
+    std::mt19937_64 rng(seed);
+    m_samples = QVector<QMap<QString, double>>(sampleCount, baseParams);
+    for (QMap<QString, double>& s : m_samples) {
+        for (const UncertainParam& up : randomParams) s[up.name] = up.sample(rng);
+        if (s.value("L") > 1e-9) s["LfD"] = s.value("Lf") / s.value("L");
+    }
+
+    // 2. 按形状参数分组：只有缩放参数不同的样本共用一条无因次曲线
+    QStringList shapeNames;
+    for (const UncertainParam& up : randomParams)
+        if (!isTimeScaleParam(up.name) && !isPressureScaleParam(up.name)) shapeNames << up.name;
+
+    std::map<std::vector<double>, QVector<int>> groupMap;
+    for (int i = 0; i < sampleCount; ++i) {
+        std::vector<double> key;
+        key.reserve(shapeNames.size());
+        for (const QString& name : shapeNames) key.push_back(m_samples[i].value(name));
+        groupMap[key].append(i);
+    }
+    m_groups.clear();
+    m_groups.reserve(int(groupMap.size()));
+    for (auto& it : groupMap) m_groups.append(it.second);
+
+    const int n = m_time.size();
+    m_pCurves = QVector<double>(sampleCount * n, 0.0);
+    m_dCurves = QVector<double>(sampleCount * n, 0.0);
+    m_valid = QVector<char>(sampleCount, 0);
+    m_cancelToken.reset();
+
+    m_watcher.setFuture(QtConcurrent::run([this]() { compute(); }));
+}
+
+void ModelUncertainty::cancel()
+{
+    m_cancelToken.cancel();
+}
+
+bool ModelUncertainty::isRunning() const
+{
+    return m_watcher.isRunning();
+}
+
+void ModelUncertainty::evaluateGroup(const QVector<int>& group, double* pRows, double* dRows, char* valid)
+{
+    const int n = m_time.size();
+    const QMap<QString, double>& ref = m_samples.at(group.first());
+
+    if (group.size() == 1) {
+        ModelCurveData curve = m_evaluator(ref, m_time, &m_cancelToken);
+        m_evaluationCounter.fetchAndAddRelaxed(1);
+        const QVector<double>& p = std::get<1>(curve);
+        const QVector<double>& d = std::get<2>(curve);
+        if (p.size() != n || d.size() != n) return;   // 已取消
+        int row = group.first();
+        std::copy(p.begin(), p.end(), pRows + row * n);
+        std::copy(d.begin(), d.end(), dRows + row * n);
+        valid[row] = 1;
+        return;
+    }
+
+    // 相对参考样本的时间/压力平移量
+    double refT = timeScale(ref), refP = pressureScale(ref);
+    if (refT <= 0 || refP <= 0) return;
+    QVector<double> rT(group.size()), rP(group.size());
+    double rMin = 1.0, rMax = 1.0;
+    for (int j = 0; j < group.size(); ++j) {
+        rT[j] = timeScale(m_samples.at(group[j])) / refT;
+        rP[j] = pressureScale(m_samples.at(group[j])) / refP;
+        rMin = qMin(rMin, rT[j]);
+        rMax = qMax(rMax, rT[j]);
+    }
+
+    // 加密时间网格：覆盖 [t0·rMin, tn·rMax]，点密度不低于原网格且每个对数周期至少 20 点
+    double t0 = m_time.first() * rMin, t1 = m_time.last() * rMax;
+    if (!(t0 > 0) || !(t1 > t0)) return;
+    double decades = std::log10(t1 / t0);
+    double srcDensity = (n - 1) / qMax(1e-9, std::log10(m_time.last() / m_time.first()));
+    int denseCount = qMax(n, int(std::ceil(decades * qMax(20.0, srcDensity))) + 1);
+    QVector<double> dense(denseCount);
+    for (int i = 0; i < denseCount; ++i) dense[i] = std::pow(10.0, std::log10(t0) + decades * i / (denseCount - 1));
+
+    ModelCurveData curve = m_evaluator(ref, dense, &m_cancelToken);
+    m_evaluationCounter.fetchAndAddRelaxed(1);
+    const QVector<double>& p = std::get<1>(curve);
+    const QVector<double>& d = std::get<2>(curve);
+    if (p.size() != denseCount || d.size() != denseCount) return;   // 已取消
+
+    for (int j = 0; j < group.size(); ++j) {
+        int row = group[j];
+        QVector<double> ps = FittingSeparable::interpolateLogLog(dense, p, m_time, rT[j]);
+        QVector<double> ds = FittingSeparable::interpolateLogLog(dense, d, m_time, rT[j]);
+        double* pOut = pRows + row * n;
+        double* dOut = dRows + row * n;
+        for (int k = 0; k < n; ++k) { pOut[k] = rP[j] * ps[k]; dOut[k] = rP[j] * ds[k]; }
+        valid[row] = 1;
+    }
+}
+
+void ModelUncertainty::compute()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // 曲线缓存大小固定，先取得可写指针，避免并行写入时发生隐式共享分离
+    double* pRows = m_pCurves.data();
+    double* dRows = m_dCurves.data();
+    char* valid = m_valid.data();
+
+    const int total = m_samples.size();
+    const int batchSize = qMax(16, QThread::idealThreadCount() * 8);
+    int done = 0;
+    for (int start = 0; start < m_groups.size(); start += batchSize) {
+        QVector<QVector<int>> batch = m_groups.mid(start, batchSize);
+        QtConcurrent::blockingMap(batch, [this, pRows, dRows, valid](const QVector<int>& group) {
+            if (!m_cancelToken.isCancelled()) evaluateGroup(group, pRows, dRows, valid);
+        });
+        if (m_cancelToken.isCancelled()) return;
+        for (const QVector<int>& group : batch) done += group.size();
+        emit progressChanged(done * 100 / total);
+    }
+
+    computeBands();
+    m_evaluations = m_evaluationCounter.loadRelaxed();
+    m_elapsed = timer.elapsed() / 1000.0;
+}
+
+void ModelUncertainty::computeBands()
+{
+    const int n = m_time.size();
+    const double q[3] = { 0.1, 0.5, 0.9 };
+    for (int b = 0; b < 3; ++b) { m_pBands[b] = QVector<double>(n, 0.0); m_dBands[b] = QVector<double>(n, 0.0); }
+
+    m_validCount = int(std::count(m_valid.begin(), m_valid.end(), char(1)));
+    if (m_validCount == 0) { for (int b = 0; b < 3; ++b) { m_pBands[b].clear(); m_dBands[b].clear(); } return; }
+
+    // 分位数：有序样本间线性插值
+    auto quantiles = [&q](std::vector<double>& v, double* out) {
+        std::sort(v.begin(), v.end());
+        for (int b = 0; b < 3; ++b) {
+            double pos = q[b] * (v.size() - 1);
+            size_t lo = size_t(pos);
+            size_t hi = qMin(lo + 1, v.size() - 1);
+            out[b] = v[lo] + (pos - lo) * (v[hi] - v[lo]);
+        }
+    };
+
+    std::vector<double> pv, dv;
+    pv.reserve(m_validCount); dv.reserve(m_validCount);
+    for (int k = 0; k < n; ++k) {
+        pv.clear(); dv.clear();
+        for (int i = 0; i < m_samples.size(); ++i) {
+            if (!m_valid[i]) continue;
+            pv.push_back(m_pCurves[i * n + k]);
+            dv.push_back(m_dCurves[i * n + k]);
+        }
+        double pq[3], dq[3];
+        quantiles(pv, pq);
+        quantiles(dv, dq);
+        for (int b = 0; b < 3; ++b) { m_pBands[b][k] = pq[b]; m_dBands[b][k] = dq[b]; }
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * modeluncertainty.h
+ * 文件作用：理论模型的蒙特卡洛不确定性传播计算头文件
+ * 功能描述：
+ * 1. 为每个模型参数指定概率分布（固定/均匀/正态/对数正态/三角），按随机种子抽取样本
+ * 2. 样本分批通过 QtConcurrent 并行计算正演曲线，可通过 CancellationToken 随时取消
+ * 3. 逐时间点统计压力与导数的 P10 / P50 / P90 分位数包络
+ * 4. 无因次曲线缓存：phi、Ct、mu 只引起双对数曲线的水平平移，q、mu、B、h 只引起竖直平移，
+ *    形状参数相同的样本共用一条无因次曲线，按平移量插值得到各自的曲线，不再重复反演
+ */
+
+#ifndef MODELUNCERTAINTY_H
+#define MODELUNCERTAINTY_H
+
+#include <QObject>
+#include <QMap>
+#include <QVector>
+#include <QFutureWatcher>
+#include <functional>
+#include <random>
+#include "modelwidget01-06.h"
+#include "cancellationtoken.h"
+
+// 单个参数的概率分布
+struct UncertainParam {
+    enum Distribution {
+        Fixed = 0,      // 固定值 value
+        Uniform,        // 均匀分布 [a, b]
+        Normal,         // 正态分布，均值 value，标准差 a（基准值为正时截断为正值）
+        LogNormal,      // 对数正态分布，中位数 value，对数标准差 a
+        Triangular      // 三角分布，下限 a，众数 value，上限 b
+    };
+
+    QString name;
+    Distribution dist;
+    double value;
+    double a;
+    double b;
+
+    UncertainParam() : dist(Fixed), value(0.0), a(0.0), b(0.0) {}
+    bool isRandom() const { return dist != Fixed; }
+    double sample(std::mt19937_64& rng) const;
+
+    static QStringList distributionNames();
+};
+
+class ModelUncertainty : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 正演计算函数：参数、时间序列、取消令牌 -> 理论曲线（取消时返回空曲线），须可在工作线程并行调用
+    using Evaluator = std::function<ModelCurveData(const QMap<QString, double>&, const QVector<double>&, const CancellationToken*)>;
+
+    explicit ModelUncertainty(const Evaluator& evaluator, QObject* parent = nullptr);
+    ~ModelUncertainty();
+
+    // 启动后台计算；baseParams 中未在 dists 出现的参数保持固定
+    void start(const QMap<QString, double>& baseParams, const QList<UncertainParam>& dists,
+               const QVector<double>& t, int sampleCount, quint64 seed);
+    void cancel();
+    bool isRunning() const;
+
+    // --- 计算结果（finished 且未取消时有效）---
+    const QVector<double>& time() const { return m_time; }
+    // band: 0 = P10, 1 = P50, 2 = P90
+    const QVector<double>& pressureBand(int band) const { return m_pBands[qBound(0, band, 2)]; }
+    const QVector<double>& derivativeBand(int band) const { return m_dBands[qBound(0, band, 2)]; }
+    int validSamples() const { return m_validCount; }
+    int modelEvaluations() const { return m_evaluations; }  // 实际反演次数（共用缓存后小于样本数）
+    double elapsedSeconds() const { return m_elapsed; }
+    bool hasResult() const { return !m_pBands[1].isEmpty(); }
+
+signals:
+    void progressChanged(int percent);
+    void finished();
+
+private:
+    void compute();     // 工作线程
+    void evaluateGroup(const QVector<int>& group, double* pRows, double* dRows, char* valid);
+    void computeBands();
+
+    static bool isTimeScaleParam(const QString& name);
+    static bool isPressureScaleParam(const QString& name);
+    static double timeScale(const QMap<QString, double>& p);      // 1 / (phi·mu·Ct)
+    static double pressureScale(const QMap<QString, double>& p);  // q·mu·B / h
+
+    Evaluator m_evaluator;
+    QVector<double> m_time;
+    QVector<QMap<QString, double>> m_samples;
+    QVector<QVector<int>> m_groups;      // 形状参数相同的样本分组
+
+    // 样本曲线，行主序：样本 i 的第 k 个时间点位于 i * m_time.size() + k
+    QVector<double> m_pCurves;
+    QVector<double> m_dCurves;
+    QVector<char> m_valid;
+
+    QVector<double> m_pBands[3];
+    QVector<double> m_dBands[3];
+    int m_validCount;
+    QAtomicInt m_evaluationCounter;
+    int m_evaluations;
+    double m_elapsed;
+
+    CancellationToken m_cancelToken;
+    QFutureWatcher<void> m_watcher;
+};
+
+#endif // MODELUNCERTAINTY_H
@@ -0,0 +1,270 @@
+/*
+ * modeluncertaintydialog.cpp
+ * 文件作用：蒙特卡洛不确定性分析弹窗的具体实现
+ * 功能描述：
+ * 1. 参数表默认全部为固定值，切换分布类型时按基准值填入常用的分布参数
+ * 2. P10 ~ P90 区间以半透明色带填充，P50 以实线绘制（压力红色、导数蓝色）
+ */
+
+#include "modeluncertaintydialog.h"
+#include "ui_modeluncertaintydialog.h"
+#include "mousezoom.h"
+#include "modelparameter.h"
+#include <QComboBox>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QTextStream>
+#include <cmath>
+
+ModelUncertaintyDialog::ModelUncertaintyDialog(const ModelUncertainty::Evaluator& evaluator, const QMap<QString, double>& baseParams,
+                                               const QStringList& paramNames, const QVector<double>& t, const QString& modelName,
+                                               QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::ModelUncertaintyDialog),
+    m_baseParams(baseParams),
+    m_paramNames(paramNames),
+    m_time(t)
+{
+    ui->setupUi(this);
+    this->setWindowTitle("不确定性分析 - " + modelName);
+
+    m_uncertainty = new ModelUncertainty(evaluator, this);
+
+    connect(ui->btnRun, &QPushButton::clicked, this, &ModelUncertaintyDialog::onRun);
+    connect(ui->btnStop, &QPushButton::clicked, this, &ModelUncertaintyDialog::onStop);
+    connect(ui->btnExport, &QPushButton::clicked, this, &ModelUncertaintyDialog::onExport);
+    connect(ui->btnClose, &QPushButton::clicked, this, &ModelUncertaintyDialog::reject);
+    connect(m_uncertainty, &ModelUncertainty::progressChanged, ui->progressBar, &QProgressBar::setValue);
+    connect(m_uncertainty, &ModelUncertainty::finished, this, &ModelUncertaintyDialog::onFinished);
+
+    initTable();
+    setupPlot();
+    updateButtons();
+}
+
+ModelUncertaintyDialog::~ModelUncertaintyDialog()
+{
+    delete ui;
+}
+
+void ModelUncertaintyDialog::initTable()
+{
+    QStringList headers;
+    headers << "参数" << "分布" << "基准值" << "参数 a" << "参数 b";
+    ui->tableParams->setColumnCount(headers.size());
+    ui->tableParams->setHorizontalHeaderLabels(headers);
+    ui->tableParams->setRowCount(m_paramNames.size());
+    ui->tableParams->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    ui->tableParams->horizontalHeaderItem(3)->setToolTip("均匀/三角: 下限；正态: 标准差；对数正态: 对数标准差");
+    ui->tableParams->horizontalHeaderItem(4)->setToolTip("均匀/三角: 上限");
+
+    for (int i = 0; i < m_paramNames.size(); ++i) {
+        const QString& name = m_paramNames[i];
+
+        QTableWidgetItem* nameItem = new QTableWidgetItem(name);
+        nameItem->setFlags(nameItem->flags() & ~Qt::ItemIsEditable);
+        ui->tableParams->setItem(i, 0, nameItem);
+
+        QComboBox* combo = new QComboBox();
+        combo->addItems(UncertainParam::distributionNames());
+        ui->tableParams->setCellWidget(i, 1, combo);
+        connect(combo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this, i]() { onDistributionChanged(i); });
+
+        ui->tableParams->setItem(i, 2, new QTableWidgetItem(QString::number(m_baseParams.value(name), 'g', 6)));
+        ui->tableParams->setItem(i, 3, new QTableWidgetItem());
+        ui->tableParams->setItem(i, 4, new QTableWidgetItem());
+    }
+}
+
+void ModelUncertaintyDialog::onDistributionChanged(int row)
+{
+    QComboBox* combo = qobject_cast<QComboBox*>(ui->tableParams->cellWidget(row, 1));
+    if (!combo) return;
+    double v = ui->tableParams->item(row, 2)->text().toDouble();
+
+    // 按基准值填入常用的分布参数：±20% 区间、10% 变异系数、0.2 对数标准差
+    QString a, b;
+    switch (combo->currentIndex()) {
+    case UncertainParam::Uniform:
+    case UncertainParam::Triangular:
+        a = QString::number(v * 0.8, 'g', 6);
+        b = QString::number(v * 1.2, 'g', 6);
+        break;
+    case UncertainParam::Normal:
+        a = QString::number(std::abs(v) * 0.1, 'g', 6);
+        break;
+    case UncertainParam::LogNormal:
+        a = "0.2";
+        break;
+    default:
+        break;
+    }
+    ui->tableParams->item(row, 3)->setText(a);
+    ui->tableParams->item(row, 4)->setText(b);
+}
+
+QList<UncertainParam> ModelUncertaintyDialog::collectDistributions(QString* error) const
+{
+    QList<UncertainParam> list;
+    for (int i = 0; i < ui->tableParams->rowCount(); ++i) {
+        QComboBox* combo = qobject_cast<QComboBox*>(ui->tableParams->cellWidget(i, 1));
+        UncertainParam up;
+        up.name = ui->tableParams->item(i, 0)->text();
+        up.dist = UncertainParam::Distribution(combo ? combo->currentIndex() : 0);
+        up.value = ui->tableParams->item(i, 2)->text().toDouble();
+        up.a = ui->tableParams->item(i, 3)->text().toDouble();
+        up.b = ui->tableParams->item(i, 4)->text().toDouble();
+
+        bool ok = true;
+        if (up.dist == UncertainParam::Uniform) ok = up.b > up.a;
+        else if (up.dist == UncertainParam::Triangular) ok = up.b > up.a && up.value >= up.a && up.value <= up.b;
+        else if (up.dist == UncertainParam::Normal) ok = up.a > 0;
+        else if (up.dist == UncertainParam::LogNormal) ok = up.a > 0 && up.value > 0;
+        if (!ok) {
+            if (error) *error = QString("参数 %1 的分布设置无效。").arg(up.name);
+            return QList<UncertainParam>();
+        }
+        list.append(up);
+    }
+    return list;
+}
+
+void ModelUncertaintyDialog::setupPlot()
+{
+    m_plot = new MouseZoom(this);
+    ui->plotContainer->layout()->addWidget(m_plot);
+    m_plot->setBackground(Qt::white);
+
+    QSharedPointer<QCPAxisTickerLog> logTicker(new QCPAxisTickerLog);
+    m_plot->xAxis->setScaleType(QCPAxis::stLogarithmic); m_plot->xAxis->setTicker(logTicker);
+    m_plot->yAxis->setScaleType(QCPAxis::stLogarithmic); m_plot->yAxis->setTicker(logTicker);
+    m_plot->xAxis->setNumberFormat("eb"); m_plot->xAxis->setNumberPrecision(0);
+    m_plot->yAxis->setNumberFormat("eb"); m_plot->yAxis->setNumberPrecision(0);
+    m_plot->xAxis->setLabel("时间 Time (h)");
+    m_plot->yAxis->setLabel("压力 & 导数 Pressure & Derivative (MPa)");
+    m_plot->axisRect()->setupFullAxesBox(true);
+    m_plot->xAxis2->setScaleType(QCPAxis::stLogarithmic); m_plot->yAxis2->setScaleType(QCPAxis::stLogarithmic);
+    m_plot->xAxis2->setTicker(logTicker); m_plot->yAxis2->setTicker(logTicker);
+    m_plot->xAxis->grid()->setSubGridVisible(true); m_plot->yAxis->grid()->setSubGridVisible(true);
+
+    m_plot->legend->setVisible(true);
+    m_plot->legend->setFont(QFont("Arial", 9));
+    m_plot->legend->setBrush(QBrush(QColor(255, 255, 255, 200)));
+}
+
+void ModelUncertaintyDialog::plotBands()
+{
+    m_plot->clearGraphs();
+    const QVector<double>& t = m_uncertainty->time();
+
+    auto addBand = [this, &t](const QVector<double>& p10, const QVector<double>& p50, const QVector<double>& p90,
+                              const QColor& color, const QString& name) {
+        QColor fill = color; fill.setAlpha(50);
+        QPen edge(color, 1, Qt::DotLine);
+
+        QCPGraph* g10 = m_plot->addGraph();
+        g10->setData(t, p10);
+        g10->setPen(edge);
+        g10->removeFromLegend();
+
+        QCPGraph* g90 = m_plot->addGraph();
+        g90->setData(t, p90);
+        g90->setPen(edge);
+        g90->setBrush(QBrush(fill));
+        g90->setChannelFillGraph(g10);
+        g90->setName(name + " P10~P90");
+
+        QCPGraph* g50 = m_plot->addGraph();
+        g50->setData(t, p50);
+        g50->setPen(QPen(color, 2));
+        g50->setName(name + " P50");
+    };
+    addBand(m_uncertainty->pressureBand(0), m_uncertainty->pressureBand(1), m_uncertainty->pressureBand(2), Qt::red, "压力");
+    addBand(m_uncertainty->derivativeBand(0), m_uncertainty->derivativeBand(1), m_uncertainty->derivativeBand(2), Qt::blue, "导数");
+
+    m_plot->rescaleAxes();
+    if (m_plot->yAxis->range().lower <= 0) m_plot->yAxis->setRangeLower(1e-3);
+    m_plot->replot();
+}
+
+void ModelUncertaintyDialog::onRun()
+{
+    if (m_uncertainty->isRunning()) return;
+
+    QString error;
+    QList<UncertainParam> dists = collectDistributions(&error);
+    if (!error.isEmpty()) { QMessageBox::warning(this, "提示", error); return; }
+
+    QMap<QString, double> base = m_baseParams;
+    bool anyRandom = false;
+    for (const UncertainParam& up : dists) {
+        base[up.name] = up.value;
+        anyRandom = anyRandom || up.isRandom();
+    }
+    if (!anyRandom) { QMessageBox::warning(this, "提示", "请至少为一个参数指定随机分布。"); return; }
+
+    ui->progressBar->setValue(0);
+    ui->labelResult->setText("计算中...");
+    m_uncertainty->start(base, dists, m_time, ui->spinSamples->value(), quint64(ui->spinSeed->value()));
+    updateButtons();
+}
+
+void ModelUncertaintyDialog::onStop()
+{
+    m_uncertainty->cancel();
+}
+
+void ModelUncertaintyDialog::onFinished()
+{
+    updateButtons();
+    if (!m_uncertainty->hasResult()) {
+        ui->labelResult->setText("计算已取消");
+        return;
+    }
+    ui->labelResult->setText(QString("有效样本: %1 / %2   模型反演: %3 次   耗时: %4 s")
+                             .arg(m_uncertainty->validSamples()).arg(ui->spinSamples->value())
+                             .arg(m_uncertainty->modelEvaluations()).arg(m_uncertainty->elapsedSeconds(), 0, 'f', 2));
+    plotBands();
+}
+
+void ModelUncertaintyDialog::onExport()
+{
+    if (!m_uncertainty->hasResult()) return;
+    QString defaultDir = ModelParameter::instance()->getProjectPath();
+    if (defaultDir.isEmpty()) defaultDir = ".";
+    QString path = QFileDialog::getSaveFileName(this, "导出包络数据", defaultDir + "/UncertaintyBands.csv", "CSV Files (*.csv)");
+    if (path.isEmpty()) return;
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QMessageBox::critical(this, "错误", "无法写入文件。");
+        return;
+    }
+    QTextStream out(&f);
+    out << "t,Dp_P10,Dp_P50,Dp_P90,dDp_P10,dDp_P50,dDp_P90\n";
+    const QVector<double>& t = m_uncertainty->time();
+    for (int i = 0; i < t.size(); ++i) {
+        out << t[i];
+        for (int b = 0; b < 3; ++b) out << "," << m_uncertainty->pressureBand(b)[i];
+        for (int b = 0; b < 3; ++b) out << "," << m_uncertainty->derivativeBand(b)[i];
+        out << "\n";
+    }
+    f.close();
+    QMessageBox::information(this, "导出成功", "包络数据已保存");
+}
+
+void ModelUncertaintyDialog::reject()
+{
+    m_uncertainty->cancel();
+    QDialog::reject();
+}
+
+void ModelUncertaintyDialog::updateButtons()
+{
+    bool running = m_uncertainty->isRunning();
+    ui->tableParams->setEnabled(!running);
+    ui->spinSamples->setEnabled(!running);
+    ui->spinSeed->setEnabled(!running);
+    ui->btnRun->setEnabled(!running);
+    ui->btnStop->setEnabled(running);
+    ui->btnExport->setEnabled(!running && m_uncertainty->hasResult());
+}
@@ -0,0 +1,57 @@
+#ifndef MODELUNCERTAINTYDIALOG_H
+#define MODELUNCERTAINTYDIALOG_H
+
+#include <QDialog>
+#include "modeluncertainty.h"
+
+namespace Ui {
+class ModelUncertaintyDialog;
+}
+
+class MouseZoom;
+
+// ===========================================================================
+// 类名：ModelUncertaintyDialog
+// 作用：理论模型蒙特卡洛不确定性分析弹窗
+// 功能：
+// 1. 在表格中为各参数指定分布类型及分布参数，设置样本数与随机种子
+// 2. 后台并行计算全部样本的正演曲线，显示进度、反演次数与耗时
+// 3. 在双对数图中绘制压力与导数的 P10 / P50 / P90 包络，可导出 CSV
+// ===========================================================================
+
+class ModelUncertaintyDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    ModelUncertaintyDialog(const ModelUncertainty::Evaluator& evaluator, const QMap<QString, double>& baseParams,
+                           const QStringList& paramNames, const QVector<double>& t, const QString& modelName,
+                           QWidget *parent = nullptr);
+    ~ModelUncertaintyDialog();
+
+protected:
+    void reject() override;
+
+private slots:
+    void onDistributionChanged(int row);
+    void onRun();
+    void onStop();
+    void onFinished();
+    void onExport();
+
+private:
+    Ui::ModelUncertaintyDialog *ui;
+    ModelUncertainty* m_uncertainty;
+    QMap<QString, double> m_baseParams;
+    QStringList m_paramNames;
+    QVector<double> m_time;
+    MouseZoom* m_plot;
+
+    void initTable();
+    void setupPlot();
+    void plotBands();
+    void updateButtons();
+    QList<UncertainParam> collectDistributions(QString* error) const;
+};
+
+#endif // MODELUNCERTAINTYDIALOG_H
@@ -14,6 +14,7 @@
 #include "modelmanager.h"
 #include "pressurederivativecalculator.h"
 #include "modelparameter.h"
+#include "modeluncertaintydialog.h"
 
 #include <Eigen/Dense>
 #include <boost/math/special_functions/bessel.hpp>
@@ -140,6 +141,7 @@ void ModelWidget01_06::setupConnections() {
     connect(ui->LEdit, &QLineEdit::editingFinished, this, &ModelWidget01_06::onDependentParamsChanged);
     connect(ui->LfEdit, &QLineEdit::editingFinished, this, &ModelWidget01_06::onDependentParamsChanged);
     connect(ui->checkShowPoints, &QCheckBox::toggled, this, &ModelWidget01_06::onShowPointsToggled);
+    connect(ui->btnUncertainty, &QPushButton::clicked, this, &ModelWidget01_06::onUncertaintyClicked);
 }
 
 void ModelWidget01_06::setHighPrecision(bool high) { m_highPrecision = high; }
@@ -232,9 +234,7 @@ void ModelWidget01_06::onCalculateClicked() {
     ui->calculateButton->setText("开始计算");
 }
 
-void ModelWidget01_06::runCalculation() {
-    m_plot->clearGraphs();
-
+QMap<QString, QVector<double>> ModelWidget01_06::collectRawParams() {
     QMap<QString, QVector<double>> rawParams;
     rawParams["phi"] = parseInput(ui->phiEdit->text());
     rawParams["h"] = parseInput(ui->hEdit->text());
@@ -265,6 +265,13 @@ void ModelWidget01_06::runCalculation() {
         rawParams["cD"] = {0.0};
         rawParams["S"] = {0.0};
     }
+    return rawParams;
+}
+
+void ModelWidget01_06::runCalculation() {
+    m_plot->clearGraphs();
+
+    QMap<QString, QVector<double>> rawParams = collectRawParams();
 
     // 敏感性分析检测
     QString sensitivityKey = "";
@@ -336,6 +343,39 @@ void ModelWidget01_06::runCalculation() {
     emit calculationCompleted(getModelName(), baseParams);
 }
 
+void ModelWidget01_06::onUncertaintyClicked() {
+    // 基准参数取各输入框的第一个值
+    QMap<QString, QVector<double>> rawParams = collectRawParams();
+    QMap<QString, double> baseParams;
+    for(auto it = rawParams.begin(); it != rawParams.end(); ++it) {
+        baseParams[it.key()] = it.value().isEmpty() ? 0.0 : it.value().first();
+    }
+    baseParams["N"] = m_highPrecision ? 8.0 : 4.0;
+    baseParams["LfD"] = (baseParams["L"] > 1e-9) ? baseParams["Lf"] / baseParams["L"] : 0.0;
+
+    int nPoints = qMax(5, ui->pointsEdit->text().toInt());
+    double maxTime = baseParams.value("t", 1000.0);
+    if(maxTime < 1e-3) maxTime = 1000.0;
+    QVector<double> t = ModelManager::generateLogTimeSteps(nPoints, -3.0, log10(maxTime));
+
+    // 可设置分布的参数：排除时间、反演阶数、派生参数及当前模型未使用的参数
+    QStringList names;
+    for(auto it = baseParams.begin(); it != baseParams.end(); ++it) {
+        const QString& key = it.key();
+        if (key == "t" || key == "N" || key == "LfD") continue;
+        if (key == "reD" && !ui->reDEdit->isVisible()) continue;
+        if ((key == "cD" || key == "S") && !ui->cDEdit->isVisible()) continue;
+        names << key;
+    }
+
+    // 正演在工作线程并行执行；对话框为模态，本控件在计算期间保持有效
+    ModelUncertainty::Evaluator evaluator = [this](const QMap<QString, double>& p, const QVector<double>& time, const CancellationToken* token) {
+        return calculateTheoreticalCurve(p, time, token);
+    };
+    ModelUncertaintyDialog dlg(evaluator, baseParams, names, t, getModelName(), this);
+    dlg.exec();
+}
+
 void ModelWidget01_06::plotCurve(const ModelCurveData& data, const QString& name, QColor color, bool isSensitivity) {
     const QVector<double>& t = std::get<0>(data);
     const QVector<double>& p = std::get<1>(data);
@@ -393,7 +433,8 @@ void ModelWidget01_06::onExportImage() {
     else QMessageBox::critical(this, "错误", "导出图表失败。");
 }
 
-ModelCurveData ModelWidget01_06::calculateTheoreticalCurve(const QMap<QString, double>& params, const QVector<double>& providedTime)
+ModelCurveData ModelWidget01_06::calculateTheoreticalCurve(const QMap<QString, double>& params, const QVector<double>& providedTime,
+                                                           const CancellationToken* token)
 {
     QVector<double> tPoints = providedTime;
     if (tPoints.isEmpty()) {
@@ -417,8 +458,9 @@ ModelCurveData ModelWidget01_06::calculateTheoreticalCurve(const QMap<QString, d
     }
 
     QVector<double> PD_vec, Deriv_vec;
-    auto func = std::bind(&ModelWidget01_06::flaplace_composite, this, std::placeholders::_1, std::placeholders::_2);
-    calculatePDandDeriv(tD_vec, params, func, PD_vec, Deriv_vec);
+    auto func = [this, token](double z, const QMap<QString, double>& p) { return flaplace_composite(z, p, token); };
+    calculatePDandDeriv(tD_vec, params, func, PD_vec, Deriv_vec, token);
+    if (PD_vec.size() != tPoints.size()) return ModelCurveData(); // 计算已取消
 
     double factor = 1.842e-3 * q * mu * B / (kf * h);
     QVector<double> finalP(tPoints.size()), finalDP(tPoints.size());
@@ -433,14 +475,15 @@ ModelCurveData ModelWidget01_06::calculateTheoreticalCurve(const QMap<QString, d
 
 void ModelWidget01_06::calculatePDandDeriv(const QVector<double>& tD, const QMap<QString, double>& params,
                                            std::function<double(double, const QMap<QString, double>&)> laplaceFunc,
-                                           QVector<double>& outPD, QVector<double>& outDeriv)
+                                           QVector<double>& outPD, QVector<double>& outDeriv,
+                                           const CancellationToken* token)
 {
     int numPoints = tD.size();
     outPD.resize(numPoints);
     outDeriv.resize(numPoints);
 
-    int N_param = (int)params.value("N", 4);
-    int N = m_highPrecision ? N_param : 4;
+    // 反演阶数：优先使用调用方传入的 N（拟合引擎按精度阶段逐次指定），否则按高精度开关取 8 或 4
+    int N = params.contains("N") ? (int)params.value("N") : (m_highPrecision ? 8 : 4);
     if (N % 2 != 0) N = 4;
     double ln2 = log(2.0);
 
@@ -448,6 +491,8 @@ void ModelWidget01_06::calculatePDandDeriv(const QVector<double>& tD, const QMap
     double gamaD = params.value("gamaD", 0.0);
 
     for (int k = 0; k < numPoints; ++k) {
+        // 按时间点检查取消请求，取消时清空输出
+        if (CancellationToken::isCancelled(token)) { outPD.clear(); outDeriv.clear(); return; }
         double t = tD[k];
         if (t <= 1e-12) { outPD[k] = 0; continue; }
         double pd_val = 0.0;
@@ -467,11 +512,13 @@ void ModelWidget01_06::calculatePDandDeriv(const QVector<double>& tD, const QMap
             }
         }
     }
+    // 最后一个时间点计算期间的取消会使拉氏函数返回 0，结果同样无效
+    if (CancellationToken::isCancelled(token)) { outPD.clear(); outDeriv.clear(); return; }
     if (numPoints > 2) outDeriv = PressureDerivativeCalculator::calculateBourdetDerivative(tD, outPD, 0.1);
     else outDeriv.fill(0.0);
 }
 
-double ModelWidget01_06::flaplace_composite(double z, const QMap<QString, double>& p) {
+double ModelWidget01_06::flaplace_composite(double z, const QMap<QString, double>& p, const CancellationToken* token) {
     double kf = p.value("kf");
     double km = p.value("km");
     double LfD = p.value("LfD");
@@ -492,7 +539,7 @@ double ModelWidget01_06::flaplace_composite(double z, const QMap<QString, double
     double fs2 = M12 * temp;
 
     // 调用通用 PWD 计算内核，内部包含边界判断逻辑
-    double pf = PWD_composite(z, fs1, fs2, M12, LfD, rmD, reD, nf, xwD, m_type);
+    double pf = PWD_composite(z, fs1, fs2, M12, LfD, rmD, reD, nf, xwD, m_type, token);
 
     // 考虑井筒储存和表皮 (对应 MATLAB: (z*pf+S)/(z+CD*z^2*(z*pf+S)))
     // 仅对变井储模型 (1, 3, 5) 启用
@@ -508,7 +555,8 @@ double ModelWidget01_06::flaplace_composite(double z, const QMap<QString, double
     return pf;
 }
 
-double ModelWidget01_06::PWD_composite(double z, double fs1, double fs2, double M12, double LfD, double rmD, double reD, int nf, const QVector<double>& xwD, ModelType type) {
+double ModelWidget01_06::PWD_composite(double z, double fs1, double fs2, double M12, double LfD, double rmD, double reD, int nf, const QVector<double>& xwD, ModelType type,
+                                       const CancellationToken* token) {
     using namespace boost::math;
     QVector<double> ywD(nf, 0.0);
     double gama1 = sqrt(z * fs1);
@@ -587,6 +635,8 @@ double ModelWidget01_06::PWD_composite(double z, double fs1, double fs2, double
     b_vec.setZero(); b_vec(nf) = 1.0;
 
     for (int i = 0; i < nf; ++i) {
+        // 裂缝间积分是最耗时的部分，逐行检查取消请求（结果随后会被丢弃）
+        if (CancellationToken::isCancelled(token)) return 0.0;
         for (int j = 0; j < nf; ++j) {
             // 积分核函数: K0 + Ac*I0
             auto integrand = [&](double a) -> double {
@@ -8,7 +8,13 @@
 
 #include "plottingdialog3.h"
 #include "ui_plottingdialog3.h"
+#include "smoothingengine.h"
+#include "lspacingselectdialog.h"
+#include "timetransform.h"
+#include "derivativeengine.h"
 #include <QColorDialog>
+#include <QMessageBox>
+#include <cmath>
 
 int PlottingDialog3::s_counter = 1;
 
@@ -33,9 +39,17 @@ PlottingDialog3::PlottingDialog3(QStandardItemModel* model, QWidget *parent) :
     populateComboBoxes();
     setupStyleOptions();
 
+    ui->comboSmoothMethod->addItems(SmoothingEngine::methodNames());
+    ui->comboTimeFunction->addItems(TimeTransform::functionNames());
+    ui->comboDerivAlgorithm->addItems(DerivativeEngine::algorithmNames());
+
     // 信号连接
     connect(ui->checkSmooth, &QCheckBox::toggled, this, &PlottingDialog3::onSmoothToggled);
+    connect(ui->comboSmoothMethod, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PlottingDialog3::updateSmoothControls);
     onSmoothToggled(ui->checkSmooth->isChecked());
+    connect(ui->btnAutoL, &QPushButton::clicked, this, &PlottingDialog3::onAutoLSpacing);
+    connect(ui->comboTimeFunction, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PlottingDialog3::onTimeFunctionChanged);
+    connect(ui->comboDerivAlgorithm, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PlottingDialog3::onDerivAlgorithmChanged);
 
     connect(ui->btnPressPointColor, &QPushButton::clicked, this, &PlottingDialog3::selectPressPointColor);
     connect(ui->btnPressLineColor, &QPushButton::clicked, this, &PlottingDialog3::selectPressLineColor);
@@ -58,6 +72,15 @@ void PlottingDialog3::populateComboBoxes()
     }
     ui->comboTime->addItems(headers);
     ui->comboPress->addItems(headers);
+    ui->comboRate->addItems(headers);
+
+    // 默认选中表头含产量关键字的列
+    for (int i = 0; i < headers.size(); ++i) {
+        if (headers[i].contains("产量") || headers[i].contains("rate", Qt::CaseInsensitive) || headers[i].startsWith("Q\\")) {
+            ui->comboRate->setCurrentIndex(i);
+            break;
+        }
+    }
 }
 
 void PlottingDialog3::setupStyleOptions()
@@ -93,7 +116,61 @@ void PlottingDialog3::setupStyleOptions()
 
 void PlottingDialog3::onSmoothToggled(bool checked)
 {
-    ui->spinSmooth->setEnabled(checked);
+    ui->comboSmoothMethod->setEnabled(checked);
+    updateSmoothControls();
+}
+
+// 按点数平滑使用窗口点数，对数时间方法使用对数窗口半宽
+void PlottingDialog3::updateSmoothControls()
+{
+    bool enabled = ui->checkSmooth->isChecked();
+    bool byCount = (getSmoothMethod() == SmoothingEngine::MovingAverage);
+    ui->spinSmooth->setEnabled(enabled && byCount);
+    ui->spinSmoothWidth->setEnabled(enabled && !byCount);
+}
+
+// 按绘图时相同的规则取数据（t > 0 且压差 > 0），在弹窗中比较候选 L
+void PlottingDialog3::onAutoLSpacing()
+{
+    if (!m_dataModel) return;
+    int tCol = getTimeColumn();
+    int pCol = getPressureColumn();
+    QVector<double> t, dp;
+    double initialP = 0; bool first = true;
+    for (int i = 0; i < m_dataModel->rowCount(); ++i) {
+        QStandardItem* tItem = m_dataModel->item(i, tCol);
+        QStandardItem* pItem = m_dataModel->item(i, pCol);
+        double tv = tItem ? tItem->text().toDouble() : 0.0;
+        double pv = pItem ? pItem->text().toDouble() : 0.0;
+        if (first) { initialP = pv; first = false; }
+        double d = isMeasuredPressure() ? std::abs(pv - initialP) : pv;
+        if (tv > 0 && d > 0) { t.append(tv); dp.append(d); }
+    }
+    if (t.size() < 5) {
+        QMessageBox::warning(this, "提示", "有效数据点不足，无法自动选择 L-Spacing");
+        return;
+    }
+
+    LSpacingSelectDialog dlg(t, dp, getLSpacing(), this);
+    if (dlg.exec() == QDialog::Accepted) {
+        ui->spinL->setValue(dlg.getSelectedLSpacing());
+    }
+}
+
+void PlottingDialog3::onTimeFunctionChanged()
+{
+    bool superposition = (getTimeFunction() != TimeTransform::ElapsedTime);
+    ui->comboRate->setEnabled(superposition);
+    if (superposition && getTimeFunction() == TimeTransform::EquivalentTime) ui->lineXLabel->setText("te (h)");
+    else ui->lineXLabel->setText(superposition ? "Δt (h)" : "Time (h)");
+}
+
+void PlottingDialog3::onDerivAlgorithmChanged()
+{
+    // 只有 Bourdet 算法使用 L-Spacing
+    bool bourdet = (getDerivAlgorithm() == DerivativeEngine::Bourdet);
+    ui->spinL->setEnabled(bourdet);
+    ui->btnAutoL->setEnabled(bourdet);
 }
 
 void PlottingDialog3::updateColorButton(QPushButton* btn, const QColor& color) {
@@ -126,7 +203,12 @@ int PlottingDialog3::getPressureColumn() const { return ui->comboPress->currentI
 bool PlottingDialog3::isMeasuredPressure() const { return ui->radioMeasured->isChecked(); }
 double PlottingDialog3::getLSpacing() const { return ui->spinL->value(); }
 bool PlottingDialog3::isSmoothEnabled() const { return ui->checkSmooth->isChecked(); }
+int PlottingDialog3::getSmoothMethod() const { return ui->comboSmoothMethod->currentIndex(); }
 int PlottingDialog3::getSmoothFactor() const { return ui->spinSmooth->value(); }
+double PlottingDialog3::getSmoothWidth() const { return ui->spinSmoothWidth->value(); }
+int PlottingDialog3::getTimeFunction() const { return ui->comboTimeFunction->currentIndex(); }
+int PlottingDialog3::getRateColumn() const { return ui->comboRate->currentIndex(); }
+int PlottingDialog3::getDerivAlgorithm() const { return ui->comboDerivAlgorithm->currentIndex(); }
 QString PlottingDialog3::getXLabel() const { return ui->lineXLabel->text(); }
 QString PlottingDialog3::getYLabel() const { return ui->lineYLabel->text(); }
 
@@ -2,9 +2,11 @@
  * 文件名: plottingdialog3.h
  * 文件作用: 压力导数曲线配置对话框头文件
  * 功能描述:
- * 1. 包含数据源选择（支持压差计算）、计算参数（L-Spacing, 平滑）。
+ * 1. 包含数据源选择（支持压差计算）、计算参数（L-Spacing 可自动选择, 平滑方法与窗口）。
  * 2. 独立的压力曲线和导数曲线样式设置（调色盘按钮）。
  * 3. 坐标轴标签设置。
+ * 4. 时间函数：经过时间，或由产量列计算的叠加时间 / Agarwal 等效时间。
+ * 5. 导数算法：Bourdet L-Spacing / 三点加权 / 对数时间样条 (DerivativeEngine::Algorithm)。
  */
 
 #ifndef PLOTTINGDIALOG3_H
@@ -40,7 +42,12 @@ public:
     // --- 计算参数 ---
     double getLSpacing() const;
     bool isSmoothEnabled() const;
+    int getSmoothMethod() const;     // SmoothingEngine::Method
     int getSmoothFactor() const;
+    double getSmoothWidth() const;   // 对数时间方法的半窗宽 (ln t)
+    int getTimeFunction() const;     // TimeTransform::Function
+    int getRateColumn() const;
+    int getDerivAlgorithm() const;   // DerivativeEngine::Algorithm
 
     // --- 坐标轴 ---
     QString getXLabel() const;
@@ -62,6 +69,10 @@ public:
 
 private slots:
     void onSmoothToggled(bool checked);
+    void updateSmoothControls();
+    void onAutoLSpacing();
+    void onTimeFunctionChanged();
+    void onDerivAlgorithmChanged();
     // 颜色按钮槽
     void selectPressPointColor();
     void selectPressLineColor();
@@ -1,4 +1,5 @@
 #include "pressurederivativecalculator.h"
+#include "derivativeengine.h"
 #include <QStandardItem>
 #include <QRegularExpression>
 #include <QDebug>
@@ -175,142 +176,13 @@ PressureDerivativeResult PressureDerivativeCalculator::calculatePressureDerivati
     return result;
 }
 
-// 静态方法实现：Bourdet 导数核心算法 (Saphir 方法)
+// 静态方法实现：Bourdet 导数核心算法 (Saphir 方法)，由统一导数引擎计算
 QVector<double> PressureDerivativeCalculator::calculateBourdetDerivative(
     const QVector<double>& timeData,
     const QVector<double>& pressureDropData,
     double lSpacing)
 {
-    QVector<double> derivativeData;
-    int n = timeData.size();
-    derivativeData.reserve(n);
-
-    if (n == 0) return derivativeData;
-
-    for (int i = 0; i < n; ++i) {
-        double derivative = 0.0;
-        double ti = timeData[i];
-        double pi = pressureDropData[i];
-
-        // 寻找左侧点j：ln(ti) - ln(tj) ≥ L
-        int leftIndex = findLeftPoint(timeData, i, lSpacing);
-
-        // 寻找右侧点k：ln(tk) - ln(ti) ≥ L
-        int rightIndex = findRightPoint(timeData, i, lSpacing);
-
-        // 1. 如果找到左右两个点，使用加权平均法 (Bourdet Standard)
-        if (leftIndex >= 0 && rightIndex >= 0) {
-            double tj = timeData[leftIndex];
-            double pj = pressureDropData[leftIndex];
-            double tk = timeData[rightIndex];
-            double pk = pressureDropData[rightIndex];
-
-            // 计算对数差值
-            double deltaXL = std::log(ti) - std::log(tj);  // ΔXL = ln(ti) - ln(tj)
-            double deltaXR = std::log(tk) - std::log(ti);  // ΔXR = ln(tk) - ln(ti)
-
-            // 计算左导数和右导数
-            double mL = calculateDerivativeValue(ti, tj, pi, pj);  // 左导数 slope
-            double mR = calculateDerivativeValue(tk, ti, pk, pi);  // 右导数 slope
-
-            // 加权平均公式：P' = (mL * ΔXR + mR * ΔXL) / (ΔXL + ΔXR)
-            if (deltaXL + deltaXR > 1e-12) {
-                derivative = (mL * deltaXR + mR * deltaXL) / (deltaXL + deltaXR);
-            } else {
-                derivative = 0.0;
-            }
-        }
-        // 2. 边界情况：只找到左侧点 (曲线末端)
-        else if (leftIndex >= 0 && rightIndex < 0) {
-            double tj = timeData[leftIndex];
-            double pj = pressureDropData[leftIndex];
-            derivative = calculateDerivativeValue(ti, tj, pi, pj);
-        }
-        // 3. 边界情况：只找到右侧点 (曲线开端)
-        else if (leftIndex < 0 && rightIndex >= 0) {
-            double tk = timeData[rightIndex];
-            double pk = pressureDropData[rightIndex];
-            derivative = calculateDerivativeValue(tk, ti, pk, pi);
-        }
-        // 4. L-Spacing 范围内点不足 (通常是数据极少或 L 设置过大)
-        else {
-            // 使用简单的相邻点差分作为保底
-            if (i > 0) {
-                double t_prev = timeData[i-1];
-                double p_prev = pressureDropData[i-1];
-                derivative = calculateDerivativeValue(ti, t_prev, pi, p_prev);
-            } else if (i < n - 1) {
-                double t_next = timeData[i+1];
-                double p_next = pressureDropData[i+1];
-                derivative = calculateDerivativeValue(t_next, ti, p_next, pi);
-            } else {
-                derivative = 0.0;
-            }
-        }
-
-        derivativeData.append(derivative);
-    }
-
-    return derivativeData;
-}
-
-int PressureDerivativeCalculator::findLeftPoint(const QVector<double>& timeData, int currentIndex, double lSpacing)
-{
-    if (currentIndex <= 0 || timeData.isEmpty()) return -1;
-
-    double ti = timeData[currentIndex];
-    if (ti <= 0) return -1;
-    double lnTi = std::log(ti);
-
-    // 从当前点向左搜索，找到第一个满足距离 >= L 的点
-    for (int j = currentIndex - 1; j >= 0; --j) {
-        double tj = timeData[j];
-        if (tj <= 0) continue;
-
-        double lnTj = std::log(tj);
-        if ((lnTi - lnTj) >= lSpacing) {
-            return j;
-        }
-    }
-    return -1;
-}
-
-int PressureDerivativeCalculator::findRightPoint(const QVector<double>& timeData, int currentIndex, double lSpacing)
-{
-    int n = timeData.size();
-    if (currentIndex >= n - 1 || timeData.isEmpty()) return -1;
-
-    double ti = timeData[currentIndex];
-    if (ti <= 0) return -1;
-    double lnTi = std::log(ti);
-
-    // 从当前点向右搜索，找到第一个满足距离 >= L 的点
-    for (int k = currentIndex + 1; k < n; ++k) {
-        double tk = timeData[k];
-        if (tk <= 0) continue;
-
-        double lnTk = std::log(tk);
-        if ((lnTk - lnTi) >= lSpacing) {
-            return k;
-        }
-    }
-    return -1;
-}
-
-double PressureDerivativeCalculator::calculateDerivativeValue(double t1, double t2, double p1, double p2)
-{
-    // 计算单边导数：dP/d(ln t) = (p1 - p2) / (ln(t1) - ln(t2))
-    if (t1 <= 0 || t2 <= 0) return 0.0;
-
-    double lnT1 = std::log(t1);
-    double lnT2 = std::log(t2);
-    double deltaLnT = lnT1 - lnT2;
-
-    if (std::abs(deltaLnT) < 1e-10) {
-        return 0.0;
-    }
-
-    return (p1 - p2) / deltaLnT;
+    return DerivativeEngine::bourdet(timeData, pressureDropData, lSpacing);
 }
 
 PressureDerivativeConfig PressureDerivativeCalculator::autoDetectColumns(QStandardItemModel* model)
@@ -363,17 +235,21 @@ int PressureDerivativeCalculator::findTimeColumn(QStandardItemModel* model)
     return -1;
 }
 
-double PressureDerivativeCalculator::parseNumericValue(const QString& str)
+double PressureDerivativeCalculator::parseNumericValue(const QString& str, bool* ok)
 {
-    if (str.isEmpty()) return 0.0;
+    bool parsed = false;
+    double value = 0.0;
     QString cleanStr = str.trimmed();
-    bool ok;
-    double value = cleanStr.toDouble(&ok);
-    if (ok) return value;
-
-    cleanStr.remove(QRegularExpression("[a-zA-Z%\\s]+$"));
-    value = cleanStr.toDouble(&ok);
-    return ok ? value : 0.0;
+    if (!cleanStr.isEmpty()) {
+        value = cleanStr.toDouble(&parsed);
+        if (!parsed) {
+            static const QRegularExpression unitSuffix("[a-zA-Z%\\s]+$");
+            cleanStr.remove(unitSuffix);
+            value = cleanStr.toDouble(&parsed);
+        }
+    }
+    if (ok) *ok = parsed;
+    return parsed ? value : 0.0;
 }
 
 QString PressureDerivativeCalculator::formatValue(double value, int precision)
@@ -78,6 +78,8 @@ public:
 
     /**
      * @brief 使用Bourdet导数算法计算导数 (统一入口)
+     *
+     * 与 DerivativeEngine::bourdet 相同（保留此入口供已有调用方使用）
      * @param timeData 时间数据 (t)
      * @param pressureDropData 压降数据 (Delta P)
      * @param lSpacing L-Spacing参数 (通常0.1-0.5，理论曲线计算时可设为0.0-0.1)
@@ -87,19 +89,19 @@ public:
                                                       const QVector<double>& pressureDropData,
                                                       double lSpacing);
 
+    /**
+     * @brief 解析表格单元格数值，允许末尾带单位（如 "12.5 MPa"）；无法解析时返回 0
+     * @param ok 非空时返回是否解析成功（空单元格为失败）
+     */
+    static double parseNumericValue(const QString& str, bool* ok = nullptr);
+
 signals:
     void progressUpdated(int progress, const QString& message);
     void calculationCompleted(const PressureDerivativeResult& result);
 
 private:
-    // 内部静态辅助函数
-    static int findLeftPoint(const QVector<double>& timeData, int currentIndex, double lSpacing);
-    static int findRightPoint(const QVector<double>& timeData, int currentIndex, double lSpacing);
-    static double calculateDerivativeValue(double t1, double t2, double p1, double p2);
-
     int findPressureColumn(QStandardItemModel* model);
     int findTimeColumn(QStandardItemModel* model);
-    double parseNumericValue(const QString& str);
     QString formatValue(double value, int precision = 6);
 };
 
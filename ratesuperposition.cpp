@@ -0,0 +1,209 @@
+/*
+ * ratesuperposition.cpp
+ * 文件作用：变产量叠加计算实现文件
+ * 功能描述：
+ * 1. 从最近的台阶向前按箱处理：箱内 Δt ∈ [Δ, Δ·e^w]，只有一个台阶时精确计算
+ * 2. 箱内多个台阶：在箱内台阶时间中点 tc 处二阶展开，τc = T - tc，
+ *    pu(T - t_i) ≈ pu(τc) - pu'(τc)·(t_i - tc) + pu''(τc)·(t_i - tc)²/2，
+ *    箱内合计只需 ΣΔq、ΣΔq·t、ΣΔq·t² 三个前缀和
+ * 3. 单位响应在 ln Δt 上三次 Hermite 插值，网格两端之外按端点斜率线性外推
+ */
+
+#include "ratesuperposition.h"
+
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+
+double RateHistory::rateAt(double t) const
+{
+    int i = int(std::upper_bound(startTimes.constBegin(), startTimes.constEnd(), t) - startTimes.constBegin());
+    return i > 0 ? rates[i - 1] : 0.0;
+}
+
+RateHistory RateHistory::fromDurations(const QVector<double>& durations, const QVector<double>& rates, double origin)
+{
+    RateHistory history;
+    double start = origin;
+    for (int i = 0; i < durations.size() && i < rates.size(); ++i) {
+        if (history.rates.isEmpty() || rates[i] != history.rates.last()) {
+            history.startTimes.append(start);
+            history.rates.append(rates[i]);
+        }
+        if (durations[i] > 0) start += durations[i];
+    }
+    return history;
+}
+
+RateHistory RateHistory::fromSamples(const QVector<double>& times, const QVector<double>& rates)
+{
+    RateHistory history;
+    for (int i = 0; i < times.size() && i < rates.size(); ++i) {
+        if (std::isnan(times[i]) || std::isnan(rates[i])) continue;
+        if (!history.startTimes.isEmpty() && times[i] < history.startTimes.last()) continue;
+        if (history.rates.isEmpty() || rates[i] != history.rates.last()) {
+            history.startTimes.append(times[i]);
+            history.rates.append(rates[i]);
+        }
+    }
+    return history;
+}
+
+RateSuperposition::RateSuperposition(const RateHistory& history)
+{
+    setHistory(history);
+}
+
+void RateSuperposition::setHistory(const RateHistory& history)
+{
+    m_history = history;
+    const int n = history.stepCount();
+    m_rateChange.resize(n);
+    m_sumQ = QVector<double>(n + 1, 0.0);
+    m_sumQT = QVector<double>(n + 1, 0.0);
+    m_sumQTT = QVector<double>(n + 1, 0.0);
+    for (int i = 0; i < n; ++i) {
+        const double t = history.startTimes[i] - history.startTimes[0];
+        m_rateChange[i] = history.rates[i] - (i > 0 ? history.rates[i - 1] : 0.0);
+        m_sumQ[i + 1] = m_sumQ[i] + m_rateChange[i];
+        m_sumQT[i + 1] = m_sumQT[i] + m_rateChange[i] * t;
+        m_sumQTT[i + 1] = m_sumQTT[i] + m_rateChange[i] * t * t;
+    }
+}
+
+QVector<double> RateSuperposition::unitResponseGrid(const QVector<double>& t, double origin) const
+{
+    QVector<double> grid;
+    const QVector<double>& starts = m_history.startTimes;
+    if (starts.isEmpty() || t.isEmpty()) return grid;
+
+    // 最小 Δt：每个时间点到其前一个台阶的距离；最大 Δt：最后时间点到第一个台阶
+    double minDt = -1.0, maxDt = -1.0;
+    auto include = [&](double T) {
+        int j = int(std::lower_bound(starts.constBegin(), starts.constEnd(), T) - starts.constBegin());
+        if (j == 0) return;
+        double nearest = T - starts[j - 1];
+        double farthest = T - starts[0];
+        if (minDt < 0 || nearest < minDt) minDt = nearest;
+        if (farthest > maxDt) maxDt = farthest;
+    };
+    include(origin);
+    for (double ti : t) include(origin + ti);
+    if (minDt <= 0) return grid;
+
+    const double cycles = std::log10(maxDt / minDt);
+    const int count = qMax(2, int(std::ceil(cycles * kPointsPerCycle)) + 1);
+    grid.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        grid.append(minDt * std::pow(maxDt / minDt, double(i) / (count - 1)));
+    }
+    return grid;
+}
+
+void RateSuperposition::setUnitResponse(const QVector<double>& dt, const QVector<double>& pu)
+{
+    m_gridLnT.clear();
+    m_gridP.clear();
+    for (int i = 0; i < dt.size() && i < pu.size(); ++i) {
+        if (dt[i] <= 0) continue;
+        double lnT = std::log(dt[i]);
+        if (!m_gridLnT.isEmpty() && lnT <= m_gridLnT.last()) continue;
+        m_gridLnT.append(lnT);
+        m_gridP.append(pu[i]);
+    }
+
+    const int n = m_gridLnT.size();
+    m_gridSlope = QVector<double>(n, 0.0);
+    for (int i = 0; i < n && n > 1; ++i) {
+        int a = qMax(0, i - 1), b = qMin(n - 1, i + 1);
+        m_gridSlope[i] = (m_gridP[b] - m_gridP[a]) / (m_gridLnT[b] - m_gridLnT[a]);
+    }
+}
+
+double RateSuperposition::unitResponse(double dt, double* slope, double* curvature) const
+{
+    const int n = m_gridLnT.size();
+    if (slope) *slope = 0.0;
+    if (curvature) *curvature = 0.0;
+    if (dt <= 0 || n == 0) return 0.0;
+    if (n == 1) return m_gridP[0];
+
+    // ln Δt 上的三次 Hermite 插值，节点斜率取相邻两点的中心差分
+    const double x = std::log(dt);
+    int k = int(std::upper_bound(m_gridLnT.constBegin(), m_gridLnT.constEnd(), x) - m_gridLnT.constBegin());
+    k = qBound(1, k, n - 1);
+    const double x0 = m_gridLnT[k - 1], x1 = m_gridLnT[k];
+    const double p0 = m_gridP[k - 1], p1 = m_gridP[k];
+    const double h = x1 - x0;
+    const double m0 = m_gridSlope[k - 1], m1 = m_gridSlope[k];
+    const double s = (x - x0) / h;
+    double value, lnSlope, lnCurvature = 0.0;
+    if (s < 0.0 || s > 1.0) {
+        // 网格之外按端点斜率线性外推
+        const double xe = (s < 0.0) ? x0 : x1;
+        lnSlope = (s < 0.0) ? m0 : m1;
+        value = ((s < 0.0) ? p0 : p1) + lnSlope * (x - xe);
+    } else {
+        const double s2 = s * s, s3 = s2 * s;
+        value = (2 * s3 - 3 * s2 + 1) * p0 + (s3 - 2 * s2 + s) * h * m0 + (-2 * s3 + 3 * s2) * p1 + (s3 - s2) * h * m1;
+        lnSlope = ((6 * s2 - 6 * s) * p0 + (-6 * s2 + 6 * s) * p1) / h + (3 * s2 - 4 * s + 1) * m0 + (3 * s2 - 2 * s) * m1;
+        lnCurvature = ((12 * s - 6) * p0 + (-12 * s + 6) * p1) / (h * h) + ((6 * s - 4) * m0 + (6 * s - 2) * m1) / h;
+    }
+    // 由 ln Δt 的导数换算为 Δt 的导数
+    if (slope) *slope = lnSlope / dt;
+    if (curvature) *curvature = (lnCurvature - lnSlope) / (dt * dt);
+    return value;
+}
+
+double RateSuperposition::drawdownAt(double T) const
+{
+    const double* starts = m_history.startTimes.constData();
+    int j = int(std::lower_bound(starts, starts + m_history.stepCount(), T) - starts);
+    const double binFactor = std::exp(kLogBinWidth);
+    double sum = 0.0;
+
+    while (j > 0) {
+        const double nearest = T - starts[j - 1];
+        const int i = int(std::lower_bound(starts, starts + j, T - nearest * binFactor) - starts);
+        if (j - i == 1) {
+            sum += m_rateChange[j - 1] * unitResponse(nearest, nullptr, nullptr);
+        } else {
+            // 时间相对第一个台阶计算，减小二阶矩的舍入误差
+            const double tc = 0.5 * (starts[i] + starts[j - 1]) - starts[0];
+            const double s0 = m_sumQ[j] - m_sumQ[i];
+            const double s1 = m_sumQT[j] - m_sumQT[i];
+            const double s2 = m_sumQTT[j] - m_sumQTT[i];
+            double slope = 0.0, curvature = 0.0;
+            const double pc = unitResponse(T - starts[0] - tc, &slope, &curvature);
+            sum += s0 * pc - slope * (s1 - s0 * tc) + 0.5 * curvature * (s2 - 2.0 * tc * s1 + tc * tc * s0);
+        }
+        j = i;
+    }
+    return sum;
+}
+
+QVector<double> RateSuperposition::periodResponse(const QVector<double>& t, double origin) const
+{
+    const int n = t.size();
+    QVector<double> result(n, 0.0);
+    if (m_history.isEmpty() || m_gridLnT.isEmpty()) return result;
+
+    // origin 处的产量变化决定符号：压力恢复（降产/关井）时压力回升为正
+    const double change = m_history.rateAt(origin) - m_history.rateAt(std::nextafter(origin, -HUGE_VAL));
+    const double sign = (change < 0) ? -1.0 : 1.0;
+    const double reference = drawdownAt(origin);
+
+    double* out = result.data();
+    auto evaluate = [this, &t, out, origin, sign, reference](int begin, int end) {
+        for (int i = begin; i < end; ++i) out[i] = sign * (drawdownAt(origin + t[i]) - reference);
+    };
+    if (n < kParallelThreshold) {
+        evaluate(0, n);
+    } else {
+        const int blockSize = 8192;
+        QVector<int> starts;
+        for (int b = 0; b < n; b += blockSize) starts.append(b);
+        QtConcurrent::blockingMap(starts, [&evaluate, n, blockSize](int b) { evaluate(b, qMin(n, b + blockSize)); });
+    }
+    return result;
+}
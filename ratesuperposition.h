@@ -0,0 +1,83 @@
+/*
+ * ratesuperposition.h
+ * 文件作用：变产量叠加计算头文件
+ * 功能描述：
+ * 1. RateHistory：分段常产量历史，每段从 startTimes[i] 开始以 rates[i] 生产，直到下一段开始
+ *    可由各段持续时间（绘图模块阶梯产量）或逐点时间-产量序列构造
+ * 2. RateSuperposition：由单位产量响应 pu(Δt) 叠加得到变产量压降
+ *    Δp(T) = Σ (q_i - q_i-1) · pu(T - t_i)
+ *    单位响应在对数时间网格上只计算一次并缓存，叠加时在 ln Δt 上三次插值
+ * 3. 远离 T 的产量台阶按 ln Δt 分箱合并：同一箱内用前缀和求 ΣΔq、ΣΔq·t、ΣΔq·t²，按箱中心二阶展开，
+ *    每个时间点的代价为 O(箱数 · log 台阶数)，与产量变化次数基本无关；大数组按块并行
+ */
+
+#ifndef RATESUPERPOSITION_H
+#define RATESUPERPOSITION_H
+
+#include <QVector>
+
+struct RateHistory
+{
+    QVector<double> startTimes;     // 各段开始时间（升序）
+    QVector<double> rates;          // 各段产量
+
+    bool isEmpty() const { return startTimes.isEmpty(); }
+    int stepCount() const { return startTimes.size(); }
+    // 多于一个产量台阶时才需要叠加（单段常产量与原模型一致）
+    bool isMultiRate() const { return startTimes.size() > 1; }
+
+    // 时间 t 时的产量（第一段之前为 0）
+    double rateAt(double t) const;
+
+    // 由各段持续时间与产量构造，第一段从 origin 开始
+    static RateHistory fromDurations(const QVector<double>& durations, const QVector<double>& rates, double origin = 0.0);
+    // 由逐点 (时间, 产量) 构造，每点产量保持到下一点，相邻相同产量合并为一段
+    static RateHistory fromSamples(const QVector<double>& times, const QVector<double>& rates);
+};
+
+class RateSuperposition
+{
+public:
+    static constexpr double kLogBinWidth = 0.05;       // 合并台阶的 ln Δt 箱宽
+    static const int kPointsPerCycle = 20;              // 单位响应网格每个对数周期的点数
+    static const int kParallelThreshold = 50000;        // 超过该点数时分块并行计算
+
+    explicit RateSuperposition(const RateHistory& history = RateHistory());
+
+    void setHistory(const RateHistory& history);
+    const RateHistory& history() const { return m_history; }
+
+    /**
+     * @brief 计算 origin + t 处叠加所需的单位响应 Δt 网格（对数等分，覆盖全部 T - t_i 与 origin - t_i）
+     * @return 数据不足以叠加时返回空
+     */
+    QVector<double> unitResponseGrid(const QVector<double>& t, double origin = 0.0) const;
+
+    // 设置网格上的单位产量响应 pu(Δt)，dt 须升序且为正
+    void setUnitResponse(const QVector<double>& dt, const QVector<double>& pu);
+
+    // 绝对时间 T 处的叠加压降 Σ Δq_i · pu(T - t_i)
+    double drawdownAt(double T) const;
+
+    /**
+     * @brief 以 origin 为时间零点的压力变化：s · (Δp(origin + t) - Δp(origin))
+     *        s 为 origin 处产量变化的符号（压力恢复时为 -1），使压降/压力恢复曲线均为正值
+     */
+    QVector<double> periodResponse(const QVector<double>& t, double origin = 0.0) const;
+
+private:
+    // slope、curvature 输出 d pu / d Δt 与 d² pu / d Δt²（可为空）
+    double unitResponse(double dt, double* slope, double* curvature) const;
+
+    RateHistory m_history;
+    QVector<double> m_rateChange;   // Δq_i
+    QVector<double> m_sumQ;         // 前缀和 ΣΔq（长度为台阶数 + 1）
+    QVector<double> m_sumQT;        // 前缀和 ΣΔq·t_i（t_i 相对第一个台阶）
+    QVector<double> m_sumQTT;       // 前缀和 ΣΔq·t_i²
+
+    QVector<double> m_gridLnT;      // 单位响应网格 ln Δt
+    QVector<double> m_gridP;
+    QVector<double> m_gridSlope;    // 节点处 d pu / d ln Δt
+};
+
+#endif // RATESUPERPOSITION_H
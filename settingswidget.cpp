@@ -10,6 +10,7 @@
 
 #include "settingswidget.h"
 #include "ui_settingswidget.h"
+#include "derivativeengine.h"
 #include <QDebug>
 #include <QDate>
 
@@ -42,6 +43,8 @@ SettingsWidget::SettingsWidget(QWidget *parent) :
             connect(qobject_cast<QLineEdit*>(w), &QLineEdit::textChanged, this, &SettingsWidget::onSettingModified);
         else if(qobject_cast<QSpinBox*>(w))
             connect(qobject_cast<QSpinBox*>(w), QOverload<int>::of(&QSpinBox::valueChanged), this, &SettingsWidget::onSettingModified);
+        else if(qobject_cast<QDoubleSpinBox*>(w))
+            connect(qobject_cast<QDoubleSpinBox*>(w), QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &SettingsWidget::onSettingModified);
         else if(qobject_cast<QComboBox*>(w))
             connect(qobject_cast<QComboBox*>(w), QOverload<int>::of(&QComboBox::currentIndexChanged), this, &SettingsWidget::onSettingModified);
         else if(qobject_cast<QCheckBox*>(w))
@@ -70,6 +73,8 @@ void SettingsWidget::initInterface()
     // 3. 初始化绘图背景
     ui->cmbPlotBackground->clear();
     ui->cmbPlotBackground->addItems({"白色主题 (默认)", "深色主题 (护眼)", "灰色网格"});
+    ui->cmbDerivAlgorithm->clear();
+    ui->cmbDerivAlgorithm->addItems(DerivativeEngine::algorithmNames());
 
     // 4. 初始化日志级别
     ui->cmbLogLevel->clear();
@@ -91,6 +96,8 @@ void SettingsWidget::loadSettings()
     ui->cmbPlotBackground->setCurrentIndex(m_settings->value("plot/background", 0).toInt());
     ui->chkShowGrid->setChecked(m_settings->value("plot/showGrid", true).toBool());
     ui->spinLineWidth->setValue(m_settings->value("plot/lineWidth", 2).toInt());
+    ui->cmbDerivAlgorithm->setCurrentIndex(derivativeAlgorithm());
+    ui->spinDerivL->setValue(derivativeLSpacing());
 
     // --- 4. 路径设置 ---
     QString docPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
@@ -127,6 +134,8 @@ void SettingsWidget::applySettings()
     m_settings->setValue("plot/background", ui->cmbPlotBackground->currentIndex());
     m_settings->setValue("plot/showGrid", ui->chkShowGrid->isChecked());
     m_settings->setValue("plot/lineWidth", ui->spinLineWidth->value());
+    m_settings->setValue("derivative/algorithm", ui->cmbDerivAlgorithm->currentIndex());
+    m_settings->setValue("derivative/lSpacing", ui->spinDerivL->value());
 
     m_settings->setValue("paths/data", ui->lineDataPath->text());
     m_settings->setValue("paths/report", ui->lineReportPath->text());
@@ -245,3 +254,17 @@ int SettingsWidget::getRateUnitIndex() const { return ui->cmbRateUnit->currentIn
 int SettingsWidget::getPrecision() const { return ui->spinPrecision->value(); }
 int SettingsWidget::getPlotBackgroundStyle() const { return ui->cmbPlotBackground->currentIndex(); }
 bool SettingsWidget::isGridVisibleDefault() const { return ui->chkShowGrid->isChecked(); }
+
+int SettingsWidget::derivativeAlgorithm()
+{
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    int algorithm = settings.value("derivative/algorithm", DerivativeEngine::Bourdet).toInt();
+    return (algorithm >= 0 && algorithm < DerivativeEngine::algorithmNames().size()) ? algorithm : DerivativeEngine::Bourdet;
+}
+
+double SettingsWidget::derivativeLSpacing()
+{
+    QSettings settings("WellTestPro", "WellTestAnalysis");
+    double lSpacing = settings.value("derivative/lSpacing", DerivativeEngine::kDefaultLSpacing).toDouble();
+    return lSpacing > 0 ? lSpacing : DerivativeEngine::kDefaultLSpacing;
+}
@@ -51,6 +51,10 @@ public:
     int getPlotBackgroundStyle() const; // 0: 白色, 1: 深色
     bool isGridVisibleDefault() const;
 
+    // 拟合数据导数配置（读取已保存的设置，供拟合页在无设置窗口实例时使用）
+    static int derivativeAlgorithm();     // DerivativeEngine::Algorithm
+    static double derivativeLSpacing();
+
 signals:
     // 配置变更信号
     void settingsChanged();           // 通用变更信号
@@ -0,0 +1,302 @@
+/*
+ * smoothingengine.cpp
+ * 文件作用：导数曲线平滑算法实现文件
+ * 功能描述：
+ * 1. 对数时间方法先取有效点 (t > 0) 并按 ln t 排序，平滑结果写回原位置
+ * 2. 局部多项式：按块计算以块中心为原点、以 logWidth 归一化的前缀矩，
+ *    每块点数不少于块首窗口点数且跨度不超过 2·logWidth，总代价 O(n) 且前缀和无大数相消
+ * 3. 窗口点数不足以确定多项式或方程组奇异时逐级降阶，直至取窗口均值
+ */
+
+#include "smoothingengine.h"
+
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+const int kMinBlock = 256;
+
+// 有效点（t > 0）按 ln t 排序后的视图
+struct LogView {
+    QVector<int> index;     // 原数组下标
+    QVector<double> x;      // ln t
+    QVector<double> v;      // 数据值
+};
+
+LogView makeLogView(const QVector<double>& t, const QVector<double>& y)
+{
+    LogView view;
+    const int n = qMin(t.size(), y.size());
+    bool monotone = true;
+    for (int i = 0; i < n; ++i) {
+        if (!(t[i] > 0)) continue;
+        if (!view.index.isEmpty() && t[i] < t[view.index.last()]) monotone = false;
+        view.index.append(i);
+    }
+    if (!monotone) {
+        std::stable_sort(view.index.begin(), view.index.end(), [&t](int a, int b) { return t[a] < t[b]; });
+    }
+    view.x.resize(view.index.size());
+    view.v.resize(view.index.size());
+    for (int k = 0; k < view.index.size(); ++k) {
+        view.x[k] = std::log(t[view.index[k]]);
+        view.v[k] = y[view.index[k]];
+    }
+    return view;
+}
+
+QVector<double> scatterBack(const QVector<double>& y, const LogView& view, const QVector<double>& smoothed)
+{
+    QVector<double> result = y;
+    for (int k = 0; k < view.index.size(); ++k) result[view.index[k]] = smoothed[k];
+    return result;
+}
+
+// 对 [0, count) 中的每个元素执行 fn，数量较多时并行
+void forEachItem(int count, bool parallel, const std::function<void(int)>& fn)
+{
+    if (!parallel) {
+        for (int i = 0; i < count; ++i) fn(i);
+        return;
+    }
+    QVector<int> items(count);
+    std::iota(items.begin(), items.end(), 0);
+    QtConcurrent::blockingMap(items, [&fn](int i) { fn(i); });
+}
+
+// 小型对称方程组 A·c = b（部分主元高斯消元），主元相对过小时返回 false
+bool solveSmall(double A[4][4], double b[4], int dim, double c[4])
+{
+    const double scale = std::abs(A[0][0]);
+    for (int col = 0; col < dim; ++col) {
+        int piv = col;
+        for (int r = col + 1; r < dim; ++r) if (std::abs(A[r][col]) > std::abs(A[piv][col])) piv = r;
+        if (!(std::abs(A[piv][col]) > 1e-10 * scale)) return false;
+        if (piv != col) {
+            for (int k = 0; k < dim; ++k) std::swap(A[col][k], A[piv][k]);
+            std::swap(b[col], b[piv]);
+        }
+        for (int r = col + 1; r < dim; ++r) {
+            double f = A[r][col] / A[col][col];
+            for (int k = col; k < dim; ++k) A[r][k] -= f * A[col][k];
+            b[r] -= f * b[col];
+        }
+    }
+    for (int r = dim - 1; r >= 0; --r) {
+        double s = b[r];
+        for (int k = r + 1; k < dim; ++k) s -= A[r][k] * c[k];
+        c[r] = s / A[r][r];
+    }
+    return true;
+}
+
+// 对数时间窗口内的最小二乘多项式（x 升序），order = 0 即窗口均值
+QVector<double> localPolynomial(const QVector<double>& x, const QVector<double>& v, double w, int order)
+{
+    const int n = x.size();
+    QVector<double> out(n);
+    if (n == 0) return out;
+    order = qBound(0, order, 3);
+
+    // 1. 窗口 [left, right)：|x_j - x_i| <= w，双指针
+    QVector<int> left(n), right(n);
+    for (int i = 0, l = 0, r = 0; i < n; ++i) {
+        while (x[l] < x[i] - w) ++l;
+        if (r < i + 1) r = i + 1;
+        while (r < n && x[r] <= x[i] + w) ++r;
+        left[i] = l;
+        right[i] = r;
+    }
+
+    // 2. 分块：点数不少于块首窗口点数（且不少于 kMinBlock），跨度不超过 2w
+    QVector<QPair<int, int>> blocks;
+    for (int b = 0; b < n;) {
+        int e = qMin(n, b + qMax(kMinBlock, right[b] - left[b]));
+        int spanEnd = int(std::upper_bound(x.constBegin() + b, x.constBegin() + e, x[b] + 2.0 * w) - x.constBegin());
+        e = qMax(b + 1, spanEnd);
+        blocks.append(qMakePair(b, e));
+        b = e;
+    }
+
+    // 3. 每块：以块中心为原点、w 为单位的前缀矩，逐点求解正规方程
+    const double inv = (w > 0) ? 1.0 / w : 1.0;
+    double* outData = out.data();
+    forEachItem(blocks.size(), n >= SmoothingEngine::kParallelThreshold, [&](int bi) {
+        const int b = blocks[bi].first, e = blocks[bi].second;
+        const int lo = left[b], hi = right[e - 1];
+        const double c = x[(b + e - 1) / 2];
+        const int K = 2 * order + 1;
+        const int m = hi - lo;
+        std::vector<double> S(size_t(m + 1) * K, 0.0), T(size_t(m + 1) * (order + 1), 0.0);
+        for (int j = 0; j < m; ++j) {
+            double u = (x[lo + j] - c) * inv;
+            double pw = 1.0;
+            for (int k = 0; k < K; ++k) {
+                S[size_t(j + 1) * K + k] = S[size_t(j) * K + k] + pw;
+                if (k <= order) T[size_t(j + 1) * (order + 1) + k] = T[size_t(j) * (order + 1) + k] + pw * v[lo + j];
+                pw *= u;
+            }
+        }
+
+        for (int i = b; i < e; ++i) {
+            const int a0 = left[i] - lo, a1 = right[i] - lo;
+            const int count = a1 - a0;
+            double s[7], tt[4];
+            for (int k = 0; k < K; ++k) s[k] = S[size_t(a1) * K + k] - S[size_t(a0) * K + k];
+            for (int k = 0; k <= order; ++k) tt[k] = T[size_t(a1) * (order + 1) + k] - T[size_t(a0) * (order + 1) + k];
+
+            const double ui = (x[i] - c) * inv;
+            double value = v[i];
+            for (int q = qMin(order, count - 1); q >= 0; --q) {
+                double A[4][4], rhs[4], coef[4];
+                for (int r = 0; r <= q; ++r) {
+                    rhs[r] = tt[r];
+                    for (int k = 0; k <= q; ++k) A[r][k] = s[r + k];
+                }
+                if (!solveSmall(A, rhs, q + 1, coef)) continue;
+                value = 0.0;
+                for (int k = q; k >= 0; --k) value = value * ui + coef[k];
+                break;
+            }
+            outData[i] = value;
+        }
+    });
+    return out;
+}
+
+// 加权局部线性回归在 x0 处的值；窗口 [a, b)
+double localLinear(const QVector<double>& x, const QVector<double>& v, const QVector<double>& robust,
+                   int a, int b, double x0, double w, double fallback)
+{
+    double sw = 0, swx = 0, swxx = 0, swy = 0, swxy = 0;
+    for (int j = a; j < b; ++j) {
+        double d = x[j] - x0;
+        double r = std::abs(d) / w;
+        if (r >= 1.0) continue;
+        double tri = 1.0 - r * r * r;
+        double wt = tri * tri * tri * robust[j];
+        sw += wt; swx += wt * d; swxx += wt * d * d; swy += wt * v[j]; swxy += wt * d * v[j];
+    }
+    if (!(sw > 0)) return fallback;
+    double denom = sw * swxx - swx * swx;
+    if (std::abs(denom) <= 1e-12 * sw * sw * w * w) return swy / sw;
+    double slope = (sw * swxy - swx * swy) / denom;
+    return (swy - slope * swx) / sw;
+}
+
+}
+
+QStringList SmoothingEngine::methodNames()
+{
+    return QStringList() << "移动平均 (点数)" << "对数时间移动平均" << "Savitzky-Golay (对数时间)" << "LOWESS (对数时间)";
+}
+
+QVector<double> SmoothingEngine::smooth(const QVector<double>& t, const QVector<double>& y,
+                                        Method method, int span, double logWidth)
+{
+    switch (method) {
+    case LogMovingAverage: return logMovingAverage(t, y, logWidth);
+    case SavitzkyGolay: return savitzkyGolay(t, y, logWidth);
+    case Lowess: return lowess(t, y, logWidth);
+    case MovingAverage:
+    default: return movingAverage(y, span);
+    }
+}
+
+QVector<double> SmoothingEngine::movingAverage(const QVector<double>& y, int span)
+{
+    const int n = y.size();
+    if (n == 0) return QVector<double>();
+    if (span <= 1) return y;
+
+    // 确保span是奇数
+    if (span % 2 == 0) span++;
+    const int halfSpan = (span - 1) / 2;
+
+    // 前缀和（减去均值以减小累加误差），边缘处窗口自动缩小
+    const double offset = std::accumulate(y.constBegin(), y.constEnd(), 0.0) / n;
+    QVector<double> prefix(n + 1, 0.0);
+    for (int i = 0; i < n; ++i) prefix[i + 1] = prefix[i] + (y[i] - offset);
+
+    QVector<double> result(n);
+    for (int i = 0; i < n; ++i) {
+        int start = qMax(0, i - halfSpan);
+        int end = qMin(n - 1, i + halfSpan);
+        result[i] = offset + (prefix[end + 1] - prefix[start]) / (end - start + 1);
+    }
+    return result;
+}
+
+QVector<double> SmoothingEngine::logMovingAverage(const QVector<double>& t, const QVector<double>& y, double logWidth)
+{
+    return savitzkyGolay(t, y, logWidth, 0);
+}
+
+QVector<double> SmoothingEngine::savitzkyGolay(const QVector<double>& t, const QVector<double>& y, double logWidth, int order)
+{
+    if (!(logWidth > 0)) return y;
+    LogView view = makeLogView(t, y);
+    return scatterBack(y, view, localPolynomial(view.x, view.v, logWidth, order));
+}
+
+QVector<double> SmoothingEngine::lowess(const QVector<double>& t, const QVector<double>& y, double logWidth, int robustIterations)
+{
+    if (!(logWidth > 0)) return y;
+    LogView view = makeLogView(t, y);
+    const QVector<double>& x = view.x;
+    const QVector<double>& v = view.v;
+    const int n = x.size();
+    if (n < 3) return y;
+
+    // 锚点：相邻锚点的对数时间间距不小于 logWidth / 10，末点总是锚点
+    const double delta = logWidth / 10.0;
+    QVector<int> anchors;
+    for (int i = 0; i < n;) {
+        anchors.append(i);
+        int next = int(std::upper_bound(x.constBegin() + i, x.constEnd(), x[i] + delta) - x.constBegin());
+        i = qMax(i + 1, next);
+    }
+    if (anchors.last() != n - 1) anchors.append(n - 1);
+
+    QVector<double> robust(n, 1.0), fitted(n), anchorFit(anchors.size());
+    const bool parallel = n >= kParallelThreshold;
+    for (int iter = 0; iter <= robustIterations; ++iter) {
+        double* fitData = anchorFit.data();
+        forEachItem(anchors.size(), parallel, [&](int k) {
+            const int i = anchors[k];
+            int a = int(std::upper_bound(x.constBegin(), x.constEnd(), x[i] - logWidth) - x.constBegin());
+            int b = int(std::lower_bound(x.constBegin(), x.constEnd(), x[i] + logWidth) - x.constBegin());
+            fitData[k] = localLinear(x, v, robust, a, b, x[i], logWidth, v[i]);
+        });
+
+        // 锚点之间线性插值
+        for (int k = 0; k + 1 < anchors.size(); ++k) {
+            const int i0 = anchors[k], i1 = anchors[k + 1];
+            const double x0 = x[i0], x1 = x[i1];
+            for (int i = i0; i < i1; ++i) {
+                double f = (x1 > x0) ? (x[i] - x0) / (x1 - x0) : 0.0;
+                fitted[i] = anchorFit[k] + f * (anchorFit[k + 1] - anchorFit[k]);
+            }
+        }
+        fitted[n - 1] = anchorFit.last();
+        if (iter == robustIterations) break;
+
+        // 稳健权重：bisquare(残差 / 6·中位绝对残差)
+        QVector<double> absRes(n);
+        for (int i = 0; i < n; ++i) absRes[i] = std::abs(v[i] - fitted[i]);
+        QVector<double> sorted = absRes;
+        std::nth_element(sorted.begin(), sorted.begin() + n / 2, sorted.end());
+        const double mad = sorted[n / 2];
+        if (!(mad > 0)) break;
+        for (int i = 0; i < n; ++i) {
+            double r = absRes[i] / (6.0 * mad);
+            robust[i] = (r < 1.0) ? (1.0 - r * r) * (1.0 - r * r) : 0.0;
+        }
+    }
+    return scatterBack(y, view, fitted);
+}
@@ -0,0 +1,47 @@
+/*
+ * smoothingengine.h
+ * 文件作用：导数曲线平滑算法头文件
+ * 功能描述：
+ * 1. 按点数的移动平均（与 Matlab smooth 相同，边缘处窗口自动缩小），前缀和实现，代价与窗口无关
+ * 2. 对数时间方法：窗口为 |ln t - ln ti| <= logWidth，点密度变化时仍按对数时间等宽平滑
+ *    - 对数时间移动平均 / Savitzky-Golay：窗口内最小二乘多项式，由分块前缀矩求解，代价 O(n)
+ *    - LOWESS：三次方权重的局部线性回归，带稳健迭代；按 logWidth/10 间距取锚点拟合，其余点线性插值
+ * 3. 大数组按块并行计算
+ */
+
+#ifndef SMOOTHINGENGINE_H
+#define SMOOTHINGENGINE_H
+
+#include <QVector>
+#include <QStringList>
+
+class SmoothingEngine
+{
+public:
+    enum Method {
+        MovingAverage = 0,  // 按点数移动平均
+        LogMovingAverage,   // 对数时间移动平均
+        SavitzkyGolay,      // 对数时间 Savitzky-Golay (二次)
+        Lowess              // 对数时间 LOWESS
+    };
+
+    static QStringList methodNames();
+
+    static const int kParallelThreshold = 100000;   // 超过该点数时分块并行计算
+
+    /**
+     * @brief 按指定方法平滑
+     * @param t 时间（对数时间方法使用；t <= 0 的点保持原值且不参与平滑）
+     * @param span 按点数移动平均的窗口点数（奇数，偶数自动 +1）
+     * @param logWidth 对数时间方法的半窗宽 (ln t)
+     */
+    static QVector<double> smooth(const QVector<double>& t, const QVector<double>& y,
+                                  Method method, int span, double logWidth);
+
+    static QVector<double> movingAverage(const QVector<double>& y, int span);
+    static QVector<double> logMovingAverage(const QVector<double>& t, const QVector<double>& y, double logWidth);
+    static QVector<double> savitzkyGolay(const QVector<double>& t, const QVector<double>& y, double logWidth, int order = 2);
+    static QVector<double> lowess(const QVector<double>& t, const QVector<double>& y, double logWidth, int robustIterations = 2);
+};
+
+#endif // SMOOTHINGENGINE_H
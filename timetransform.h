@@ -0,0 +1,69 @@
+/*
+ * timetransform.h
+ * 文件作用：变产量时间函数（叠加时间、Agarwal 等效时间）头文件
+ * 功能描述：
+ * 1. 由产量史计算第 n 个流动段（第 n 次产量变化开始）的时间函数，Δt = t - t_n：
+ *    叠加时间函数 X = Σ_{j<=n} (Δq_j / Δq_n) · ln(t - t_j)
+ *    等效时间 te = Δt · Π_{j<n} ((t - t_j) / (t_n - t_j))^(Δq_j / Δq_n)，即 ln te = X - X(t_n⁺)
+ *    单次生产后关井时 te = tp·Δt / (tp + Δt)，首个流动段 te = Δt
+ * 2. ln te 与 X 只差常数，对 te 求的 Bourdet 导数即叠加导数 dΔp/dX，导数引擎与绘图可直接使用 te
+ * 3. 产量相同的相邻段合并；样本按时间升序时以游标跟踪所在流动段，每个样本的代价与其之前的产量变化次数成正比；
+ *    大数组按块并行
+ */
+
+#ifndef TIMETRANSFORM_H
+#define TIMETRANSFORM_H
+
+#include <QVector>
+#include <QStringList>
+#include "ratesuperposition.h"
+
+class TimeTransform
+{
+public:
+    enum Function {
+        ElapsedTime = 0,    // 流动段内经过时间 Δt
+        SuperpositionTime,  // 叠加时间函数 X
+        EquivalentTime      // Agarwal 等效时间 te
+    };
+
+    static QStringList functionNames();
+
+    static const int kParallelThreshold = 20000;   // 超过该点数时分块并行计算
+
+    explicit TimeTransform(const RateHistory& history = RateHistory());
+
+    void setHistory(const RateHistory& history);
+
+    // 流动段数（合并相同产量后的产量变化次数）
+    int periodCount() const { return m_start.size(); }
+    double periodStart(int period) const { return m_start[period]; }
+    double periodRate(int period) const { return m_rate[period]; }
+
+    // t 所在的流动段（t_n < t <= t_n+1），第一次产量变化之前返回 -1
+    int periodAt(double t) const;
+
+    /**
+     * @brief 计算时间函数
+     * @param t 与产量史同一时间轴的绝对时间
+     * @param period 参考流动段；-1 时每个样本使用其所在的流动段
+     * @return 与 t 等长；不在参考流动段之后（Δt <= 0）的样本为 NaN
+     */
+    QVector<double> transform(const QVector<double>& t, Function function, int period = -1) const;
+
+    /**
+     * @brief 流动段 period 的叠加导数 dΔp/dX（等效时间上的 Bourdet 导数）
+     * @param t 绝对时间，p 为压差；Δt <= 0 的样本导数为 0
+     */
+    QVector<double> derivative(const QVector<double>& t, const QVector<double>& p, int period, double lSpacing) const;
+
+private:
+    // 参考流动段 n 上单个样本的时间函数
+    double value(double t, int n, Function function) const;
+
+    QVector<double> m_start;    // 各流动段开始时间
+    QVector<double> m_rate;     // 各流动段产量
+    QVector<double> m_change;   // 各流动段开始时的产量变化 Δq
+};
+
+#endif // TIMETRANSFORM_H
@@ -13,8 +13,12 @@
 #include "ui_wt_fittingwidget.h"
 #include "modelparameter.h"
 #include "modelselect.h"
+#include "fittingjobscheduler.h"
+#include "modeldiscriminationdialog.h"
+#include "fittinglandscapedialog.h"
+#include "fittingmcmcdialog.h"
+#include <QMenu>
 
-#include <QtConcurrent>
 #include <QMessageBox>
 #include <QDebug>
 #include <cmath>
@@ -32,7 +36,6 @@
 #include <QJsonArray>
 #include <QDateTime>
 #include <QBuffer>
-#include <Eigen/Dense>
 
 // ===========================================================================
 // FittingWidget 实现
@@ -44,7 +47,12 @@ FittingWidget::FittingWidget(QWidget *parent) :
     m_modelManager(nullptr),
     m_plotTitle(nullptr),
     m_currentModelType(ModelManager::Model_1),
-    m_isFitting(false)
+    m_engine(nullptr),
+    m_isFitting(false),
+    m_silentFit(false),
+    m_jobId(-1),
+    m_refreshTimer(nullptr),
+    m_lastFitError(0.0)
 {
     ui->setupUi(this);
 
@@ -58,6 +66,15 @@ FittingWidget::FittingWidget(QWidget *parent) :
     // --- 初始化数据加载模块 ---
     m_dataLoader = new FittingObservedData(this);
 
+    // --- 初始化拟合计算引擎 ---
+    m_engine = new FittingEngine(nullptr, this);
+    ui->comboAlgorithm->addItem("LM 局部优化", static_cast<int>(FittingAlgorithm::LevenbergMarquardt));
+    ui->comboAlgorithm->addItem("差分进化全局优化 + LM 精修", static_cast<int>(FittingAlgorithm::DifferentialEvolution));
+    ui->comboDecimation->addItem("中值", static_cast<int>(DecimationMethod::Median));
+    ui->comboDecimation->addItem("均值", static_cast<int>(DecimationMethod::Mean));
+    ui->comboBoundHandling->addItem("投影约束 (有效集)", static_cast<int>(BoundHandling::Projected));
+    ui->comboBoundHandling->addItem("Logit 变换", static_cast<int>(BoundHandling::Logit));
+
     // --- 初始化绘图控件 ---
     m_plot = new MouseZoom(this);
     ui->plotContainer->layout()->addWidget(m_plot);
@@ -67,11 +84,23 @@ FittingWidget::FittingWidget(QWidget *parent) :
     qRegisterMetaType<QMap<QString,double>>("QMap<QString,double>");
     qRegisterMetaType<ModelManager::ModelType>("ModelManager::ModelType");
     qRegisterMetaType<QVector<double>>("QVector<double>");
+    qRegisterMetaType<FittingSnapshotPtr>("FittingSnapshotPtr");
+    qRegisterMetaType<FittingCheckpoint>("FittingCheckpoint");
+
+    // 迭代刷新限制在约 30 帧/秒
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(33);
+    connect(m_refreshTimer, &QTimer::timeout, this, &FittingWidget::applyPendingSnapshot);
 
     // --- 信号连接 ---
-    connect(this, &FittingWidget::sigIterationUpdated, this, &FittingWidget::onIterationUpdate, Qt::QueuedConnection);
+    connect(this, &FittingWidget::sigIterationUpdated, this, &FittingWidget::onSnapshotReceived, Qt::QueuedConnection);
     connect(this, &FittingWidget::sigProgress, ui->progressBar, &QProgressBar::setValue);
-    connect(&m_watcher, &QFutureWatcher<void>::finished, this, &FittingWidget::onFitFinished);
+    connect(FittingJobScheduler::instance(), &FittingJobScheduler::jobFinished, this, &FittingWidget::onJobFinished);
+    // 引擎信号转发（引擎在工作线程中发射）
+    connect(m_engine, &FittingEngine::iterationUpdated, this, &FittingWidget::sigIterationUpdated);
+    connect(m_engine, &FittingEngine::progressChanged, this, &FittingWidget::sigProgress);
+    connect(m_engine, &FittingEngine::checkpointReached, this, &FittingWidget::onCheckpointReached);
 
     // [注意] 此处删除了 btnSelectParams 的手动 connect，避免弹窗出现两次
 
@@ -83,11 +112,23 @@ FittingWidget::FittingWidget(QWidget *parent) :
     onSliderWeightChanged(50);
 }
 
-FittingWidget::~FittingWidget() { delete ui; }
+FittingWidget::~FittingWidget()
+{
+    // 窗口销毁前需等待后台拟合线程退出
+    disconnect(FittingJobScheduler::instance(), nullptr, this, nullptr);
+    if(m_jobId >= 0) {
+        FittingJobScheduler::instance()->cancelAndWait(m_jobId);
+        // 停止检查点经排队信号发出，此时已无法送达本窗口，在此直接保存
+        FittingCheckpoint ckpt = m_engine->takeStopCheckpoint();
+        if(ckpt.isValid()) ModelParameter::instance()->saveFitCheckpoint(checkpointKey(), ckpt.toJson());
+    }
+    delete ui;
+}
 
 void FittingWidget::setModelManager(ModelManager *m) {
     m_modelManager = m;
     m_paramChart->setModelManager(m);
+    m_engine->setModelManager(m);
     initializeDefaultModel();
 }
 
@@ -133,6 +174,14 @@ QJsonObject FittingWidget::getJsonState() const
     root["modelType"] = (int)m_currentModelType;
     root["modelName"] = ModelManager::getModelTypeName(m_currentModelType);
     root["fitWeightVal"] = ui->sliderWeight->value();
+    root["fitAlgorithm"] = ui->comboAlgorithm->currentIndex();
+    root["multiFidelity"] = ui->checkMultiFidelity->isChecked();
+    root["separableScale"] = ui->checkSeparableScale->isChecked();
+    root["separableTime"] = ui->checkSeparableTime->isChecked();
+    root["boundHandling"] = ui->comboBoundHandling->currentIndex();
+    root["decimationPointsPerDecade"] = ui->spinPointsPerDecade->value();
+    root["decimationMethod"] = ui->comboDecimation->currentIndex();
+    root["checkpointInterval"] = ui->spinCheckpointInterval->value();
 
     QJsonObject plotRange;
     plotRange["xMin"] = m_plot->xAxis->range().lower;
@@ -217,6 +266,14 @@ void FittingWidget::loadFittingState(const QJsonObject& root)
         double w = root["fitWeight"].toDouble();
         ui->sliderWeight->setValue((int)(w * 100));
     }
+    if (root.contains("fitAlgorithm")) ui->comboAlgorithm->setCurrentIndex(root["fitAlgorithm"].toInt());
+    if (root.contains("multiFidelity")) ui->checkMultiFidelity->setChecked(root["multiFidelity"].toBool());
+    if (root.contains("separableScale")) ui->checkSeparableScale->setChecked(root["separableScale"].toBool());
+    if (root.contains("separableTime")) ui->checkSeparableTime->setChecked(root["separableTime"].toBool());
+    if (root.contains("boundHandling")) ui->comboBoundHandling->setCurrentIndex(root["boundHandling"].toInt());
+    if (root.contains("decimationPointsPerDecade")) ui->spinPointsPerDecade->setValue(root["decimationPointsPerDecade"].toInt());
+    if (root.contains("decimationMethod")) ui->comboDecimation->setCurrentIndex(root["decimationMethod"].toInt());
+    if (root.contains("checkpointInterval")) ui->spinCheckpointInterval->setValue(root["checkpointInterval"].toInt());
 
     if (root.contains("observedData")) {
         QJsonObject obs = root["observedData"].toObject();
@@ -372,7 +429,7 @@ void FittingWidget::on_btn_modelSelect_clicked() {
             m_paramChart->switchModel(newType);
             m_currentModelType = newType;
             ui->btn_modelSelect->setText("当前: " + name);
-            updateModelCurve();
+            if (!applyWarmStart()) updateModelCurve();
         } else {
             QMessageBox::warning(this, "提示", "所选组合暂无对应的模型。\nCode: " + code);
         }
@@ -445,6 +502,18 @@ void FittingWidget::setObservedData(const QVector<double>& t, const QVector<doub
     if(m_plot->xAxis->range().lower<=0) m_plot->xAxis->setRangeLower(1e-3);
     if(m_plot->yAxis->range().lower<=0) m_plot->yAxis->setRangeLower(1e-3);
     m_plot->replot();
+
+    // 参数仍为默认值（新建分析页或刚重置）时，以历史解热启动
+    if(paramsAtDefaults()) applyWarmStart();
+}
+
+bool FittingWidget::paramsAtDefaults() const {
+    if(!m_modelManager) return false;
+    QMap<QString, double> defaults = m_modelManager->getDefaultParameters(m_currentModelType);
+    for(const FitParameter& fp : m_paramChart->getParameters()) {
+        if(defaults.contains(fp.name) && std::abs(fp.value - defaults.value(fp.name)) > 1e-12 * qMax(1.0, std::abs(fp.value))) return false;
+    }
+    return true;
 }
 
 void FittingWidget::on_btnResetView_clicked() {
@@ -475,22 +544,220 @@ void FittingWidget::on_btnLoadData_clicked() {
 void FittingWidget::on_btnRunFit_clicked() {
     if(m_isFitting) return;
     if(m_obsTime.isEmpty()) { QMessageBox::warning(this,"错误","请先加载观测数据。"); return; }
+    startFit(1, false);
+}
+
+void FittingWidget::setAnalysisName(const QString& name) { m_analysisName = name; updateResumeButton(); }
+bool FittingWidget::isFitting() const { return m_isFitting; }
+
+bool FittingWidget::startFit(int priority, bool silent) {
+    if(m_isFitting || m_obsTime.isEmpty()) return false;
 
     m_paramChart->updateParamsFromTable();
-    m_isFitting = true; m_stopRequested = false; ui->btnRunFit->setEnabled(false);
+    m_isFitting = true; m_silentFit = silent; ui->btnRunFit->setEnabled(false);
+    m_lastFitParams.clear();
 
     ModelManager::ModelType modelType = m_currentModelType;
     QList<FitParameter> paramsCopy = m_paramChart->getParameters();
 
     double w = ui->sliderWeight->value() / 100.0;
-    (void)QtConcurrent::run([this, modelType, paramsCopy, w](){ runOptimizationTask(modelType, paramsCopy, w); });
+    prepareEngineData(m_engine);
+    configureEngine(m_engine);
+
+    // 提交到全局调度器：多个分析页共享有界线程池，排队等待空闲线程
+    ui->btnResumeFit->setEnabled(false);
+    m_jobId = FittingJobScheduler::instance()->submit(checkpointKey(), m_engine, modelType, paramsCopy, w, priority);
+    return true;
+}
+
+void FittingWidget::on_btnStop_clicked() {
+    if(m_jobId >= 0) FittingJobScheduler::instance()->cancel(m_jobId);
+}
+
+void FittingWidget::prepareEngineData(FittingEngine* engine) {
+    // 对数时间抽稀：迭代使用抽稀数据，完整数据仅用于显示和最终误差验证
+    QVector<double> fitT, fitP, fitD;
+    FittingObservedData::decimateLogTime(m_obsTime, m_obsPressure, m_obsDerivative,
+                                         ui->spinPointsPerDecade->value(),
+                                         static_cast<DecimationMethod>(ui->comboDecimation->currentData().toInt()),
+                                         fitT, fitP, fitD);
+    engine->setObservedData(fitT, fitP, fitD);
+    if (fitT.size() < m_obsTime.size())
+        engine->setValidationData(m_obsTime, m_obsPressure, m_obsDerivative);
+    else
+        engine->setValidationData(QVector<double>(), QVector<double>(), QVector<double>());
+}
+
+void FittingWidget::configureEngine(FittingEngine* engine) {
+    engine->setAlgorithm(static_cast<FittingAlgorithm>(ui->comboAlgorithm->currentData().toInt()));
+    engine->setContinuationSchedule(ui->checkMultiFidelity->isChecked() ? FittingEngine::defaultContinuationSchedule()
+                                                                         : FittingEngine::singleStageSchedule());
+    engine->setSeparableOptions(ui->checkSeparableScale->isChecked(), ui->checkSeparableTime->isChecked());
+    engine->setBoundHandling(static_cast<BoundHandling>(ui->comboBoundHandling->currentData().toInt()));
+    engine->setCheckpointInterval(ui->spinCheckpointInterval->value());
+}
+
+void FittingWidget::on_btnFitAllModels_clicked() {
+    if(m_isFitting) return;
+    if(m_obsTime.isEmpty()) { QMessageBox::warning(this,"错误","请先加载观测数据。"); return; }
+    if(!m_modelManager) return;
+    m_paramChart->updateParamsFromTable();
+
+    // 各候选模型共用同一份抽稀数据，并统一在完整观测数据上评价
+    QVector<double> fitT, fitP, fitD;
+    FittingObservedData::decimateLogTime(m_obsTime, m_obsPressure, m_obsDerivative,
+                                         ui->spinPointsPerDecade->value(),
+                                         static_cast<DecimationMethod>(ui->comboDecimation->currentData().toInt()),
+                                         fitT, fitP, fitD);
+
+    FittingModelDiscrimination discrimination(m_modelManager);
+    discrimination.setObservedData(fitT, fitP, fitD, m_obsTime, m_obsPressure, m_obsDerivative);
+    discrimination.setEngineSetup([this](FittingEngine* engine) { configureEngine(engine); });
+
+    ModelDiscriminationDialog dlg(&discrimination, m_paramChart->getParameters(), ui->sliderWeight->value() / 100.0, this);
+    int ret = dlg.exec();
+
+    // 各候选模型的拟合结果均存入历史解缓存，供以后切换模型时热启动
+    for (const ModelCandidateResult& r : discrimination.results()) {
+        if (r.state != ModelCandidateResult::Finished) continue;
+        QMap<QString, double> values;
+        for (const FitParameter& fp : r.params) values.insert(fp.name, fp.value);
+        FittingSolutionCache::store(m_obsTime, m_obsPressure, m_obsDerivative, r.type, values, r.mse);
+    }
+    if (ret != QDialog::Accepted) return;
+
+    m_currentModelType = dlg.getSelectedModel();
+    ui->btn_modelSelect->setText("当前: " + ModelManager::getModelTypeName(m_currentModelType));
+    m_paramChart->setParameters(dlg.getSelectedParameters());
+    updateModelCurve();
+}
+
+void FittingWidget::on_btnLandscape_clicked() {
+    if(m_obsTime.isEmpty()) { QMessageBox::warning(this,"错误","请先加载观测数据。"); return; }
+    if(!m_modelManager) return;
+    m_paramChart->updateParamsFromTable();
+
+    // 误差曲面使用与拟合相同的抽稀数据
+    QVector<double> fitT, fitP, fitD;
+    FittingObservedData::decimateLogTime(m_obsTime, m_obsPressure, m_obsDerivative,
+                                         ui->spinPointsPerDecade->value(),
+                                         static_cast<DecimationMethod>(ui->comboDecimation->currentData().toInt()),
+                                         fitT, fitP, fitD);
+
+    FittingLandscapeDialog dlg(m_modelManager, m_currentModelType, m_paramChart->getParameters(),
+                               fitT, fitP, fitD, ui->sliderWeight->value() / 100.0, this);
+    if (dlg.exec() != QDialog::Accepted) return;
+    m_paramChart->setParameters(dlg.getUpdatedParams());
+    updateModelCurve();
+}
+
+void FittingWidget::on_btnMcmc_clicked() {
+    if(m_obsTime.isEmpty()) { QMessageBox::warning(this,"错误","请先加载观测数据。"); return; }
+    if(!m_modelManager) return;
+    if(m_isFitting) { QMessageBox::warning(this,"提示","拟合进行中，请在拟合完成后再进行后验采样。"); return; }
+    m_paramChart->updateParamsFromTable();
+
+    // 似然使用与拟合相同的抽稀数据
+    QVector<double> fitT, fitP, fitD;
+    FittingObservedData::decimateLogTime(m_obsTime, m_obsPressure, m_obsDerivative,
+                                         ui->spinPointsPerDecade->value(),
+                                         static_cast<DecimationMethod>(ui->comboDecimation->currentData().toInt()),
+                                         fitT, fitP, fitD);
+
+    FittingMcmcDialog dlg(m_modelManager, m_currentModelType, m_paramChart->getParameters(),
+                          fitT, fitP, fitD, ui->sliderWeight->value() / 100.0, this);
+    if (dlg.exec() != QDialog::Accepted) return;
+    m_paramChart->setParameters(dlg.getUpdatedParams());
+    updateModelCurve();
+}
+
+bool FittingWidget::applyWarmStart() {
+    if(m_obsTime.isEmpty() || m_isFitting) return false;
+    FitSolution s = FittingSolutionCache::best(m_obsTime, m_obsPressure, m_obsDerivative, m_currentModelType);
+    if(!s.isValid()) return false;
+    applySolution(s);
+    ui->label_Error->setText(QString("已载入%1数据的历史解，上次误差(MSE): %2")
+                             .arg(s.exactData ? "相同" : "近似").arg(s.error, 0, 'e', 3));
+    return true;
+}
+
+void FittingWidget::applySolution(const FitSolution& solution) {
+    if(solution.modelType != m_currentModelType) {
+        m_paramChart->switchModel(solution.modelType);
+        m_currentModelType = solution.modelType;
+        ui->btn_modelSelect->setText("当前: " + ModelManager::getModelTypeName(m_currentModelType));
+    }
+    QList<FitParameter> params = m_paramChart->getParameters();
+    for(FitParameter& fp : params) {
+        if(solution.params.contains(fp.name)) fp.value = solution.params.value(fp.name);
+    }
+    m_paramChart->setParameters(params);
+    updateModelCurve();
 }
 
-void FittingWidget::runOptimizationTask(ModelManager::ModelType modelType, QList<FitParameter> fitParams, double weight) {
-    runLevenbergMarquardtOptimization(modelType, fitParams, weight);
+void FittingWidget::on_btnSolutionCache_clicked() {
+    if(m_isFitting) return;
+    if(m_obsTime.isEmpty()) { QMessageBox::warning(this,"错误","请先加载观测数据。"); return; }
+
+    QList<FitSolution> list = FittingSolutionCache::related(m_obsTime, m_obsPressure, m_obsDerivative, m_currentModelType);
+    if(list.isEmpty()) { QMessageBox::information(this, "提示", "当前数据没有历史拟合解。"); return; }
+
+    QMenu menu(this);
+    for(const FitSolution& s : list) {
+        QString text = QString("%1  |  MSE %2  |  %3数据  |  %4")
+                           .arg(ModelManager::getModelTypeName(s.modelType))
+                           .arg(s.error, 0, 'e', 3)
+                           .arg(s.exactData ? "相同" : "近似")
+                           .arg(s.time.toString("yyyy-MM-dd hh:mm"));
+        QAction* act = menu.addAction(text);
+        if(s.modelType == m_currentModelType) { QFont f = act->font(); f.setBold(true); act->setFont(f); }
+        connect(act, &QAction::triggered, this, [this, s]() { applySolution(s); });
+    }
+    menu.exec(ui->btnSolutionCache->mapToGlobal(QPoint(0, ui->btnSolutionCache->height())));
 }
 
-void FittingWidget::on_btnStop_clicked() { m_stopRequested=true; }
+void FittingWidget::on_btnResumeFit_clicked() {
+    if(m_isFitting) return;
+    if(m_obsTime.isEmpty()) { QMessageBox::warning(this,"错误","请先加载观测数据。"); return; }
+
+    FittingCheckpoint ckpt = FittingCheckpoint::fromJson(ModelParameter::instance()->getFitCheckpoint(checkpointKey()));
+    if(!ckpt.isValid()) { updateResumeButton(); return; }
+    if(ckpt.modelType != static_cast<int>(m_currentModelType)) {
+        QMessageBox::warning(this, "错误", "检查点对应的模型为“" + ModelManager::getModelTypeName((ModelManager::ModelType)ckpt.modelType)
+                             + "”，与当前模型不一致，无法继续拟合。");
+        return;
+    }
+
+    m_engine->setResumeCheckpoint(ckpt);
+    if(!startFit(1, false)) m_engine->setResumeCheckpoint(FittingCheckpoint());
+}
+
+void FittingWidget::onJobFinished(int jobId) {
+    if(jobId != m_jobId) return;
+    m_jobId = -1;
+    // 排队中被取消的任务未消费检查点，清除以免影响下一次拟合
+    m_engine->setResumeCheckpoint(FittingCheckpoint());
+    m_engine->takeStopCheckpoint();
+    // 正常结束的拟合不再需要检查点；被停止的拟合保留检查点以便继续
+    bool completed = (FittingJobScheduler::instance()->job(jobId).state == FittingJobInfo::Finished);
+    if(completed)
+        ModelParameter::instance()->removeFitCheckpoint(checkpointKey());
+    onFitFinished();
+    if(completed && !m_lastFitParams.isEmpty())
+        FittingSolutionCache::store(m_obsTime, m_obsPressure, m_obsDerivative, m_currentModelType, m_lastFitParams, m_lastFitError);
+    updateResumeButton();
+}
+
+void FittingWidget::onCheckpointReached(const FittingCheckpoint& checkpoint) {
+    ModelParameter::instance()->saveFitCheckpoint(checkpointKey(), checkpoint.toJson());
+}
+
+QString FittingWidget::checkpointKey() const { return m_analysisName.isEmpty() ? QString("拟合") : m_analysisName; }
+
+void FittingWidget::updateResumeButton() {
+    bool hasCheckpoint = FittingCheckpoint::fromJson(ModelParameter::instance()->getFitCheckpoint(checkpointKey())).isValid();
+    ui->btnResumeFit->setEnabled(hasCheckpoint && !m_isFitting);
+}
 void FittingWidget::on_btnImportModel_clicked() { updateModelCurve(); }
 
 void FittingWidget::on_btnExportData_clicked() {
@@ -570,138 +837,6 @@ void FittingWidget::updateModelCurve() {
     onIterationUpdate(0, currentParams, std::get<0>(res), std::get<1>(res), std::get<2>(res));
 }
 
-void FittingWidget::runLevenbergMarquardtOptimization(ModelManager::ModelType modelType, QList<FitParameter> params, double weight) {
-    if(m_modelManager) m_modelManager->setHighPrecision(false);
-
-    QVector<int> fitIndices;
-    for(int i=0; i<params.size(); ++i) if(params[i].isFit) fitIndices.append(i);
-    int nParams = fitIndices.size();
-    if(nParams == 0) { QMetaObject::invokeMethod(this, "onFitFinished"); return; }
-
-    double lambda = 0.01; int maxIter = 50; double currentSSE = 1e15;
-    QMap<QString, double> currentParamMap;
-    for(const auto& p : params) currentParamMap.insert(p.name, p.value);
-
-    if(currentParamMap.contains("L") && currentParamMap.contains("Lf") && currentParamMap["L"] > 1e-9)
-        currentParamMap["LfD"] = currentParamMap["Lf"] / currentParamMap["L"];
-
-    QVector<double> residuals = calculateResiduals(currentParamMap, modelType, weight);
-    currentSSE = calculateSumSquaredError(residuals);
-    ModelCurveData curve = m_modelManager->calculateTheoreticalCurve(modelType, currentParamMap);
-    emit sigIterationUpdated(currentSSE/residuals.size(), currentParamMap, std::get<0>(curve), std::get<1>(curve), std::get<2>(curve));
-
-    for(int iter = 0; iter < maxIter; ++iter) {
-        if(m_stopRequested) break;
-        if (!residuals.isEmpty() && (currentSSE / residuals.size()) < 3e-3) break;
-
-        emit sigProgress(iter * 100 / maxIter);
-        QVector<QVector<double>> J = computeJacobian(currentParamMap, residuals, fitIndices, modelType, params, weight);
-        int nRes = residuals.size();
-
-        QVector<QVector<double>> H(nParams, QVector<double>(nParams, 0.0));
-        QVector<double> g(nParams, 0.0);
-        for(int k=0; k<nRes; ++k) {
-            for(int i=0; i<nParams; ++i) {
-                g[i] += J[k][i] * residuals[k];
-                for(int j=0; j<=i; ++j) H[i][j] += J[k][i] * J[k][j];
-            }
-        }
-        for(int i=0; i<nParams; ++i) for(int j=i+1; j<nParams; ++j) H[i][j] = H[j][i];
-
-        bool stepAccepted = false;
-        for(int tryIter=0; tryIter<5; ++tryIter) {
-            QVector<QVector<double>> H_lm = H;
-            for(int i=0; i<nParams; ++i) H_lm[i][i] += lambda * (1.0 + std::abs(H[i][i]));
-            QVector<double> negG(nParams); for(int i=0;i<nParams;++i) negG[i] = -g[i];
-            QVector<double> delta = solveLinearSystem(H_lm, negG);
-
-            QMap<QString, double> trialMap = currentParamMap;
-            for(int i=0; i<nParams; ++i) {
-                int pIdx = fitIndices[i];
-                QString pName = params[pIdx].name;
-                double oldVal = currentParamMap[pName];
-                bool isLog = (oldVal > 1e-12 && pName != "S" && pName != "nf");
-                double newVal;
-                if(isLog) {
-                    double logVal = log10(oldVal) + delta[i];
-                    newVal = pow(10.0, logVal);
-                } else {
-                    newVal = oldVal + delta[i];
-                }
-                newVal = qMax(params[pIdx].min, qMin(newVal, params[pIdx].max));
-                trialMap[pName] = newVal;
-            }
-            if(trialMap.contains("L") && trialMap.contains("Lf") && trialMap["L"] > 1e-9) trialMap["LfD"] = trialMap["Lf"] / trialMap["L"];
-
-            QVector<double> newRes = calculateResiduals(trialMap, modelType, weight);
-            double newSSE = calculateSumSquaredError(newRes);
-            if(newSSE < currentSSE) {
-                currentSSE = newSSE; currentParamMap = trialMap; residuals = newRes; lambda /= 10.0; stepAccepted = true;
-                ModelCurveData iterCurve = m_modelManager->calculateTheoreticalCurve(modelType, currentParamMap);
-                emit sigIterationUpdated(currentSSE/nRes, currentParamMap, std::get<0>(iterCurve), std::get<1>(iterCurve), std::get<2>(iterCurve));
-                break;
-            } else { lambda *= 10.0; }
-        }
-        if(!stepAccepted && lambda > 1e10) break;
-    }
-
-    if(m_modelManager) m_modelManager->setHighPrecision(true);
-    if(currentParamMap.contains("L") && currentParamMap.contains("Lf") && currentParamMap["L"] > 1e-9)
-        currentParamMap["LfD"] = currentParamMap["Lf"] / currentParamMap["L"];
-    ModelCurveData finalCurve = m_modelManager->calculateTheoreticalCurve(modelType, currentParamMap);
-    emit sigIterationUpdated(currentSSE/residuals.size(), currentParamMap, std::get<0>(finalCurve), std::get<1>(finalCurve), std::get<2>(finalCurve));
-    QMetaObject::invokeMethod(this, "onFitFinished");
-}
-
-QVector<double> FittingWidget::calculateResiduals(const QMap<QString, double>& params, ModelManager::ModelType modelType, double weight) {
-    if(!m_modelManager || m_obsTime.isEmpty()) return QVector<double>();
-    ModelCurveData res = m_modelManager->calculateTheoreticalCurve(modelType, params, m_obsTime);
-    const QVector<double>& pCal = std::get<1>(res); const QVector<double>& dpCal = std::get<2>(res);
-    QVector<double> r; double wp = weight; double wd = 1.0 - weight;
-    int count = qMin(m_obsPressure.size(), pCal.size());
-    for(int i=0; i<count; ++i) {
-        if(m_obsPressure[i] > 1e-10 && pCal[i] > 1e-10) r.append( (log(m_obsPressure[i]) - log(pCal[i])) * wp ); else r.append(0.0);
-    }
-    int dCount = qMin(m_obsDerivative.size(), dpCal.size()); dCount = qMin(dCount, count);
-    for(int i=0; i<dCount; ++i) {
-        if(m_obsDerivative[i] > 1e-10 && dpCal[i] > 1e-10) r.append( (log(m_obsDerivative[i]) - log(dpCal[i])) * wd ); else r.append(0.0);
-    }
-    return r;
-}
-
-QVector<QVector<double>> FittingWidget::computeJacobian(const QMap<QString, double>& params, const QVector<double>& baseResiduals, const QVector<int>& fitIndices, ModelManager::ModelType modelType, const QList<FitParameter>& currentFitParams, double weight) {
-    int nRes = baseResiduals.size(); int nParams = fitIndices.size();
-    QVector<QVector<double>> J(nRes, QVector<double>(nParams));
-    for(int j = 0; j < nParams; ++j) {
-        int idx = fitIndices[j]; QString pName = currentFitParams[idx].name;
-        double val = params.value(pName); bool isLog = (val > 1e-12 && pName != "S" && pName != "nf");
-        double h; QMap<QString, double> pPlus = params; QMap<QString, double> pMinus = params;
-        if(isLog) { h = 0.01; double valLog = log10(val); pPlus[pName] = pow(10.0, valLog + h); pMinus[pName] = pow(10.0, valLog - h); }
-        else { h = 1e-4; pPlus[pName] = val + h; pMinus[pName] = val - h; }
-        auto updateDeps = [](QMap<QString,double>& map) { if(map.contains("L") && map.contains("Lf") && map["L"] > 1e-9) map["LfD"] = map["Lf"] / map["L"]; };
-        if(pName == "L" || pName == "Lf") { updateDeps(pPlus); updateDeps(pMinus); }
-        QVector<double> rPlus = calculateResiduals(pPlus, modelType, weight);
-        QVector<double> rMinus = calculateResiduals(pMinus, modelType, weight);
-        if(rPlus.size() == nRes && rMinus.size() == nRes) {
-            for(int i=0; i<nRes; ++i) J[i][j] = (rPlus[i] - rMinus[i]) / (2.0 * h);
-        }
-    }
-    return J;
-}
-
-QVector<double> FittingWidget::solveLinearSystem(const QVector<QVector<double>>& A, const QVector<double>& b) {
-    int n = b.size(); if (n == 0) return QVector<double>();
-    Eigen::MatrixXd matA(n, n); Eigen::VectorXd vecB(n);
-    for (int i = 0; i < n; ++i) { vecB(i) = b[i]; for (int j = 0; j < n; ++j) matA(i, j) = A[i][j]; }
-    Eigen::VectorXd x = matA.ldlt().solve(vecB);
-    QVector<double> res(n); for (int i = 0; i < n; ++i) res[i] = x(i);
-    return res;
-}
-
-double FittingWidget::calculateSumSquaredError(const QVector<double>& residuals) {
-    double sse = 0.0; for(double v : residuals) sse += v*v; return sse;
-}
-
 void FittingWidget::onIterationUpdate(double err, const QMap<QString,double>& p,
                                       const QVector<double>& t, const QVector<double>& p_curve, const QVector<double>& d_curve) {
     ui->label_Error->setText(QString("误差(MSE): %1").arg(err, 0, 'e', 3));
@@ -719,7 +854,24 @@ void FittingWidget::onIterationUpdate(double err, const QMap<QString,double>& p,
     plotCurves(t, p_curve, d_curve, true);
 }
 
-void FittingWidget::onFitFinished() { m_isFitting = false; ui->btnRunFit->setEnabled(true); QMessageBox::information(this, "完成", "拟合完成。"); }
+void FittingWidget::onSnapshotReceived(FittingSnapshotPtr snapshot) {
+    m_pendingSnapshot = snapshot;
+    if(!m_refreshTimer->isActive()) m_refreshTimer->start();
+}
+
+void FittingWidget::applyPendingSnapshot() {
+    if(!m_pendingSnapshot) return;
+    FittingSnapshotPtr s = m_pendingSnapshot;
+    m_pendingSnapshot.reset();
+    m_lastFitParams = s->params;
+    m_lastFitError = s->error;
+    onIterationUpdate(s->error, s->params, s->t, s->p, s->d);
+}
+
+void FittingWidget::onFitFinished() {
+    m_refreshTimer->stop(); applyPendingSnapshot(); m_isFitting = false; ui->btnRunFit->setEnabled(true);
+    if(!m_silentFit) QMessageBox::information(this, "完成", "拟合完成。");
+}
 
 void FittingWidget::plotCurves(const QVector<double>& t, const QVector<double>& p, const QVector<double>& d, bool isModel) {
     QVector<double> vt, vp, vd;
@@ -736,6 +888,6 @@ void FittingWidget::plotCurves(const QVector<double>& t, const QVector<double>&
             if(m_plot->xAxis->range().lower<=0) m_plot->xAxis->setRangeLower(1e-3);
             if(m_plot->yAxis->range().lower<=0) m_plot->yAxis->setRangeLower(1e-3);
         }
-        m_plot->replot();
+        m_plot->replot(QCustomPlot::rpQueuedReplot);
     }
 }
@@ -14,8 +14,8 @@
 #include <QWidget>
 #include <QMap>
 #include <QVector>
-#include <QFutureWatcher>
 #include <QJsonObject>
+#include <QTimer>
 #include "modelmanager.h"
 #include "mousezoom.h"
 #include "chartsetting1.h"
@@ -24,6 +24,8 @@
 #include "fittingparameterchart.h"
 #include "fittingobserveddata.h"
 #include "paramselectdialog.h"
+#include "fittingengine.h"
+#include "fittingsolutioncache.h"
 
 namespace Ui { class FittingWidget; }
 
@@ -50,11 +52,18 @@ public:
     // 获取当前拟合状态的 JSON 对象（用于保存到项目文件）
     QJsonObject getJsonState() const;
 
+    // 设置分析名称（作为拟合任务名称显示在任务监控中）
+    void setAnalysisName(const QString& name);
+    // 以当前界面设置提交拟合任务到全局调度器；silent 为 true 时结束后不弹窗（批量拟合用）
+    // 返回是否成功提交
+    bool startFit(int priority = 1, bool silent = false);
+    bool isFitting() const;
+
 signals:
     // 拟合完成信号
     void fittingCompleted(ModelManager::ModelType modelType, const QMap<QString, double>& parameters);
-    // 迭代更新信号（用于刷新曲线和误差显示）
-    void sigIterationUpdated(double error, QMap<QString, double> currentParams, QVector<double> t, QVector<double> p, QVector<double> d);
+    // 迭代更新信号（用于刷新曲线和误差显示，快照只读共享）
+    void sigIterationUpdated(FittingSnapshotPtr snapshot);
     // 进度信号
     void sigProgress(int progress);
     // 请求保存信号
@@ -65,6 +74,7 @@ private slots:
     void on_btnLoadData_clicked();      // 加载数据
     void on_btnRunFit_clicked();        // 开始拟合
     void on_btnStop_clicked();          // 停止拟合
+    void on_btnResumeFit_clicked();     // 从检查点继续拟合
     void on_btnImportModel_clicked();   // 刷新曲线
     void on_btnExportData_clicked();    // 导出参数
     void on_btnExportChart_clicked();   // 导出图表
@@ -73,12 +83,20 @@ private slots:
     void on_btnChartSettings_clicked(); // 图表设置
     void on_btn_modelSelect_clicked();  // 选择模型
     void on_btnSelectParams_clicked();  // 打开参数选择对话框
+    void on_btnFitAllModels_clicked();  // 自动模型识别
+    void on_btnLandscape_clicked();     // 二维误差曲面
+    void on_btnMcmc_clicked();          // 参数后验采样
+    void on_btnSolutionCache_clicked(); // 选择历史拟合解作为初值
 
     void on_btnSaveFit_clicked();       // 保存结果
     void on_btnExportReport_clicked();  // 导出报告
 
     // 内部逻辑槽函数
     void onIterationUpdate(double err, const QMap<QString,double>& p, const QVector<double>& t, const QVector<double>& p_curve, const QVector<double>& d_curve);
+    void onSnapshotReceived(FittingSnapshotPtr snapshot); // 缓存最新快照，按帧率合并刷新
+    void applyPendingSnapshot();                           // 刷新定时器触发：显示最新快照
+    void onJobFinished(int jobId);
+    void onCheckpointReached(const FittingCheckpoint& checkpoint); // 保存检查点到项目
     void onFitFinished();
     void onSliderWeightChanged(int value); // 权重滑块改变
 
@@ -92,6 +110,7 @@ private:
     // --- 核心模块实例 ---
     FittingParameterChart* m_paramChart; // 负责参数数据与表格的管理
     FittingObservedData* m_dataLoader;   // 负责数据文件的加载与解析
+    FittingEngine* m_engine;             // 负责拟合算法计算 (LM / 差分进化)
 
     // 本地缓存的观测数据
     QVector<double> m_obsTime;
@@ -100,8 +119,34 @@ private:
 
     // 拟合控制标志
     bool m_isFitting;
-    bool m_stopRequested;
-    QFutureWatcher<void> m_watcher;
+    bool m_silentFit;       // 本次拟合结束后不弹出提示
+    int m_jobId;            // 当前拟合任务在调度器中的 ID (-1 表示无)
+    QString m_analysisName;
+
+    // 迭代刷新合并：只显示刷新周期内的最新快照
+    FittingSnapshotPtr m_pendingSnapshot;
+    QTimer* m_refreshTimer;
+
+    // 本次拟合最近一次显示的参数与误差（拟合正常结束后存入历史解缓存）
+    QMap<QString, double> m_lastFitParams;
+    double m_lastFitError;
+
+    // 按当前界面设置为引擎准备拟合数据（对数抽稀 + 验证数据）
+    void prepareEngineData(FittingEngine* engine);
+    // 按当前界面设置配置引擎算法选项
+    void configureEngine(FittingEngine* engine);
+
+    // 以当前数据 + 模型的最优历史解作为初值，返回是否找到
+    bool applyWarmStart();
+    // 应用历史解（模型不同时先切换模型，只覆盖同名参数）
+    void applySolution(const FitSolution& solution);
+    // 参数表是否仍为当前模型的默认值
+    bool paramsAtDefaults() const;
+
+    // 检查点在项目中的键（分析页名称）
+    QString checkpointKey() const;
+    // 根据是否存在检查点更新“继续拟合”按钮状态
+    void updateResumeButton();
 
     // 初始化绘图控件配置
     void setupPlot();
@@ -110,19 +155,6 @@ private:
     // 根据当前参数更新理论曲线
     void updateModelCurve();
 
-    // 优化算法相关函数 (Levenberg-Marquardt)
-    void runOptimizationTask(ModelManager::ModelType modelType, QList<FitParameter> fitParams, double weight);
-    void runLevenbergMarquardtOptimization(ModelManager::ModelType modelType, QList<FitParameter> params, double weight);
-
-    // 计算残差
-    QVector<double> calculateResiduals(const QMap<QString, double>& params, ModelManager::ModelType modelType, double weight);
-    // 计算雅可比矩阵
-    QVector<QVector<double>> computeJacobian(const QMap<QString, double>& params, const QVector<double>& residuals, const QVector<int>& fitIndices, ModelManager::ModelType modelType, const QList<FitParameter>& currentFitParams, double weight);
-    // 求解线性方程组 (Eigen)
-    QVector<double> solveLinearSystem(const QVector<QVector<double>>& A, const QVector<double>& b);
-    // 计算平方误差和
-    double calculateSumSquaredError(const QVector<double>& residuals);
-
     // 获取图表 Base64 字符串用于报告
     QString getPlotImageBase64();
     // 绘制曲线
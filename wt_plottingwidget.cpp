@@ -18,6 +18,10 @@
 #include "chartsetting1.h"
 #include "chartsetting2.h"
 #include "modelparameter.h"
+#include "derivativeengine.h"
+#include "smoothingengine.h"
+#include "timetransform.h"
+#include "pressurederivativecalculator.h"
 
 #include <QMessageBox>
 #include <QFileDialog>
@@ -26,6 +30,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QInputDialog>
 #include <QtMath>
 
 // === JSON 转换辅助 ===
@@ -71,7 +76,12 @@ QJsonObject CurveInfo::toJson() const {
         obj["isMeasuredP"] = isMeasuredP;
         obj["LSpacing"] = LSpacing;
         obj["isSmooth"] = isSmooth;
+        obj["smoothMethod"] = smoothMethod;
         obj["smoothFactor"] = smoothFactor;
+        obj["smoothWidth"] = smoothWidth;
+        obj["timeFunction"] = timeFunction;
+        obj["rateCol"] = rateCol;
+        obj["derivAlgorithm"] = derivAlgorithm;
         obj["derivData"] = vectorToJson(derivData);
         obj["derivShape"] = (int)derivShape;
         obj["derivPointColor"] = derivPointColor.name();
@@ -112,7 +122,12 @@ CurveInfo CurveInfo::fromJson(const QJsonObject& json) {
         info.isMeasuredP = json["isMeasuredP"].toBool();
         info.LSpacing = json["LSpacing"].toDouble();
         info.isSmooth = json["isSmooth"].toBool();
+        info.smoothMethod = json["smoothMethod"].toInt(0);
         info.smoothFactor = json["smoothFactor"].toInt();
+        info.smoothWidth = json["smoothWidth"].toDouble(0.2);
+        info.timeFunction = json["timeFunction"].toInt(0);
+        info.rateCol = json["rateCol"].toInt(-1);
+        info.derivAlgorithm = json["derivAlgorithm"].toInt(DerivativeEngine::Bourdet);
         info.derivData = jsonToVector(json["derivData"].toArray());
         info.derivShape = (QCPScatterStyle::ScatterShape)json["derivShape"].toInt();
         info.derivPointColor = QColor(json["derivPointColor"].toString());
@@ -155,7 +170,18 @@ WT_PlottingWidget::~WT_PlottingWidget()
     delete ui;
 }
 
-void WT_PlottingWidget::setDataModel(QStandardItemModel* model) { m_dataModel = model; }
+void WT_PlottingWidget::setDataModel(QStandardItemModel* model)
+{
+    if (m_dataModel == model) return;
+    if (m_dataModel) disconnect(m_dataModel, nullptr, this, nullptr);
+    m_dataModel = model;
+    onSourceRowsChanged();
+    if (!m_dataModel) return;
+    connect(m_dataModel, &QStandardItemModel::dataChanged, this, &WT_PlottingWidget::onSourceDataChanged);
+    connect(m_dataModel, &QStandardItemModel::rowsInserted, this, &WT_PlottingWidget::onSourceRowsChanged);
+    connect(m_dataModel, &QStandardItemModel::rowsRemoved, this, &WT_PlottingWidget::onSourceRowsChanged);
+    connect(m_dataModel, &QStandardItemModel::modelReset, this, &WT_PlottingWidget::onSourceRowsChanged);
+}
 void WT_PlottingWidget::setProjectPath(const QString& path) { m_projectPath = path; }
 
 // [新增] 加载项目数据
@@ -263,11 +289,7 @@ void WT_PlottingWidget::on_btn_NewCurve_clicked()
         info.pointShape = dlg.getPointShape(); info.pointColor = dlg.getPointColor();
         info.lineStyle = dlg.getLineStyle(); info.lineColor = dlg.getLineColor();
         info.type = 0;
-
-        for(int i=0; i<m_dataModel->rowCount(); ++i) {
-            info.xData.append(m_dataModel->item(i, info.xCol)->text().toDouble());
-            info.yData.append(m_dataModel->item(i, info.yCol)->text().toDouble());
-        }
+        buildCurveData(info);
 
         m_curves.insert(info.name, info);
         ui->listWidget_Curves->addItem(info.name);
@@ -298,13 +320,7 @@ void WT_PlottingWidget::on_btn_PressureRate_clicked()
         info.type = 1;
         info.xCol = dlg.getPressXCol(); info.yCol = dlg.getPressYCol();
         info.x2Col = dlg.getProdXCol(); info.y2Col = dlg.getProdYCol();
-
-        for(int i=0; i<m_dataModel->rowCount(); ++i) {
-            info.xData.append(m_dataModel->item(i, info.xCol)->text().toDouble());
-            info.yData.append(m_dataModel->item(i, info.yCol)->text().toDouble());
-            info.x2Data.append(m_dataModel->item(i, info.x2Col)->text().toDouble());
-            info.y2Data.append(m_dataModel->item(i, info.y2Col)->text().toDouble());
-        }
+        buildCurveData(info);
 
         info.pointShape = dlg.getPressShape(); info.pointColor = dlg.getPressPointColor();
         info.lineStyle = dlg.getPressLineStyle(); info.lineColor = dlg.getPressLineColor();
@@ -346,45 +362,14 @@ void WT_PlottingWidget::on_btn_Derivative_clicked()
         info.isMeasuredP = dlg.isMeasuredPressure();
         info.LSpacing = dlg.getLSpacing();
         info.isSmooth = dlg.isSmoothEnabled();
+        info.smoothMethod = dlg.getSmoothMethod();
         info.smoothFactor = dlg.getSmoothFactor();
+        info.smoothWidth = dlg.getSmoothWidth();
+        info.timeFunction = dlg.getTimeFunction();
+        info.rateCol = dlg.getRateColumn();
+        info.derivAlgorithm = dlg.getDerivAlgorithm();
 
-        double initialP = 0; bool first = true;
-        for(int i=0; i<m_dataModel->rowCount(); ++i) {
-            double t = m_dataModel->item(i, info.xCol)->text().toDouble();
-            double p = m_dataModel->item(i, info.yCol)->text().toDouble();
-            if(first) { initialP = p; first = false; }
-            double dp = info.isMeasuredP ? std::abs(p - initialP) : p;
-            if(t > 0 && dp > 0) { info.xData.append(t); info.yData.append(dp); }
-        }
-
-        if(info.xData.size() < 3) { QMessageBox::warning(this, "错误", "数据点不足"); return; }
-
-        QVector<double> derData;
-        for (int i = 0; i < info.xData.size(); ++i) {
-            double t = info.xData[i];
-            double logT = std::log(t);
-            int l=i, r=i;
-            while(l>0 && std::log(info.xData[l]) > logT - info.LSpacing) l--;
-            while(r<info.xData.size()-1 && std::log(info.xData[r]) < logT + info.LSpacing) r++;
-            double num = info.yData[r] - info.yData[l];
-            double den = std::log(info.xData[r]) - std::log(info.xData[l]);
-            derData.append(std::abs(den)>1e-6 ? num/den : 0);
-        }
-
-        if(info.isSmooth && info.smoothFactor > 1) {
-            QVector<double> smoothed;
-            int half = info.smoothFactor/2;
-            for (int i = 0; i < derData.size(); ++i) {
-                double sum = 0; int cnt = 0;
-                for (int j = i - half; j <= i + half; ++j) {
-                    if (j >= 0 && j < derData.size()) { sum += derData[j]; cnt++; }
-                }
-                smoothed.append(sum / cnt);
-            }
-            info.derivData = smoothed;
-        } else {
-            info.derivData = derData;
-        }
+        if(!buildCurveData(info)) { QMessageBox::warning(this, "错误", "数据点不足"); return; }
 
         info.pointShape = dlg.getPressShape(); info.pointColor = dlg.getPressPointColor();
         info.lineStyle = dlg.getPressLineStyle(); info.lineColor = dlg.getPressLineColor();
@@ -411,6 +396,206 @@ void WT_PlottingWidget::on_btn_Derivative_clicked()
     }
 }
 
+// ---------------- 曲线数据与表格同步 ----------------
+
+double WT_PlottingWidget::cellValue(int row, int col) const
+{
+    QStandardItem* item = m_dataModel ? m_dataModel->item(row, col) : nullptr;
+    return item ? PressureDerivativeCalculator::parseNumericValue(item->text()) : 0.0;
+}
+
+bool WT_PlottingWidget::buildCurveData(CurveInfo& info)
+{
+    info.xData.clear(); info.yData.clear();
+    info.x2Data.clear(); info.y2Data.clear();
+    info.derivData.clear(); info.sourceRows.clear();
+    if(!m_dataModel) return false;
+    const int rows = m_dataModel->rowCount();
+
+    if(info.type != 2) {
+        for(int i=0; i<rows; ++i) {
+            info.xData.append(cellValue(i, info.xCol));
+            info.yData.append(cellValue(i, info.yCol));
+            if(info.type == 1) {
+                info.x2Data.append(cellValue(i, info.x2Col));
+                info.y2Data.append(cellValue(i, info.y2Col));
+            }
+        }
+        info.linked = true;
+        return true;
+    }
+
+    if(info.timeFunction != TimeTransform::ElapsedTime) return buildPeriodCurveData(info);
+
+    // 导数曲线：只保留 t > 0 且压差 > 0 的点，并记录其表格行
+    double initialP = rows > 0 ? cellValue(0, info.yCol) : 0.0;
+    for(int i=0; i<rows; ++i) {
+        double t = cellValue(i, info.xCol);
+        double p = cellValue(i, info.yCol);
+        double dp = info.isMeasuredP ? std::abs(p - initialP) : p;
+        if(t > 0 && dp > 0) { info.xData.append(t); info.yData.append(dp); info.sourceRows.append(i); }
+    }
+    if(info.xData.size() < 3) return false;
+
+    resetDerivative(info, info.xData);
+    applyDerivativeSmoothing(info);
+    info.linked = true;
+    return true;
+}
+
+// 叠加/等效时间导数曲线：取最后一个样本所在的流动段，压差以该段开始时的压力为基准
+// 导数对等效时间求取（即叠加导数 dΔp/dX），横轴为等效时间或段内经过时间
+bool WT_PlottingWidget::buildPeriodCurveData(CurveInfo& info)
+{
+    const int rows = m_dataModel->rowCount();
+    if(info.rateCol < 0 || info.rateCol >= m_dataModel->columnCount() || rows == 0) return false;
+
+    QVector<double> time(rows), rate(rows);
+    for(int i=0; i<rows; ++i) { time[i] = cellValue(i, info.xCol); rate[i] = cellValue(i, info.rateCol); }
+    TimeTransform transform(RateHistory::fromSamples(time, rate));
+    const int period = transform.periodAt(time.last());
+    if(period < 0) return false;
+    const double start = transform.periodStart(period);
+
+    double startP = cellValue(0, info.yCol);
+    QVector<double> t;
+    for(int i=0; i<rows; ++i) {
+        double p = cellValue(i, info.yCol);
+        if(time[i] <= start) { startP = p; continue; }
+        double dp = info.isMeasuredP ? std::abs(p - startP) : p;
+        if(dp > 0) { t.append(time[i]); info.yData.append(dp); info.sourceRows.append(i); }
+    }
+    if(t.size() < 3) return false;
+
+    QVector<double> te = transform.transform(t, TimeTransform::EquivalentTime, period);
+    resetDerivative(info, te);
+    if(info.timeFunction == TimeTransform::EquivalentTime) {
+        info.xData = te;
+    } else {
+        for(double v : t) info.xData.append(v - start);
+    }
+    applyDerivativeSmoothing(info);
+    info.linked = true;
+    return true;
+}
+
+// 三点加权即 L = 0 的 Bourdet 导数，与 Bourdet 一样可增量更新；样条导数整条计算
+void WT_PlottingWidget::resetDerivative(CurveInfo& info, const QVector<double>& x)
+{
+    info.splineDerivative.clear();
+    if(info.derivAlgorithm == DerivativeEngine::LogSpline) {
+        info.splineDerivative = DerivativeEngine::logSpline(x, info.yData);
+        info.derivCache.reset(QVector<double>(), QVector<double>(), info.LSpacing);
+    } else {
+        info.derivCache.reset(x, info.yData, info.derivAlgorithm == DerivativeEngine::ThreePoint ? 0.0 : info.LSpacing);
+    }
+}
+
+void WT_PlottingWidget::applyDerivativeSmoothing(CurveInfo& info)
+{
+    const QVector<double>& raw = (info.derivAlgorithm == DerivativeEngine::LogSpline) ? info.splineDerivative : info.derivCache.derivative();
+    if(info.isSmooth) {
+        info.derivData = SmoothingEngine::smooth(info.xData, raw, (SmoothingEngine::Method)info.smoothMethod,
+                                                 info.smoothFactor, info.smoothWidth);
+    } else {
+        info.derivData = raw;
+    }
+}
+
+void WT_PlottingWidget::onSourceRowsChanged()
+{
+    for(auto it = m_curves.begin(); it != m_curves.end(); ++it) {
+        it.value().linked = false;
+        it.value().sourceRows.clear();
+    }
+}
+
+void WT_PlottingWidget::onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    if(!m_dataModel || !topLeft.isValid() || !bottomRight.isValid()) return;
+
+    for(auto it = m_curves.begin(); it != m_curves.end(); ++it) {
+        CurveInfo& info = it.value();
+        bool touched = false;
+        bool rebuilt = false;
+        for(int col = topLeft.column(); col <= bottomRight.column() && !rebuilt; ++col) {
+            if(!dependsOnColumn(info, col)) continue;
+            touched = true;
+            for(int row = topLeft.row(); row <= bottomRight.row() && !rebuilt; ++row)
+                rebuilt = patchSourceCell(info, row, col);
+        }
+        // 整段写回只刷新一次
+        if(touched) refreshDisplayedCurve(info);
+    }
+}
+
+bool WT_PlottingWidget::dependsOnColumn(const CurveInfo& info, int col) const
+{
+    return col == info.xCol || col == info.yCol || (info.type == 1 && (col == info.x2Col || col == info.y2Col))
+           || (info.type == 2 && info.timeFunction != TimeTransform::ElapsedTime && col == info.rateCol);
+}
+
+bool WT_PlottingWidget::patchSourceCell(CurveInfo& info, int row, int col)
+{
+    if(!info.linked || (info.type == 2 && (info.timeFunction != TimeTransform::ElapsedTime || info.derivAlgorithm == DerivativeEngine::LogSpline))) {
+        // 与表格行的对应关系未知（如从项目恢复或行结构已改变），或流动段与时间函数依赖整条产量史，
+        // 或样条导数依赖全部数据点，整条曲线重新读取
+        buildCurveData(info);
+        return true;
+    }
+    if(info.type != 2) {
+        if(row < info.xData.size()) {
+            const double value = cellValue(row, col);
+            if(col == info.xCol) info.xData[row] = value;
+            if(col == info.yCol) info.yData[row] = value;
+            if(info.type == 1 && col == info.x2Col) info.x2Data[row] = value;
+            if(info.type == 1 && col == info.y2Col) info.y2Data[row] = value;
+        }
+        return false;
+    }
+
+    // 导数曲线：首行压力是压差基准，数据点增减时整条重建；否则只重算受影响的导数
+    auto pos = std::lower_bound(info.sourceRows.begin(), info.sourceRows.end(), row);
+    int k = (pos != info.sourceRows.end() && *pos == row) ? int(pos - info.sourceRows.begin()) : -1;
+    double t = cellValue(row, info.xCol);
+    double p = cellValue(row, info.yCol);
+    double dp = info.isMeasuredP ? std::abs(p - cellValue(0, info.yCol)) : p;
+    bool valid = (t > 0 && dp > 0);
+
+    if((info.isMeasuredP && row == 0 && col == info.yCol) || (k < 0) != !valid) {
+        buildCurveData(info);
+        return true;
+    }
+    if(k >= 0) {
+        info.xData[k] = t;
+        info.yData[k] = dp;
+        QVector<QPair<int, int>> ranges = info.derivCache.update(k, t, dp);
+        if(info.isSmooth) {
+            applyDerivativeSmoothing(info);
+        } else {
+            const QVector<double>& d = info.derivCache.derivative();
+            for(const QPair<int, int>& r : ranges)
+                for(int i = r.first; i < r.second; ++i) info.derivData[i] = d[i];
+        }
+    }
+    return false;
+}
+
+void WT_PlottingWidget::refreshDisplayedCurve(const CurveInfo& info)
+{
+    if(info.name != m_currentDisplayedCurve) return;
+
+    if(info.type == 1) {
+        drawStackedPlot(info);
+        return;
+    }
+    if(ui->customPlot->graphCount() < (info.type == 2 ? 2 : 1)) return;
+    ui->customPlot->graph(0)->setData(info.xData, info.yData);
+    if(info.type == 2) ui->customPlot->graph(1)->setData(info.xData, info.derivData);
+    // 连续编辑触发的多次刷新由排队重绘合并为一次
+    ui->customPlot->replot(QCustomPlot::rpQueuedReplot);
+}
+
 // ---------------- 绘图函数 ----------------
 
 void WT_PlottingWidget::addCurveToPlot(const CurveInfo& info)
@@ -618,8 +803,8 @@ void WT_PlottingWidget::on_btn_Manage_clicked() {
         if(info.type == 0) {
             info.xData.clear(); info.yData.clear();
             for(int i=0; i<m_dataModel->rowCount(); ++i) {
-                info.xData.append(m_dataModel->item(i, info.xCol)->text().toDouble());
-                info.yData.append(m_dataModel->item(i, info.yCol)->text().toDouble());
+                info.xData.append(cellValue(i, info.xCol));
+                info.yData.append(cellValue(i, info.yCol));
             }
         }
         if(m_currentDisplayedCurve == name) on_listWidget_Curves_itemDoubleClicked(item);
@@ -642,6 +827,38 @@ void WT_PlottingWidget::on_btn_Delete_clicked() {
     }
 }
 
+// 阶梯图的产量数据为各段持续时间与产量，其余为逐点时间与产量
+void WT_PlottingWidget::on_btn_RateHistory_clicked() {
+    QListWidgetItem* item = getCurrentSelectedItem();
+    if(!item) return;
+    const CurveInfo& info = m_curves[item->text()];
+    if(info.type != 1 || info.y2Data.isEmpty()) {
+        QMessageBox::warning(this, "提示", "请选择压力产量曲线");
+        return;
+    }
+    RateHistory history = (info.prodGraphType == 0) ? RateHistory::fromDurations(info.x2Data, info.y2Data)
+                                                    : RateHistory::fromSamples(info.x2Data, info.y2Data);
+    if(!history.isMultiRate()) {
+        emit rateHistorySelected(history, 0.0);
+        QMessageBox::information(this, "完成", "产量不变，理论模型按单一产量计算。");
+        return;
+    }
+
+    // 选择要分析的流动段：理论曲线以该段开始时间为 t = 0，默认最后一段
+    QStringList periods;
+    for(int i=0; i<history.stepCount(); ++i)
+        periods << QString("第 %1 段：t = %2，q = %3").arg(i + 1).arg(history.startTimes[i], 0, 'g', 6).arg(history.rates[i], 0, 'g', 6);
+    bool ok = false;
+    QString chosen = QInputDialog::getItem(this, "产量历史", "分析的流动段：", periods, periods.size() - 1, false, &ok);
+    if(!ok) return;
+    const int period = periods.indexOf(chosen);
+    const double origin = history.startTimes[qMax(0, period)];
+
+    emit rateHistorySelected(history, origin);
+    QMessageBox::information(this, "完成", QString("已将 %1 段产量设为拟合模型的产量历史，分析第 %2 段（t = %3 起）。")
+                             .arg(history.stepCount()).arg(qMax(0, period) + 1).arg(origin, 0, 'g', 6));
+}
+
 void WT_PlottingWidget::on_btn_ChartSettings_clicked() {
     QCPLayoutElement* el = ui->customPlot->plotLayout()->element(0,0);
     QCPTextElement* titleElement = qobject_cast<QCPTextElement*>(el);
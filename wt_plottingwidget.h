@@ -8,6 +8,8 @@
 #include <QJsonObject>
 #include "mousezoom.h"
 #include "plottingstackwidget.h"
+#include "derivativeengine.h"
+#include "ratesuperposition.h"
 
 namespace Ui {
 class WT_PlottingWidget;
@@ -39,9 +41,20 @@ struct CurveInfo {
     bool isMeasuredP;
     double LSpacing;
     bool isSmooth;
+    int smoothMethod;       // SmoothingEngine::Method
     int smoothFactor;
+    double smoothWidth;     // 对数时间平滑半窗宽 (ln t)
+    int timeFunction;       // TimeTransform::Function，非经过时间时按产量列只取最后一个流动段
+    int rateCol;
+    int derivAlgorithm;     // DerivativeEngine::Algorithm
 
     QVector<double> derivData; // 缓存
+
+    // 与数据表的关联（不保存）：编辑源单元格时据此局部更新曲线
+    bool linked;                        // 数据点与当前表格行一一对应
+    QVector<int> sourceRows;            // 导数曲线各点对应的表格行
+    IncrementalDerivative derivCache;   // 导数曲线的未平滑导数（Bourdet 与三点加权）
+    QVector<double> splineDerivative;   // 对数时间样条的未平滑导数（全局算法，不做增量更新）
     QCPScatterStyle::ScatterShape derivShape;
     QColor derivPointColor;
     Qt::PenStyle derivLineStyle;
@@ -49,7 +62,8 @@ struct CurveInfo {
 
     CurveInfo() : xCol(-1), yCol(-1), x2Col(-1), y2Col(-1),
         pointShape(QCPScatterStyle::ssDisc), type(0), prodGraphType(0),
-        isMeasuredP(true), LSpacing(0.1), isSmooth(false), smoothFactor(3) {}
+        isMeasuredP(true), LSpacing(0.1), isSmooth(false), smoothMethod(0), smoothFactor(3), smoothWidth(0.2),
+        timeFunction(0), rateCol(-1), derivAlgorithm(DerivativeEngine::Bourdet), linked(false) {}
 
     QJsonObject toJson() const;
     static CurveInfo fromJson(const QJsonObject& json);
@@ -70,12 +84,17 @@ public:
     // 应在 MainWindow 打开项目后调用此函数
     void loadProjectData();
 
+signals:
+    // 选中压力产量曲线的产量历史，供理论模型叠加计算；timeOrigin 为分析段的开始时间（理论曲线 t = 0）
+    void rateHistorySelected(const RateHistory& history, double timeOrigin);
+
 private slots:
     void on_btn_NewCurve_clicked();
     void on_btn_PressureRate_clicked();
     void on_btn_Derivative_clicked();
     void on_btn_Manage_clicked();
     void on_btn_Delete_clicked();
+    void on_btn_RateHistory_clicked();
     void on_btn_Save_clicked();
 
     void on_listWidget_Curves_itemDoubleClicked(QListWidgetItem *item);
@@ -86,6 +105,11 @@ private slots:
     void on_btn_FitToData_clicked();
     void onGraphClicked(QCPAbstractPlottable *plottable, int dataIndex, QMouseEvent *event);
 
+    // 表格单元格被编辑或批量写回（如派生导数列）：局部更新依赖这些单元格的曲线
+    void onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+    // 表格行结构改变：曲线与表格行的对应关系失效
+    void onSourceRowsChanged();
+
 private:
     Ui::WT_PlottingWidget *ui;
     QStandardItemModel* m_dataModel;
@@ -114,6 +138,19 @@ private:
     void drawStackedPlot(const CurveInfo& info);
     void drawDerivativePlot(const CurveInfo& info);
 
+    // 从表格读取曲线数据（导数曲线同时计算导数与平滑）；数据点不足时返回 false
+    bool buildCurveData(CurveInfo& info);
+    bool buildPeriodCurveData(CurveInfo& info);
+    void resetDerivative(CurveInfo& info, const QVector<double>& x);
+    void applyDerivativeSmoothing(CurveInfo& info);
+    // 当前显示的曲线数据变化后刷新图形（保持当前坐标范围）
+    void refreshDisplayedCurve(const CurveInfo& info);
+    // 曲线是否依赖表格的某一列
+    bool dependsOnColumn(const CurveInfo& info, int col) const;
+    // 按单元格的新值局部更新曲线；整条曲线已从表格重新读取时返回 true
+    bool patchSourceCell(CurveInfo& info, int row, int col);
+    double cellValue(int row, int col) const;
+
     QListWidgetItem* getCurrentSelectedItem();
     void executeExport(bool fullRange, double startKey = 0, double endKey = 0);
     double getProductionValueAt(double t, const CurveInfo& info);